@@ -0,0 +1,334 @@
+// Bench.c
+// Runs on MSP432 or a Linux/macOS host
+// Times the numerical kernels of the lab code. Distance_ComputeDistance,
+// Odometry_CalculateAlpha and RxFifo_Put/Get are the lab functions themselves,
+// ring_put_get is the Lab08/Ring.h ring with an 8-byte event as payload;
+// COMPUTE_RPM and the controller update are built from the same macros as
+// Motor_Forward_RPM, and the FCS loop is the one in AP_EchoSendMessage.
+#include <stdint.h>
+#include "Bench.h"
+#include "Distance.h"
+#include "Odometry.h"
+#include "Precision_Moves.h"
+#include "Ring.h"
+
+
+// Receive FIFO of Lab08/UART1.c (not declared in UART1.h)
+void RxFifo_Init(void);
+int RxFifo_Put(uint8_t data);
+int RxFifo_Get(uint8_t *datapt);
+
+#define BENCH_MASK      (BENCH_INPUTS - 1)
+#define BENCH_NPI_MAX   32    /* Largest NPI frame used by the FCS kernel (bytes) */
+#define BENCH_RING_SIZE 16    /* Events the ring kernel's ring holds              */
+
+typedef struct BenchEntry{
+    const char* name;
+    BenchKernel kernel;
+} BenchEntry;
+
+// Inputs, filled once by Bench_Init so every platform times the same values
+static uint32_t BenchADC[BENCH_INPUTS];
+static Coordinates BenchCur[BENCH_INPUTS], BenchDest[BENCH_INPUTS];
+static int32_t BenchSteps[BENCH_INPUTS], BenchTime[BENCH_INPUTS];
+static int32_t BenchError[BENCH_INPUTS];
+static uint8_t BenchFrame[BENCH_INPUTS][BENCH_NPI_MAX];
+
+// Event an interrupt handler passes to the main program
+typedef struct BenchEvent{
+    uint32_t time;
+    uint32_t data;
+} BenchEvent;
+
+RING_DEFINE(BenchRing, BenchEvent, BENCH_RING_SIZE)
+static BenchRing BenchEvents;
+
+static uint32_t BenchSamples[BENCH_SAMPLES];
+static uint32_t BenchSeed;
+volatile uint32_t Bench_Sink;
+
+
+// ---------- Bench_Random ----------
+// Xorshift generator, so the inputs are the same on every platform
+static uint32_t Bench_Random(void){
+    BenchSeed ^= BenchSeed << 13;
+    BenchSeed ^= BenchSeed >> 17;
+    BenchSeed ^= BenchSeed << 5;
+    return BenchSeed;
+}
+
+
+// ---------- Bench_Init ----------
+// Fills the kernel inputs
+static void Bench_Init(void){
+    uint32_t i, j, payload;
+
+    BenchSeed = 443;
+    for(i = 0; i < BENCH_INPUTS; i++){
+        // ADC results from 2 m down to a few cm
+        BenchADC[i] = 1000 + Bench_Random() % 13000;
+
+        BenchCur[i].xPos = (int32_t)(Bench_Random() % 4000) - 2000;
+        BenchCur[i].yPos = (int32_t)(Bench_Random() % 4000) - 2000;
+        BenchCur[i].heading = Bench_Random() % DEGREES_PER_REVOLUTION;
+        BenchDest[i].xPos = (int32_t)(Bench_Random() % 4000) - 2000;
+        BenchDest[i].yPos = (int32_t)(Bench_Random() % 4000) - 2000;
+        BenchDest[i].heading = 0;
+
+        // Steps and Timer A3 ticks of one forward controller period
+        BenchSteps[i] = Bench_Random() % 24;
+        BenchTime[i] = 100000 + Bench_Random() % 900000;
+        BenchError[i] = (int32_t)(Bench_Random() % 600) - 300;
+
+        // NPI frame: SOF, length, CMD0, CMD1, payload (the FCS is not stored)
+        payload = 1 + Bench_Random() % (BENCH_NPI_MAX - 5);
+        BenchFrame[i][0] = 0xFE;
+        BenchFrame[i][1] = payload;
+        BenchFrame[i][2] = 0;
+        BenchFrame[i][3] = 0x55;
+        BenchFrame[i][4] = 0x8A;
+        for(j = 0; j < payload; j++){
+            BenchFrame[i][5 + j] = Bench_Random();
+        }
+    }
+    RxFifo_Init();
+    BenchRing_Init(&BenchEvents);
+}
+
+
+// ---------- Kernels ----------
+static uint32_t Bench_Empty(uint32_t calls){
+    uint32_t i, sum = 0;
+    for(i = 0; i < calls; i++){
+        sum += BenchADC[i & BENCH_MASK];
+    }
+    return sum;
+}
+
+static uint32_t Bench_DistanceLeft(uint32_t calls){
+    uint32_t i, sum = 0;
+    for(i = 0; i < calls; i++){
+        sum += Distance_ComputeDistance(BenchADC[i & BENCH_MASK], LEFT_DISTANCE_SENSOR);
+    }
+    return sum;
+}
+
+static uint32_t Bench_DistanceCenter(uint32_t calls){
+    uint32_t i, sum = 0;
+    for(i = 0; i < calls; i++){
+        sum += Distance_ComputeDistance(BenchADC[i & BENCH_MASK], CENTER_DISTANCE_SENSOR);
+    }
+    return sum;
+}
+
+static uint32_t Bench_DistanceRight(uint32_t calls){
+    uint32_t i, sum = 0;
+    for(i = 0; i < calls; i++){
+        sum += Distance_ComputeDistance(BenchADC[i & BENCH_MASK], RIGHT_DISTANCE_SENSOR);
+    }
+    return sum;
+}
+
+static uint32_t Bench_Alpha(uint32_t calls){
+    uint32_t i, sum = 0;
+    for(i = 0; i < calls; i++){
+        sum += Odometry_CalculateAlpha(&BenchCur[i & BENCH_MASK], &BenchDest[i & BENCH_MASK]);
+    }
+    return sum;
+}
+
+static uint32_t Bench_ComputeRPM(uint32_t calls){
+    uint32_t i, sum = 0;
+    int32_t steps, prevSteps = 0, time, prevTime = 0;
+    for(i = 0; i < calls; i++){
+        steps = prevSteps + BenchSteps[i & BENCH_MASK];
+        time = prevTime + BenchTime[i & BENCH_MASK];
+        sum += COMPUTE_RPM(steps, prevSteps, time, prevTime);
+        prevSteps = steps;
+        prevTime = time;
+    }
+    return sum;
+}
+
+// Integral and duty cycle update of one wheel in Motor_Forward_RPM
+static uint32_t Bench_ControllerUpdate(uint32_t calls){
+    uint32_t i;
+    int32_t error, integral = 0, update = RPM_TO_DUTY_EST(LEFT_RPM);
+    for(i = 0; i < calls; i++){
+        error = BenchError[i & BENCH_MASK];
+
+        integral += KI_FORWARD(error);
+        if(integral > INTEGRAL_MAX){integral = INTEGRAL_MAX;}
+        if(integral < INTEGRAL_MIN){integral = INTEGRAL_MIN;}
+
+        update += KP_FORWARD(error) + integral;
+        if(update < MIN_DUTY_CYCLE){update = MIN_DUTY_CYCLE;}
+        if(update > MAX_DUTY_CYCLE){update = MAX_DUTY_CYCLE;}
+    }
+    return update;
+}
+
+static uint32_t Bench_RxFifo(uint32_t calls){
+    uint32_t i, sum = 0;
+    uint8_t data;
+    for(i = 0; i < calls; i++){
+        RxFifo_Put(BenchADC[i & BENCH_MASK]);
+        RxFifo_Get(&data);
+        sum += data;
+    }
+    return sum;
+}
+
+static uint32_t Bench_Ring(uint32_t calls){
+    uint32_t i, sum = 0;
+    BenchEvent event;
+    for(i = 0; i < calls; i++){
+        event.time = i;
+        event.data = BenchADC[i & BENCH_MASK];
+        BenchRing_Put(&BenchEvents, &event);
+        BenchRing_Get(&BenchEvents, &event);
+        sum += event.data;
+    }
+    return sum;
+}
+
+static uint32_t Bench_FCS(uint32_t calls){
+    uint32_t i, j, sum = 0, fcs, size;
+    uint8_t* sendMsg;
+    for(i = 0; i < calls; i++){
+        sendMsg = BenchFrame[i & BENCH_MASK];
+        size = sendMsg[1] + (sendMsg[2] << 8);
+        fcs = 0;
+        for(j = 1; j < size + 5; j++)fcs = fcs^sendMsg[j];
+        sum += fcs;
+    }
+    return sum;
+}
+
+static const BenchEntry BenchKernels[] = {
+    {"empty",             Bench_Empty},
+    {"distance_left",     Bench_DistanceLeft},
+    {"distance_center",   Bench_DistanceCenter},
+    {"distance_right",    Bench_DistanceRight},
+    {"odometry_alpha",    Bench_Alpha},
+    {"compute_rpm",       Bench_ComputeRPM},
+    {"controller_update", Bench_ControllerUpdate},
+    {"rxfifo_put_get",    Bench_RxFifo},
+    {"ring_put_get",      Bench_Ring},
+    {"ap_fcs",            Bench_FCS},
+};
+#define BENCH_NUM_KERNELS (sizeof(BenchKernels) / sizeof(BenchKernels[0]))
+
+
+// ---------- Bench_AppendText ----------
+// Copies a string to the end of a line
+// Output: char* - end of the line
+static char* Bench_AppendText(char* line, const char* text){
+    while(*text){
+        *line++ = *text++;
+    }
+    *line = 0;
+    return line;
+}
+
+
+// ---------- Bench_AppendNumber ----------
+// Writes a comma and then n in decimal, or n/10 with one decimal if tenths is 1
+// Output: char* - end of the line
+static char* Bench_AppendNumber(char* line, uint32_t n, uint32_t tenths){
+    char digits[12];
+    uint32_t count = 0;
+
+    *line++ = ',';
+    if(tenths){
+        digits[count++] = '0' + n % 10;
+        digits[count++] = '.';
+        n /= 10;
+    }
+    do{
+        digits[count++] = '0' + n % 10;
+        n /= 10;
+    } while(n);
+    while(count){
+        *line++ = digits[--count];
+    }
+    *line = 0;
+    return line;
+}
+
+
+// ---------- Bench_Measure ----------
+// Times one kernel and outputs its line
+// Inputs: const BenchEntry* entry - kernel to time
+//         const char* unit - unit of Bench_Now
+// Output: none
+static void Bench_Measure(const BenchEntry* entry, const char* unit){
+    char line[BENCH_LINE], *end;
+    uint32_t s, i, start, sample;
+    uint64_t total = 0;
+
+    // Warm up the caches and branch predictors, then time every sample
+    Bench_Sink ^= entry->kernel(BENCH_CALLS);
+    for(s = 0; s < BENCH_SAMPLES; s++){
+        start = Bench_Now();
+        Bench_Sink ^= entry->kernel(BENCH_CALLS);
+        BenchSamples[s] = Bench_Now() - start;
+    }
+
+    // Insertion sort for the median
+    for(s = 1; s < BENCH_SAMPLES; s++){
+        sample = BenchSamples[s];
+        for(i = s; i > 0 && BenchSamples[i - 1] > sample; i--){
+            BenchSamples[i] = BenchSamples[i - 1];
+        }
+        BenchSamples[i] = sample;
+    }
+    for(s = 0; s < BENCH_SAMPLES; s++){
+        total += BenchSamples[s];
+    }
+
+    // Times per call in tenths
+    end = Bench_AppendText(line, entry->name);
+    end = Bench_AppendText(end, ",");
+    end = Bench_AppendText(end, unit);
+    end = Bench_AppendNumber(end, BENCH_CALLS, 0);
+    end = Bench_AppendNumber(end, (uint32_t)((uint64_t)BenchSamples[0] * 10 / BENCH_CALLS), 1);
+    end = Bench_AppendNumber(end, (uint32_t)((uint64_t)BenchSamples[BENCH_SAMPLES / 2] * 10 / BENCH_CALLS), 1);
+    end = Bench_AppendNumber(end, (uint32_t)(total * 10 / BENCH_SAMPLES / BENCH_CALLS), 1);
+    Bench_AppendNumber(end, (uint32_t)((uint64_t)BenchSamples[BENCH_SAMPLES - 1] * 10 / BENCH_CALLS), 1);
+    Bench_Output(line);
+}
+
+
+// ---------- Bench_RunAll ----------
+// Times every kernel and outputs one line per kernel
+// Inputs: const char* platform - name printed in the header line
+//         const char* unit - unit of Bench_Now ("cycles" or "ns")
+// Output: none
+void Bench_RunAll(const char* platform, const char* unit){
+    char line[BENCH_LINE];
+    uint32_t k;
+
+    Bench_Init();
+    Bench_AppendText(Bench_AppendText(line, "# bench "), platform);
+    Bench_Output(line);
+    Bench_Output("kernel,unit,calls,min,median,mean,max");
+    for(k = 0; k < BENCH_NUM_KERNELS; k++){
+        Bench_Measure(&BenchKernels[k], unit);
+    }
+}
+
+
+// ---------- Bench_Kernel ----------
+// Times a kernel of the platform and outputs its line (call after Bench_RunAll)
+// Inputs: const char* name - name of the kernel in its line
+//         BenchKernel kernel - kernel to time
+//         const char* unit - unit of Bench_Now
+// Output: none
+void Bench_Kernel(const char* name, BenchKernel kernel, const char* unit){
+    BenchEntry entry;
+
+    entry.name = name;
+    entry.kernel = kernel;
+    Bench_Measure(&entry, unit);
+}
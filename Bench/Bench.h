@@ -0,0 +1,47 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+/*
+ * Micro-benchmarks of the numerical kernels the robot runs in its control loops.
+ * The same kernels and statistics are compiled for the MSP432 (Bench/main.c, times
+ * in DWT cycles, results over UART0) and for a Linux/macOS host (Host/KernelBench.c,
+ * times in nanoseconds, results on stdout).
+ *
+ * Each kernel is called BENCH_CALLS times per sample and timed over BENCH_SAMPLES
+ * samples after one untimed warm-up sample. Every result line is
+ *     kernel,unit,calls,min,median,mean,max
+ * with the times per call to one decimal place, after a "# bench <platform>" line.
+ * The "empty" kernel is the cost of the loop and timer alone, to subtract from the
+ * others. A platform times its own kernels after Bench_RunAll with Bench_Kernel.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#ifndef BENCH_SAMPLES
+#define BENCH_SAMPLES  15    /* Timed samples per kernel                        */
+#endif
+#ifndef BENCH_CALLS
+#define BENCH_CALLS    64    /* Kernel calls per sample                         */
+#endif
+#define BENCH_INPUTS   64    /* Inputs per kernel, cycled through (power of 2)  */
+#define BENCH_LINE     96    /* Longest output line including the terminator    */
+
+
+// Kernel under test: makes the given number of calls and returns a checksum of the
+// results, so the compiler cannot drop them
+typedef uint32_t (*BenchKernel)(uint32_t calls);
+
+
+// --------------------- Function Prototypes ---------------------
+
+// Provided by the platform: free running time (cycles or ns) and output of one line
+uint32_t Bench_Now(void);
+void Bench_Output(const char* line);
+
+void Bench_RunAll(const char* platform, const char* unit);
+void Bench_Kernel(const char* name, BenchKernel kernel, const char* unit);
+
+#endif
@@ -0,0 +1,99 @@
+// main.c
+// Runs on MSP432
+// Runs the kernel benchmarks of Bench.c once and sends the results over UART0 to
+// the PC (115,200 baud). Times are core clock cycles from the DWT cycle counter at
+// 48 MHz. The kernels are compiled from the lab folders (see the linked resources
+// of this project), so the results follow the lab code.
+//
+// The isr_ kernels pend the tachometer and UART1 interrupts in software and time
+// each from the pend to the return from its handler. The handlers are RAMFUNC
+// (RamFunc.h) and run from SRAM; build with RAMFUNC_IN_FLASH predefined to run
+// them from flash instead, and compare the two outputs line by line.
+#include "msp.h"
+#include "Clock.h"
+#include "UART0.h"
+#include "UART1.h"
+#include "Tachometer.h"
+#include "RamFunc.h"
+#include "Bench.h"
+
+#ifdef RAMFUNC_IN_FLASH
+#define BENCH_PLATFORM "msp432 48MHz flash"
+#else
+#define BENCH_PLATFORM "msp432 48MHz ramfunc"
+#endif
+
+
+// ---------- Bench_Now ----------
+// Output: uint32_t - core clock cycles since DWT_Init
+uint32_t Bench_Now(void){
+    return DWT->CYCCNT;
+}
+
+
+// ---------- Bench_Output ----------
+// Sends one line to the PC
+void Bench_Output(const char* line){
+    UART0_OutString((char*)line);
+    UART0_OutChar(CR);
+    UART0_OutChar(LF);
+}
+
+
+// ---------- DWT_Init ----------
+// Starts the cycle counter of the debug watchpoint and trace unit
+static void DWT_Init(void){
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+
+// ---------- Bench_Interrupt ----------
+// Pends interrupts and waits for each to be handled, so the time per call is the
+// entry, the handler and the return
+// Inputs: uint32_t calls - times to pend the interrupts
+//         uint32_t mask - interrupts to pend (NVIC->ISPR[0])
+// Output: uint32_t - interrupts still pending (0)
+static uint32_t Bench_Interrupt(uint32_t calls, uint32_t mask){
+    uint32_t i;
+
+    for(i = 0; i < calls; i++){
+        NVIC->ISPR[0] = mask;
+        __asm("    DSB\n"
+              "    ISB\n");   // Taken before the next instruction
+    }
+    return NVIC->ISPR[0] & mask;
+}
+
+static uint32_t Bench_IsrTA3_0(uint32_t calls){
+    return Bench_Interrupt(calls, 0x00004000);   // TA3_0, interrupt 14
+}
+
+static uint32_t Bench_IsrTA3_N(uint32_t calls){
+    return Bench_Interrupt(calls, 0x00008000);   // TA3_N, interrupt 15
+}
+
+static uint32_t Bench_IsrEUSCIA2(uint32_t calls){
+    return Bench_Interrupt(calls, 0x00040000);   // EUSCIA2, interrupt 18
+}
+
+
+void main(void){
+    // Stop watchdog timer
+    WDT_A->CTL = WDT_A_CTL_PW | WDT_A_CTL_HOLD;
+
+    // Initializations
+    Clock_Init48MHz();
+    UART0_Init();
+    DWT_Init();
+    Tachometer_Init();
+    UART1_Init(UART1_DEFAULTBAUD);
+
+    Bench_RunAll(BENCH_PLATFORM, "cycles");
+    Bench_Kernel("isr_ta3_0", Bench_IsrTA3_0, "cycles");
+    Bench_Kernel("isr_ta3_n", Bench_IsrTA3_N, "cycles");
+    Bench_Kernel("isr_euscia2", Bench_IsrEUSCIA2, "cycles");
+
+    while(1){}
+}
@@ -0,0 +1,242 @@
+// EkfEval.c
+// Runs on a Linux/macOS host
+// Evaluates the Lab10 EKF against plain dead reckoning. The simulated robot drives
+// laps around the Lab10 course (Arena.c) with slightly mis-sized wheels and noisy
+// distance sensors. Both estimators see the same tachometer steps and distance
+// readings every 20 ms; their errors are measured against the true pose. The
+// inputs are recorded and replayed through the filter afterwards to time the
+// predict and update steps without the simulation in the loop.
+//
+// Build (from the repository root):
+//   gcc -O2 -std=gnu11 -I Host -I Lab10 -o Host/bin/EkfEval Host/EkfEval.c Host/Sim.c
+//       Lab10/EKF.c Lab10/Arena.c Lab10/Distance.c -lm
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <time.h>
+#include "Sim.h"
+#include "EKF.h"
+
+
+#define PERIOD_MS       20      /* Estimator period, the same as BUG_PERIOD_MS (ms)       */
+#define LAPS            4       /* Laps of the course per run                             */
+#define RANGE_NOISE     0.03f   /* Distance sensor noise (fraction of the distance)       */
+#define MAX_SAMPLES     20000   /* Recorded estimator periods per run                     */
+#define REPLAYS         50      /* Times the recorded inputs are replayed for timing      */
+#define CORNER_MM       80      /* Distance from a lap corner that counts as reaching it  */
+#define BASE_DUTY       3900    /* Duty cycle when driving straight                       */
+
+// Wheel size errors of each run (fraction)
+static const float WheelErrors[][2] = {
+    { 0.010f, -0.010f},
+    {-0.010f,  0.010f},
+    { 0.005f,  0.000f},
+    { 0.000f, -0.005f},
+    { 0.010f,  0.010f},
+    {-0.005f, -0.010f}
+};
+#define RUNS (sizeof(WheelErrors) / sizeof(WheelErrors[0]))
+
+// Corners of a lap, 300 mm inside the course walls
+static const float LapX[] = {0,    ARENA_MAX_X_MM - 300, ARENA_MAX_X_MM - 300, ARENA_MIN_X_MM + 300, ARENA_MIN_X_MM + 300, 0};
+static const float LapY[] = {1500, 1500,                 ARENA_MIN_Y_MM + 300, ARENA_MIN_Y_MM + 300, 1500,                 1500};
+#define LAP_CORNERS (sizeof(LapX) / sizeof(LapX[0]))
+
+// Estimator inputs recorded every period
+typedef struct Sample{
+    float leftDist, rightDist;
+    uint32_t left, center, right;
+} Sample;
+static Sample Samples[MAX_SAMPLES];
+static uint32_t NumSamples;
+
+// Error statistics of one estimator
+typedef struct Errors{
+    double sumSq;
+    float final;
+    float finalHeading;
+    float maxHeading;
+} Errors;
+static Errors DeadReckoning, Filter;
+static uint32_t Consistent, Used, Periods;
+
+static SimWall CourseWalls[ARENA_NUM_WALLS];
+
+
+// ---------- NowNs ----------
+static uint64_t NowNs(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+
+// ---------- WrapDegrees ----------
+static float WrapDegrees(float angle){
+    while(angle > 180){angle -= 360;}
+    while(angle < -180){angle += 360;}
+    return angle;
+}
+
+
+// ---------- Accumulate ----------
+static void Accumulate(Errors* e, float dx, float dy, float dh){
+    e->sumSq += dx*dx + dy*dy;
+    e->final = sqrtf(dx*dx + dy*dy);
+    e->finalHeading = fabsf(dh);
+    if(fabsf(dh) > e->maxHeading){
+        e->maxHeading = fabsf(dh);
+    }
+}
+
+
+// ---------- Drive ----------
+// Program run by the simulation: drives the laps with the true pose and runs both
+// estimators on the sensor data
+static void Drive(void){
+    float x, y, h, bearing, dlX, dlY, dlH, leftDist, rightDist, distance, turn;
+    float dx, dy, dh, sigma;
+    int32_t leftSteps, rightSteps, prevLeft = 0, prevRight = 0, steer;
+    uint32_t corner = 0, lap = 0, left, center, right;
+    EKF_Estimate est;
+
+    Sim_GetPose(&dlX, &dlY, &dlH);
+    dlH = dlH * PI / 180.0f;
+    EKF_Init(dlX, dlY, dlH * 180.0f / PI);
+
+    while(lap < LAPS && NumSamples < MAX_SAMPLES){
+        // Steer along the lap with the true pose
+        Sim_GetPose(&x, &y, &h);
+        if(hypotf(LapX[corner] - x, LapY[corner] - y) < CORNER_MM){
+            corner++;
+            if(corner == LAP_CORNERS){
+                corner = 1;
+                lap++;
+            }
+        }
+        bearing = WrapDegrees(atan2f(LapY[corner] - y, LapX[corner] - x) * 180.0f / PI - h);
+        if(bearing > 30){
+            Motor_Left(2500, 2500);
+        } else if(bearing < -30){
+            Motor_Right(2500, 2500);
+        } else {
+            steer = (int32_t)(bearing * 60);
+            Motor_Forward(BASE_DUTY - steer, BASE_DUTY + steer);
+        }
+        Clock_Delay1ms(PERIOD_MS);
+
+        // Both estimators see the same wheel distances and readings
+        Tachometer_Get_Steps(&leftSteps, &rightSteps);
+        leftDist = (leftSteps - prevLeft) * PI * DIAMETER_MM / PULSES_PER_REV;
+        rightDist = (rightSteps - prevRight) * PI * DIAMETER_MM / PULSES_PER_REV;
+        prevLeft = leftSteps;
+        prevRight = rightSteps;
+        Distance_GetDistances(&left, &center, &right);
+
+        distance = (leftDist + rightDist) / 2.0f;
+        turn = (rightDist - leftDist) / WIDTH_MM;
+        dlX += distance * cosf(dlH + turn / 2.0f);
+        dlY += distance * sinf(dlH + turn / 2.0f);
+        dlH += turn;
+
+        EKF_Predict(leftDist, rightDist);
+        Used += EKF_Update(left, center, right);
+        EKF_GetEstimate(&est);
+
+        Samples[NumSamples].leftDist = leftDist;
+        Samples[NumSamples].rightDist = rightDist;
+        Samples[NumSamples].left = left;
+        Samples[NumSamples].center = center;
+        Samples[NumSamples].right = right;
+        NumSamples++;
+
+        // Errors against the true pose
+        Sim_GetPose(&x, &y, &h);
+        Accumulate(&DeadReckoning, dlX - x, dlY - y, WrapDegrees(dlH * 180.0f / PI - h));
+        dx = est.xPos - x;
+        dy = est.yPos - y;
+        dh = WrapDegrees(est.heading - h);
+        Accumulate(&Filter, dx, dy, dh);
+
+        // The true position should be inside the 2 sigma ellipse about 86% of the time
+        sigma = dx*dx*est.covariance[1][1] - 2*dx*dy*est.covariance[0][1] + dy*dy*est.covariance[0][0];
+        sigma /= est.covariance[0][0]*est.covariance[1][1] - est.covariance[0][1]*est.covariance[0][1];
+        if(sigma < 4.0f){
+            Consistent++;
+        }
+        Periods++;
+    }
+
+    Motor_Stop();
+    while(1){
+        Clock_Delay1ms(PERIOD_MS);
+    }
+}
+
+
+int main(void){
+    static const SimArena Course = {"course", CourseWalls, ARENA_NUM_WALLS};
+    const Errors zero = {0, 0, 0, 0};
+    float finalDR = 0, finalEKF = 0;
+    SimConfig config;
+    uint64_t t0, predictNs = 0, updateNs = 0;
+    uint32_t i, run, rep, periods = 0, updates = 0;
+
+    for(i = 0; i < ARENA_NUM_WALLS; i++){
+        CourseWalls[i].x0 = ArenaWalls[i].x0;
+        CourseWalls[i].y0 = ArenaWalls[i].y0;
+        CourseWalls[i].x1 = ArenaWalls[i].x1;
+        CourseWalls[i].y1 = ArenaWalls[i].y1;
+    }
+
+    printf("%-4s %7s %7s | %-30s | %-30s | %s\n", "run", "wheelL", "wheelR",
+           "dead reckoning: rms/final mm, deg", "EKF: rms/final mm, final/max deg", "in 2 sigma");
+    for(run = 0; run < RUNS; run++){
+        Sim_Reset(&Course, 0, 0, 90);
+        config.leftWheelError = WheelErrors[run][0];
+        config.rightWheelError = WheelErrors[run][1];
+        config.rangeNoise = RANGE_NOISE;
+        config.seed = 443 + run;
+        Sim_Configure(&config);
+
+        DeadReckoning = zero;
+        Filter = zero;
+        NumSamples = 0;
+        Used = 0;
+        Consistent = 0;
+        Periods = 0;
+        Sim_Run(Drive, 600000);
+
+        printf("%-4u %+6.1f%% %+6.1f%% | %7.0f %7.0f %6.1f        | %7.0f %7.0f %5.1f %5.1f   | %4.0f%%\n", run,
+               100 * config.leftWheelError, 100 * config.rightWheelError,
+               sqrt(DeadReckoning.sumSq / Periods), DeadReckoning.final, DeadReckoning.finalHeading,
+               sqrt(Filter.sumSq / Periods), Filter.final, Filter.finalHeading, Filter.maxHeading,
+               100.0f * Consistent / Periods);
+        finalDR += DeadReckoning.final;
+        finalEKF += Filter.final;
+
+        // Replay the recorded inputs to time the filter alone
+        for(rep = 0; rep < REPLAYS; rep++){
+            EKF_Init(0, 0, 90);
+            t0 = NowNs();
+            for(i = 0; i < NumSamples; i++){
+                EKF_Predict(Samples[i].leftDist, Samples[i].rightDist);
+            }
+            predictNs += NowNs() - t0;
+            EKF_Init(0, 0, 90);
+            t0 = NowNs();
+            for(i = 0; i < NumSamples; i++){
+                EKF_Update(Samples[i].left, Samples[i].center, Samples[i].right);
+            }
+            updateNs += NowNs() - t0;
+        }
+        periods += NumSamples * REPLAYS;
+        updates += Used;
+    }
+
+    printf("mean final position error: dead reckoning %.0f mm, EKF %.0f mm\n", finalDR / RUNS, finalEKF / RUNS);
+    printf("readings used by the EKF: %.1f per period\n", (float)updates / (periods / REPLAYS));
+    printf("host cost: predict %.0f ns, update (3 readings) %.0f ns per period\n",
+           (double)predictNs / periods, (double)updateNs / periods);
+    return 0;
+}
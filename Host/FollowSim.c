@@ -0,0 +1,223 @@
+// FollowSim.c
+// Runs on a Linux/macOS host
+// Compares the Lab_ExtraCredit followers (duty cycle proportional to the center
+// distance, and the tracker with range and bearing filters driving the wheel speed
+// controller) behind a moving target. The Lab_ExtraCredit main program is compiled
+// once per FOLLOW_MODE and run unmodified on top of Host/Sim.c. The target is a
+// 100 mm square box that starts FOLLOW_DISTANCE in front of the sensors, speeds up
+// to a cruise speed, drives a straight or a weaving path and stops again; each
+// follower is run behind it at several cruise speeds, without and with noise on
+// the distance sensors. The gap is the distance from the sensors to the nearest
+// point of the box, sampled every simulated ms: its error from FOLLOW_DISTANCE is
+// reported while cruising (RMS) and over the whole run (largest). A follower has
+// lost the target once the gap grows past LOST_MM.
+//
+// Build (from the repository root):
+//   gcc -O2 -std=gnu11 -I Host -I Lab_ExtraCredit -o Host/bin/FollowSim Host/FollowSim.c Host/Sim.c
+//       Lab_ExtraCredit/Distance.c Lab_ExtraCredit/Tracker.c Lab_ExtraCredit/Speed.c -lm
+
+#include <stdio.h>
+#include <math.h>
+#include "Sim.h"
+
+// Lab_ExtraCredit's main program, once for each follower
+#define FOLLOW_MODE 0
+#define main  Follow_MainP
+#define Pause Follow_PauseP
+#include "main.c"
+#undef FOLLOW_MODE
+#undef main
+#undef Pause
+
+#define FOLLOW_MODE 1
+#define main  Follow_MainTrack
+#define Pause Follow_PauseTrack
+#include "main.c"
+#undef FOLLOW_MODE
+#undef main
+#undef Pause
+
+
+#define TARGET_SIZE_MM    100     /* Side of the target box (mm)                                    */
+#define SENSOR_AHEAD_MM   60      /* Distance of the distance sensors in front of the center (mm)   */
+#define START_MS          500     /* Time the target waits before moving (ms)                       */
+#define RAMP_MS           1000    /* Time the target takes to reach its cruise speed or stop (ms)   */
+#define CRUISE_MS         10000   /* Time the target cruises (ms)                                   */
+#define SETTLE_MS         1000    /* Start of the cruise not counted in the cruise error (ms)       */
+#define END_MS            (START_MS + 2 * RAMP_MS + CRUISE_MS + 2000)
+#define WEAVE_MM          150.0f  /* Amplitude of the weaving path (mm)                             */
+#define WEAVE_LENGTH_MM   1500.0f /* Length of one weave (mm)                                       */
+#define LOST_MM           400     /* Gap past which the target is lost (mm)                         */
+#define NOISE             0.03f   /* Distance sensor noise of the noisy runs (fraction)              */
+#define PI_F              3.14159265f
+
+
+typedef struct Mode{
+    const char* name;
+    SimProgram program;
+} Mode;
+
+static const Mode Modes[] = {
+    {"p",     Follow_MainP},
+    {"track", Follow_MainTrack}
+};
+
+static const float Speeds[] = {100, 200, 300, 400};   // Cruise speeds of the target (mm/s)
+static const char* const Paths[] = {"straight", "weave"};
+
+// The target: the walls of its box, moved every simulated ms
+static SimWall TargetWalls[4];
+static const SimArena Field = {"field", TargetWalls, 4};
+static float TargetTravel;          // Distance along the path (mm)
+static float Cruise;                // Cruise speed of the run (mm/s)
+static uint32_t Path;
+
+// Gap statistics of the run
+static double CruiseSquared;
+static uint32_t CruiseSamples;
+static float MaxError;
+static uint8_t Lost;
+
+
+// ---------- Target_Place ----------
+// Puts the box at a distance along the path, its back face square to the path
+static void Target_Place(float travel){
+    float x, y, heading, c, s, h = TARGET_SIZE_MM / 2.0f;
+    float corners[4][2] = {{-h, -h}, {h, -h}, {h, h}, {-h, h}};
+    float cx[4], cy[4];
+    uint32_t i;
+
+    // Center of the box, half a box beyond its back face
+    x = travel + SENSOR_AHEAD_MM + FOLLOW_DISTANCE + h;
+    y = 0;
+    heading = 0;
+    if(Path == 1){
+        y = WEAVE_MM * sinf(2 * PI_F * travel / WEAVE_LENGTH_MM);
+        heading = atanf(WEAVE_MM * 2 * PI_F / WEAVE_LENGTH_MM * cosf(2 * PI_F * travel / WEAVE_LENGTH_MM));
+    }
+    c = cosf(heading);
+    s = sinf(heading);
+    for(i = 0; i < 4; i++){
+        cx[i] = x + corners[i][0] * c - corners[i][1] * s;
+        cy[i] = y + corners[i][0] * s + corners[i][1] * c;
+    }
+    for(i = 0; i < 4; i++){
+        TargetWalls[i].x0 = cx[i];
+        TargetWalls[i].y0 = cy[i];
+        TargetWalls[i].x1 = cx[(i + 1) & 3];
+        TargetWalls[i].y1 = cy[(i + 1) & 3];
+    }
+}
+
+
+// ---------- Target_Speed ----------
+// Speed of the target at a time (mm/s)
+static float Target_Speed(uint32_t ms){
+    if(ms < START_MS){
+        return 0;
+    }
+    ms -= START_MS;
+    if(ms < RAMP_MS){
+        return Cruise * ms / RAMP_MS;
+    }
+    ms -= RAMP_MS;
+    if(ms < CRUISE_MS){
+        return Cruise;
+    }
+    ms -= CRUISE_MS;
+    if(ms < RAMP_MS){
+        return Cruise * (RAMP_MS - ms) / RAMP_MS;
+    }
+    return 0;
+}
+
+
+// ---------- Target_Gap ----------
+// Distance from the robot's sensors to the nearest point of the box
+static float Target_Gap(void){
+    const SimWall* w;
+    float x, y, heading, dx, dy, t, distance, best = 1e9f;
+    uint32_t i;
+
+    Sim_GetPose(&x, &y, &heading);
+    x += SENSOR_AHEAD_MM * cosf(heading * PI_F / 180.0f);
+    y += SENSOR_AHEAD_MM * sinf(heading * PI_F / 180.0f);
+    for(i = 0; i < 4; i++){
+        w = &TargetWalls[i];
+        dx = w->x1 - w->x0;
+        dy = w->y1 - w->y0;
+        t = ((x - w->x0) * dx + (y - w->y0) * dy) / (dx * dx + dy * dy);
+        if(t < 0){t = 0;}
+        if(t > 1){t = 1;}
+        distance = hypotf(w->x0 + t * dx - x, w->y0 + t * dy - y);
+        if(distance < best){
+            best = distance;
+        }
+    }
+    return best;
+}
+
+
+// ---------- Monitor ----------
+// Moves the target and measures the gap
+static void Monitor(void){
+    uint32_t ms = Sim_GetTimeMs();
+    float error;
+
+    TargetTravel += Target_Speed(ms) / 1000.0f;
+    Target_Place(TargetTravel);
+
+    error = Target_Gap() - FOLLOW_DISTANCE;
+    if(fabsf(error) > MaxError){MaxError = fabsf(error);}
+    if((ms >= START_MS + RAMP_MS + SETTLE_MS) && (ms < START_MS + RAMP_MS + CRUISE_MS)){
+        CruiseSquared += (double)error * error;
+        CruiseSamples++;
+    }
+    if(error + FOLLOW_DISTANCE > LOST_MM){
+        Lost = 1;
+        Sim_Stop();
+    }
+    if(ms >= END_MS){
+        Sim_Stop();
+    }
+}
+
+
+int main(void){
+    SimConfig config = {0, 0, 0, 443};
+    SimResult result;
+    uint32_t m, n, s;
+
+    printf("%-8s %-5s %5s %6s %-9s %8s %7s %10s\n", "path", "mode", "noise", "speed", "result", "rms_mm",
+           "max_mm", "contact_ms");
+    for(Path = 0; Path < sizeof(Paths) / sizeof(Paths[0]); Path++){
+        for(n = 0; n < 2; n++){
+            for(s = 0; s < sizeof(Speeds) / sizeof(Speeds[0]); s++){
+                for(m = 0; m < sizeof(Modes) / sizeof(Modes[0]); m++){
+                    Cruise = Speeds[s];
+                    TargetTravel = 0;
+                    Target_Place(0);
+                    Sim_Reset(&Field, 0, 0, 0);
+                    config.rangeNoise = n ? NOISE : 0;
+                    Sim_Configure(&config);
+                    Sim_SetMonitor(Monitor);
+                    CruiseSquared = 0;
+                    CruiseSamples = 0;
+                    MaxError = 0;
+                    Lost = 0;
+                    result = Sim_Run(Modes[m].program, END_MS + 1000);
+
+                    printf("%-8s %-5s %5.2f %6.0f %-9s ", Paths[Path], Modes[m].name, config.rangeNoise, Cruise,
+                           Lost ? "lost" : "followed");
+                    if(CruiseSamples){
+                        printf("%8.1f", sqrt(CruiseSquared / CruiseSamples));
+                    } else {
+                        printf("%8s", "-");   // Lost before cruising
+                    }
+                    printf(" %7.1f %10u\n", MaxError, result.collisionMs);
+                }
+            }
+        }
+    }
+    return 0;
+}
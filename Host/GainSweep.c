@@ -0,0 +1,394 @@
+// GainSweep.c
+// Runs on a Linux/macOS host
+// Sweeps the gains and periods of the Lab10 Precision_Moves controllers in the host
+// simulation. Precision_Moves.c is compiled with PRECISION_MOVES_TUNABLE, which turns
+// KP_SPIN, KP_FORWARD, KI_FORWARD, SPIN_DELAY_MS and FORWARD_DELAY_MS into per-thread
+// run time parameters, and every gain set drives a few Motor_Forward_RPM or
+// Motor_Precision_Left moves. Each move is scored on settle time, overshoot and final
+// step error, and the gain sets that no other set beats on all three (the Pareto
+// front) are listed for each controller.
+//
+// The runs are spread over all cores. A run only touches its own thread's simulation
+// and gains and allocates nothing, so throughput grows with the number of cores.
+//
+// Build (from the repository root):
+//   gcc -O2 -std=gnu11 -pthread -DPRECISION_MOVES_TUNABLE -I Host -I Lab10 -o Host/bin/GainSweep
+//       Host/GainSweep.c Host/Sim.c Lab10/Precision_Moves.c Lab10/Distance.c -lm
+//
+// Usage: Host/bin/GainSweep [-j threads] [table.csv]
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "Sim.h"
+#include "Precision_Moves.h"
+
+
+#define MAX_THREADS     64
+#define TIME_LIMIT_MS   20000  /* Simulated time before a move is declared stuck (ms)           */
+#define SETTLE_BAND     0.05f  /* Wheel speed within this fraction of the target counts as settled */
+#define STOPPED_MM_S    1.0f   /* Wheel speed below which the robot has stopped (mm/s)         */
+
+// Gains swept for each controller (the current values are included)
+static const float KpForward[]       = {0.25f, 0.5f, 1, 1.5f, 2, 3, 4, 6};
+static const float KiForward[]       = {0.05f, 0.1f, 0.15f, 0.2f, 0.3f, 0.4f, 0.5f, 0.75f};
+static const uint32_t ForwardDelay[] = {10, 20, 30, 40, 60, 80, 100};
+static const float KpSpin[]          = {0, 5, 10, 15, 20, 30, 40, 60, 80, 120};
+static const uint32_t SpinDelay[]    = {5, 10, 20, 30, 40, 60};
+#define COUNT(array) (sizeof(array) / sizeof(array[0]))
+#define FORWARD_SETS (COUNT(KpForward) * COUNT(KiForward) * COUNT(ForwardDelay))
+#define SPIN_SETS    (COUNT(KpSpin) * COUNT(SpinDelay))
+#define SETS         (FORWARD_SETS + SPIN_SETS)
+
+// Moves each gain set is scored on
+typedef struct Move{
+    uint32_t speed;     // Motor_Forward_RPM: 0.1 RPM, Motor_Precision_Left: duty cycle
+    uint32_t amount;    // Forward: distance (mm), spin: angle (degrees)
+} Move;
+static const Move ForwardMoves[] = {{400, 600}, {650, 600}, {650, 1000}, {900, 1000}};
+static const Move SpinMoves[]    = {{2500, 90}, {2500, 180}, {4000, 45}, {4000, 90}};
+#define MOVES 4
+#define RUNS  (SETS * MOVES)
+
+// Score of one move or one gain set
+typedef struct Score{
+    float settleMs;     // Forward: until both wheels stay within SETTLE_BAND of the target speed
+                        // Spin: until the robot has stopped
+    float overshoot;    // Forward: largest wheel speed above the target (%), spin: turn past the target (degrees)
+    float error;        // Largest difference between a wheel's final steps and the desired steps
+} Score;
+static Score Scores[RUNS];
+static Score SetScores[SETS];
+static uint8_t Pareto[SETS];
+
+// Next run to be taken by a thread
+static uint32_t NextRun;
+
+// Move being simulated by this thread
+typedef struct Run{
+    const Move* move;
+    int32_t desiredSteps;
+    float startHeading;
+    float lastOutsideMs;
+    float overshoot;
+    uint8_t returned;
+    uint8_t stopped;
+    Score score;
+} Run;
+static _Thread_local Run Current;
+
+
+// ---------- SetGains ----------
+// Sets this thread's gains to gain set i
+static void SetGains(uint32_t i){
+    Precision_Gains.kpSpin = 20;
+    Precision_Gains.spinDelayMs = 20;
+    Precision_Gains.kpForward = 1;
+    Precision_Gains.kiForward = 0.2f;
+    Precision_Gains.forwardDelayMs = 60;
+    if(i < FORWARD_SETS){
+        Precision_Gains.kpForward = KpForward[i % COUNT(KpForward)];
+        Precision_Gains.kiForward = KiForward[(i / COUNT(KpForward)) % COUNT(KiForward)];
+        Precision_Gains.forwardDelayMs = ForwardDelay[i / (COUNT(KpForward) * COUNT(KiForward))];
+    } else {
+        i -= FORWARD_SETS;
+        Precision_Gains.kpSpin = KpSpin[i % COUNT(KpSpin)];
+        Precision_Gains.spinDelayMs = SpinDelay[i / COUNT(KpSpin)];
+    }
+}
+
+
+// ---------- WaitForStop ----------
+// Lets the robot coast to a stop after a move
+static void WaitForStop(void){
+    Current.returned = 1;
+    while(!Current.stopped){
+        Clock_Delay1ms(1);
+    }
+}
+
+
+// ---------- ForwardMonitor ----------
+static void ForwardMonitor(void){
+    float leftSpeed, rightSpeed, leftCommand, rightCommand, target, left, right;
+
+    Sim_GetWheels(&leftSpeed, &rightSpeed, &leftCommand, &rightCommand);
+    if(!Current.returned && leftCommand > 0 && rightCommand > 0){
+        // Driving forward (not braking): wheel speeds in the controller's 0.1 RPM
+        target = Current.move->speed;
+        left = leftSpeed * 600.0f / (PI * DIAMETER_MM);
+        right = rightSpeed * 600.0f / (PI * DIAMETER_MM);
+        if(fabsf(left - target) > SETTLE_BAND * target || fabsf(right - target) > SETTLE_BAND * target){
+            Current.lastOutsideMs = Sim_GetTimeMs();
+        }
+        if(100.0f * (left - target) / target > Current.overshoot){
+            Current.overshoot = 100.0f * (left - target) / target;
+        }
+        if(100.0f * (right - target) / target > Current.overshoot){
+            Current.overshoot = 100.0f * (right - target) / target;
+        }
+    }
+    if(Current.returned && fabsf(leftSpeed) < STOPPED_MM_S && fabsf(rightSpeed) < STOPPED_MM_S){
+        Current.stopped = 1;
+    }
+}
+
+
+// ---------- ForwardProgram ----------
+static void ForwardProgram(void){
+    int32_t leftSteps, rightSteps;
+
+    Motor_Forward_RPM(Current.move->speed, Current.move->speed, Current.desiredSteps, Current.desiredSteps);
+    WaitForStop();
+
+    Tachometer_Get_Steps(&leftSteps, &rightSteps);
+    Current.score.settleMs = Current.lastOutsideMs + 1;
+    Current.score.overshoot = Current.overshoot;
+    Current.score.error = fmaxf(abs(leftSteps - Current.desiredSteps), abs(rightSteps - Current.desiredSteps));
+    Sim_Stop();
+}
+
+
+// ---------- SpinMonitor ----------
+static void SpinMonitor(void){
+    float leftSpeed, rightSpeed, leftCommand, rightCommand, x, y, heading, turned;
+
+    Sim_GetWheels(&leftSpeed, &rightSpeed, &leftCommand, &rightCommand);
+    Sim_GetPose(&x, &y, &heading);
+    turned = heading - Current.startHeading - Current.move->amount;
+    if(turned > Current.overshoot){
+        Current.overshoot = turned;
+    }
+    if(fabsf(leftSpeed) >= STOPPED_MM_S || fabsf(rightSpeed) >= STOPPED_MM_S){
+        Current.lastOutsideMs = Sim_GetTimeMs();
+    } else if(Current.returned){
+        Current.stopped = 1;
+    }
+}
+
+
+// ---------- SpinProgram ----------
+static void SpinProgram(void){
+    int32_t leftSteps, rightSteps;
+
+    Motor_Precision_Left(Current.move->speed, Current.desiredSteps, NO_INTERRUPT);
+    WaitForStop();
+
+    Tachometer_Get_Steps(&leftSteps, &rightSteps);
+    Current.score.settleMs = Current.lastOutsideMs + 1;
+    Current.score.overshoot = Current.overshoot;
+    Current.score.error = fmaxf(abs(-leftSteps - Current.desiredSteps), abs(rightSteps - Current.desiredSteps));
+    Sim_Stop();
+}
+
+
+// ---------- Simulate ----------
+// Runs one move of one gain set on this thread
+static void Simulate(uint32_t run){
+    static const SimWall walls[] = {
+        {-1000,  -300,  1000,  -300},
+        { 1000,  -300,  1000,  2200},
+        { 1000,  2200, -1000,  2200},
+        {-1000,  2200, -1000,  -300}
+    };
+    static const SimArena open = {"open", walls, COUNT(walls)};
+    uint32_t set = run / MOVES, move = run % MOVES;
+    const Run start = {0};
+
+    SetGains(set);
+    Current = start;
+    Sim_Reset(&open, 0, 0, 90);
+    if(set < FORWARD_SETS){
+        Current.move = &ForwardMoves[move];
+        Current.desiredSteps = DISTANCE_TO_STEPS(Current.move->amount);
+        Sim_SetMonitor(ForwardMonitor);
+        Sim_Run(ForwardProgram, TIME_LIMIT_MS);
+    } else {
+        Current.move = &SpinMoves[move];
+        Current.desiredSteps = ANGLE_TO_STEPS(Current.move->amount);
+        Current.startHeading = 90;
+        Sim_SetMonitor(SpinMonitor);
+        Sim_Run(SpinProgram, TIME_LIMIT_MS);
+    }
+    if(!Current.stopped){
+        // Never finished: worst possible score
+        Current.score.settleMs = TIME_LIMIT_MS;
+        Current.score.overshoot = 1000;
+        Current.score.error = 1000;
+    }
+    Scores[run] = Current.score;
+}
+
+
+// ---------- Worker ----------
+static void* Worker(void* arg){
+    uint32_t run;
+    (void)arg;
+
+    while((run = __atomic_fetch_add(&NextRun, 1, __ATOMIC_RELAXED)) < RUNS){
+        Simulate(run);
+    }
+    return 0;
+}
+
+
+// ---------- Dominates ----------
+static int Dominates(const Score* a, const Score* b){
+    return a->settleMs <= b->settleMs && a->overshoot <= b->overshoot && a->error <= b->error
+        && (a->settleMs < b->settleMs || a->overshoot < b->overshoot || a->error < b->error);
+}
+
+
+// ---------- FindPareto ----------
+// Marks the gain sets in [first, last) that no other set in the range dominates
+static void FindPareto(uint32_t first, uint32_t last){
+    uint32_t i, j;
+
+    for(i = first; i < last; i++){
+        Pareto[i] = 1;
+        for(j = first; j < last && Pareto[i]; j++){
+            if(Dominates(&SetScores[j], &SetScores[i])){
+                Pareto[i] = 0;
+            }
+        }
+    }
+}
+
+
+// ---------- PrintTable ----------
+// Prints the Pareto front of [first, last) in order of settle time, plus the current gains
+static void PrintTable(const char* title, uint32_t first, uint32_t last, uint32_t current){
+    uint32_t order[SETS], n = 0, i, j, t;
+
+    for(i = first; i < last; i++){
+        if(Pareto[i] || i == current){
+            order[n++] = i;
+        }
+    }
+    for(i = 1; i < n; i++){
+        for(j = i; j > 0 && SetScores[order[j]].settleMs < SetScores[order[j - 1]].settleMs; j--){
+            t = order[j];
+            order[j] = order[j - 1];
+            order[j - 1] = t;
+        }
+    }
+
+    printf("\n%s\n", title);
+    if(first < FORWARD_SETS){
+        printf("  %6s %6s %9s | %9s %10s %11s\n", "KP", "KI", "delay_ms", "settle_ms", "overshoot%", "error_steps");
+    } else {
+        printf("  %6s %9s | %9s %13s %11s\n", "KP", "delay_ms", "settle_ms", "overshoot_deg", "error_steps");
+    }
+    for(i = 0; i < n; i++){
+        SetGains(order[i]);
+        if(first < FORWARD_SETS){
+            printf("  %6.2f %6.2f %9u | %9.0f %10.1f %11.1f", Precision_Gains.kpForward, Precision_Gains.kiForward,
+                   Precision_Gains.forwardDelayMs, SetScores[order[i]].settleMs, SetScores[order[i]].overshoot,
+                   SetScores[order[i]].error);
+        } else {
+            printf("  %6.0f %9u | %9.0f %13.1f %11.1f", Precision_Gains.kpSpin, Precision_Gains.spinDelayMs,
+                   SetScores[order[i]].settleMs, SetScores[order[i]].overshoot, SetScores[order[i]].error);
+        }
+        printf("%s\n", order[i] == current ? (Pareto[order[i]] ? "  current" : "  current*") : "");
+    }
+}
+
+
+// ---------- WriteCsv ----------
+static void WriteCsv(const char* path){
+    FILE* file = fopen(path, "w");
+    uint32_t i;
+
+    if(file == 0){
+        perror(path);
+        return;
+    }
+    fprintf(file, "controller,kp_spin,spin_delay_ms,kp_forward,ki_forward,forward_delay_ms,settle_ms,overshoot,error_steps,pareto\n");
+    for(i = 0; i < SETS; i++){
+        SetGains(i);
+        fprintf(file, "%s,%g,%u,%g,%g,%u,%.0f,%.2f,%.2f,%u\n", i < FORWARD_SETS ? "forward" : "spin",
+                Precision_Gains.kpSpin, Precision_Gains.spinDelayMs, Precision_Gains.kpForward,
+                Precision_Gains.kiForward, Precision_Gains.forwardDelayMs,
+                SetScores[i].settleMs, SetScores[i].overshoot, SetScores[i].error, Pareto[i]);
+    }
+    fclose(file);
+}
+
+
+// ---------- FindSet ----------
+// Index of the gain set with the given forward or spin gains
+static uint32_t FindSet(uint32_t first, uint32_t last, float kp, float ki, uint32_t delay){
+    uint32_t i;
+
+    for(i = first; i < last; i++){
+        SetGains(i);
+        if(i < FORWARD_SETS && Precision_Gains.kpForward == kp && Precision_Gains.kiForward == ki
+           && Precision_Gains.forwardDelayMs == delay){
+            return i;
+        }
+        if(i >= FORWARD_SETS && Precision_Gains.kpSpin == kp && Precision_Gains.spinDelayMs == delay){
+            return i;
+        }
+    }
+    return last;
+}
+
+
+int main(int argc, char** argv){
+    pthread_t threads[MAX_THREADS];
+    uint32_t numThreads = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN), i, m;
+    const char* csv = 0;
+    struct timespec t0, t1;
+    double seconds;
+
+    for(i = 1; i < (uint32_t)argc; i++){
+        if(strcmp(argv[i], "-j") == 0 && i + 1 < (uint32_t)argc){
+            numThreads = (uint32_t)atoi(argv[++i]);
+        } else {
+            csv = argv[i];
+        }
+    }
+    if(numThreads < 1){numThreads = 1;}
+    if(numThreads > MAX_THREADS){numThreads = MAX_THREADS;}
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(i = 0; i < numThreads; i++){
+        pthread_create(&threads[i], 0, Worker, 0);
+    }
+    for(i = 0; i < numThreads; i++){
+        pthread_join(threads[i], 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    // Each gain set: mean settle time and error, worst overshoot over its moves
+    for(i = 0; i < SETS; i++){
+        SetScores[i].settleMs = 0;
+        SetScores[i].overshoot = 0;
+        SetScores[i].error = 0;
+        for(m = 0; m < MOVES; m++){
+            SetScores[i].settleMs += Scores[i * MOVES + m].settleMs / MOVES;
+            SetScores[i].overshoot = fmaxf(SetScores[i].overshoot, Scores[i * MOVES + m].overshoot);
+            SetScores[i].error += Scores[i * MOVES + m].error / MOVES;
+        }
+    }
+    FindPareto(0, FORWARD_SETS);
+    FindPareto(FORWARD_SETS, SETS);
+
+    printf("%u simulated moves on %u threads in %.2f s (%.0f moves/s)\n", (uint32_t)RUNS, numThreads, seconds, RUNS / seconds);
+    PrintTable("Motor_Forward_RPM Pareto front (KP_FORWARD, KI_FORWARD, FORWARD_DELAY_MS)", 0, FORWARD_SETS,
+               FindSet(0, FORWARD_SETS, 1, 0.2f, 60));
+    PrintTable("Motor_Precision_Left Pareto front (KP_SPIN, SPIN_DELAY_MS)", FORWARD_SETS, SETS,
+               FindSet(FORWARD_SETS, SETS, 20, 0, 20));
+    printf("\ncurrent* = current gains, not on the Pareto front\n");
+
+    if(csv){
+        WriteCsv(csv);
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+// KernelBench.c
+// Runs on a Linux/macOS host
+// Runs the kernel benchmarks of Bench/Bench.c on the host, with more samples and
+// calls than the MSP432 build so the statistics are stable. Times are nanoseconds
+// of CLOCK_MONOTONIC; the output has the same format as the MSP432 build, so two
+// runs (or the two platforms) can be compared line by line.
+//
+// Build (from the repository root):
+//   gcc -O2 -std=gnu11 -DBENCH_SAMPLES=101 -DBENCH_CALLS=1000 -I Host -I Bench -I Lab10 -I Lab08 -o Host/bin/KernelBench
+//       Host/KernelBench.c Bench/Bench.c Host/Sim.c Lab10/Distance.c Lab10/Odometry.c Lab10/Precision_Moves.c Lab10/Planner.c Lab08/UART1.c -lm
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <time.h>
+#include "msp.h"
+#include "Bench.h"
+
+
+// Registers written by Lab08/UART1.c
+HostRegisters HostPort3;
+HostUart HostUartA2;
+HostInterrupts HostNvic;
+
+
+// ---------- Bench_Now ----------
+// Output: uint32_t - nanoseconds, wrapping every 4.3 s
+uint32_t Bench_Now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
+}
+
+
+// ---------- Bench_Output ----------
+void Bench_Output(const char* line){
+    puts(line);
+}
+
+
+int main(void){
+#ifdef __VERSION__
+    Bench_RunAll("host " __VERSION__, "ns");
+#else
+    Bench_RunAll("host", "ns");
+#endif
+    return 0;
+}
@@ -0,0 +1,311 @@
+// LineSim.c
+// Runs on a Linux/macOS host
+// Compares the Lab05 line followers (6-state FSM on the two center sensors and PD
+// steering on the line position from all eight) on simulated tracks. The Lab05
+// main program is compiled once per FOLLOW_MODE and run unmodified on top of
+// Host/Sim.c, with the background reflectance scan replaced by eight simulated
+// sensors over a line of electrical tape. Lap time is the mean over LAPS laps,
+// and the cross-track error is the distance from the center of the sensor array
+// to the middle of the line, sampled every simulated ms.
+//
+// Build (from the repository root):
+//   gcc -O2 -std=gnu11 -I Host -I Lab05 -o Host/bin/LineSim Host/LineSim.c Host/Sim.c Lab05/Line.c Lab05/Fsm.c -lm
+
+#include <stdio.h>
+#include <math.h>
+#include "Sim.h"
+
+// Lab05's main program, once for each line follower
+#define FOLLOW_MODE 0
+#define main  Lab05_MainFsm
+#include "main.c"
+#undef FOLLOW_MODE
+#undef main
+
+#define FOLLOW_MODE 1
+#define main  Lab05_MainPd
+#include "main.c"
+#undef FOLLOW_MODE
+#undef main
+
+
+#define TIME_LIMIT_MS     300000  /* Simulated time before a run is declared stuck (ms)             */
+#define LAPS              3       /* Laps driven by each follower                                  */
+#define LINE_WIDTH_MM     19.0f   /* Width of the tape (mm)                                        */
+#define ARRAY_OFFSET_MM   70.0f   /* Distance of the sensor array in front of the wheels (mm)      */
+#define SENSOR_SPACING_MM 9.5f    /* Distance between two sensors (mm)                             */
+#define DERAILED_MM       120.0f  /* Cross-track error after which the robot has left the track (mm) */
+#define TRACK_STEP_MM     5.0f    /* Distance between the points of a track (mm)                   */
+#define TRACK_POINTS      4096
+#define SEARCH_POINTS     40      /* Points either side of the last one searched for the nearest   */
+#define PI_F              3.14159265f
+
+// Track: closed line through evenly spaced points
+static float TrackX[TRACK_POINTS], TrackY[TRACK_POINTS];
+static uint32_t TrackCount;
+
+// Background scan stood in for by the simulation
+static uint32_t ScanPeriodMs;
+static uint8_t ScanData;
+static uint32_t ScanSequence;
+
+// Progress and cross-track error of the run
+static uint32_t NearestI;
+static int32_t Progress;           // Track points passed, forward
+static uint32_t LapMs[LAPS];
+static uint32_t Laps;
+static double SquaredError;
+static float MaxError;
+static uint32_t Samples;
+static uint8_t Derailed;
+
+static const SimArena NoWalls = {"none", 0, 0};
+
+
+// ---------- Track_Add ----------
+static void Track_Add(float x, float y){
+    if(TrackCount < TRACK_POINTS){
+        TrackX[TrackCount] = x;
+        TrackY[TrackCount] = y;
+        TrackCount++;
+    }
+}
+
+
+// ---------- Track_Arc ----------
+// Adds an arc around (cx, cy) from angle a0 to a1 (radians, either direction)
+static void Track_Arc(float cx, float cy, float radius, float a0, float a1){
+    uint32_t i, n = (uint32_t)(fabsf(a1 - a0) * radius / TRACK_STEP_MM);
+
+    for(i = 0; i < n; i++){
+        float a = a0 + (a1 - a0) * i / n;
+        Track_Add(cx + radius * cosf(a), cy + radius * sinf(a));
+    }
+}
+
+
+// ---------- Track_Line ----------
+// Adds a straight from (x0, y0) up to (x1, y1)
+static void Track_Line(float x0, float y0, float x1, float y1){
+    uint32_t i, n = (uint32_t)(hypotf(x1 - x0, y1 - y0) / TRACK_STEP_MM);
+
+    for(i = 0; i < n; i++){
+        Track_Add(x0 + (x1 - x0) * i / n, y0 + (y1 - y0) * i / n);
+    }
+}
+
+
+// ---------- Track_Oval ----------
+// 1 m straights joined by half circles of 300 mm radius
+static void Track_Oval(void){
+    Track_Line(0, 0, 1000, 0);
+    Track_Arc(1000, 300, 300, -PI_F / 2, PI_F / 2);
+    Track_Line(1000, 600, 0, 600);
+    Track_Arc(0, 300, 300, PI_F / 2, 3 * PI_F / 2);
+}
+
+
+// ---------- Track_Figure8 ----------
+// Lemniscate of Gerono, 1.4 m across, that crosses itself at right angles
+static void Track_Figure8(void){
+    float t = 0, a = 700;
+
+    while(t < 2 * PI_F){
+        Track_Add(a * sinf(t), a * sinf(t) * cosf(t));
+        t += TRACK_STEP_MM / (a * hypotf(cosf(t), cosf(2 * t)));
+    }
+}
+
+
+// ---------- Track_Zigzag ----------
+// Out along alternate bends of 212 mm radius, back along a straight, 180 mm radius ends
+static void Track_Zigzag(void){
+    uint32_t i;
+
+    for(i = 0; i < 4; i++){
+        Track_Arc(300 * i + 150, (i & 1) ? 150 : -150, 150 * sqrtf(2), (i & 1) ? -3 * PI_F / 4 : 3 * PI_F / 4,
+                  (i & 1) ? -PI_F / 4 : PI_F / 4);
+    }
+    Track_Arc(1200, 180, 180, -PI_F / 2, PI_F / 2);
+    Track_Line(1200, 360, 0, 360);
+    Track_Arc(0, 180, 180, PI_F / 2, 3 * PI_F / 2);
+}
+
+
+// ---------- Track_Distance ----------
+// Distance from a point to the segment from point i to point i + 1 of the track
+static float Track_Distance(uint32_t i, float x, float y){
+    uint32_t j = (i + 1) % TrackCount;
+    float dx = TrackX[j] - TrackX[i], dy = TrackY[j] - TrackY[i];
+    float t = ((x - TrackX[i]) * dx + (y - TrackY[i]) * dy) / (dx * dx + dy * dy);
+
+    if(t < 0){t = 0;}
+    if(t > 1){t = 1;}
+    return hypotf(TrackX[i] + t * dx - x, TrackY[i] + t * dy - y);
+}
+
+
+// ---------- Track_OnLine ----------
+// Output: uint8_t - 1 if the point is over the tape, anywhere on the track
+static uint8_t Track_OnLine(float x, float y){
+    uint32_t i;
+
+    for(i = 0; i < TrackCount; i++){
+        if(fabsf(TrackX[i] - x) < 2 * LINE_WIDTH_MM && fabsf(TrackY[i] - y) < 2 * LINE_WIDTH_MM
+           && Track_Distance(i, x, y) <= LINE_WIDTH_MM / 2){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+// ---------- ArrayCenter ----------
+static void ArrayCenter(float* x, float* y, float* heading){
+    Sim_GetPose(x, y, heading);
+    *heading *= PI_F / 180.0f;
+    *x += ARRAY_OFFSET_MM * cosf(*heading);
+    *y += ARRAY_OFFSET_MM * sinf(*heading);
+}
+
+
+// ---------- Scan ----------
+// Reads the eight simulated sensors, bit0 is the robot's right
+static void Scan(void){
+    float x, y, heading, lateral;
+    uint32_t i;
+
+    ArrayCenter(&x, &y, &heading);
+    ScanData = 0;
+    for(i = 0; i < 8; i++){
+        lateral = (3.5f - i) * SENSOR_SPACING_MM;   // To the right
+        if(Track_OnLine(x + lateral * sinf(heading), y - lateral * cosf(heading))){
+            ScanData |= 1 << i;
+        }
+    }
+    ScanSequence++;
+}
+
+
+// ---------- Monitor ----------
+// Runs the background scan and measures the robot's progress along the track
+static void Monitor(void){
+    float x, y, heading, distance, best = 1e9f;
+    uint32_t i, j, bestI = NearestI;
+    int32_t step;
+
+    if(ScanPeriodMs && (Sim_GetTimeMs() % ScanPeriodMs) == 0){
+        Scan();
+    }
+
+    // Nearest segment near the last one, so a crossing is not taken for progress
+    ArrayCenter(&x, &y, &heading);
+    for(j = 0; j <= 2 * SEARCH_POINTS; j++){
+        i = (NearestI + TrackCount - SEARCH_POINTS + j) % TrackCount;
+        distance = Track_Distance(i, x, y);
+        if(distance < best){
+            best = distance;
+            bestI = i;
+        }
+    }
+    step = (int32_t)bestI - (int32_t)NearestI;
+    if(step > (int32_t)TrackCount / 2){step -= TrackCount;}
+    if(step < -(int32_t)TrackCount / 2){step += TrackCount;}
+    Progress += step;
+    NearestI = bestI;
+
+    SquaredError += (double)best * best;
+    if(best > MaxError){
+        MaxError = best;
+    }
+    Samples++;
+
+    if(best > DERAILED_MM){
+        Derailed = 1;
+        Sim_Stop();
+    }
+    if(Progress >= (int32_t)((Laps + 1) * TrackCount)){
+        LapMs[Laps++] = Sim_GetTimeMs();
+        if(Laps == LAPS){
+            Sim_Stop();
+        }
+    }
+}
+
+
+// Background reflectance scan of Reflectance.c, stood in for by Scan
+void Reflectance_Init(void){}
+void Reflectance_Scan(uint32_t period, uint32_t sampleTime){
+    (void)sampleTime;
+    ScanPeriodMs = (period + 999) / 1000;
+    ScanSequence = 0;
+}
+void Reflectance_ScanStop(void){ ScanPeriodMs = 0; }
+uint8_t Reflectance_Get(void){ return ScanData; }
+uint32_t Reflectance_GetFrame(uint8_t* data){
+    *data = ScanData;
+    return ScanSequence;
+}
+
+
+typedef struct Track{
+    const char* name;
+    void (*build)(void);
+} Track;
+
+static const Track Tracks[] = {
+    {"oval",    Track_Oval},
+    {"figure8", Track_Figure8},
+    {"zigzag",  Track_Zigzag}
+};
+
+typedef struct Mode{
+    const char* name;
+    SimProgram program;
+} Mode;
+
+static const Mode Modes[] = {
+    {"fsm", Lab05_MainFsm},
+    {"pd",  Lab05_MainPd}
+};
+
+
+int main(void){
+    uint32_t t, m;
+    float heading, length;
+
+    printf("%-8s %-5s %-9s %4s %8s %9s %8s %8s\n", "track", "mode", "result", "laps", "lap_s", "speed_mms", "rms_mm", "max_mm");
+    for(t = 0; t < sizeof(Tracks) / sizeof(Tracks[0]); t++){
+        TrackCount = 0;
+        Tracks[t].build();
+        length = 0;
+        for(m = 0; m < TrackCount; m++){
+            length += hypotf(TrackX[(m + 1) % TrackCount] - TrackX[m], TrackY[(m + 1) % TrackCount] - TrackY[m]);
+        }
+        heading = atan2f(TrackY[1] - TrackY[0], TrackX[1] - TrackX[0]) * 180.0f / PI_F;
+
+        for(m = 0; m < sizeof(Modes) / sizeof(Modes[0]); m++){
+            // Start with the sensor array over the first point of the track
+            Sim_Reset(&NoWalls, TrackX[0] - ARRAY_OFFSET_MM * cosf(heading * PI_F / 180.0f),
+                      TrackY[0] - ARRAY_OFFSET_MM * sinf(heading * PI_F / 180.0f), heading);
+            Sim_SetMonitor(Monitor);
+            ScanPeriodMs = 0;
+            ScanData = 0;
+            NearestI = 0;
+            Progress = 0;
+            Laps = 0;
+            SquaredError = 0;
+            MaxError = 0;
+            Samples = 0;
+            Derailed = 0;
+            Sim_Run(Modes[m].program, TIME_LIMIT_MS);
+
+            printf("%-8s %-5s %-9s %4u %8.2f %9.0f %8.1f %8.1f\n", Tracks[t].name, Modes[m].name,
+                   Derailed ? "derailed" : (Laps == LAPS ? "completed" : "stopped"), Laps,
+                   Laps ? LapMs[Laps - 1] / 1000.0f / Laps : 0.0f,
+                   Laps ? Laps * length * 1000.0f / LapMs[Laps - 1] : 0.0f,
+                   Samples ? sqrt(SquaredError / Samples) : 0.0, MaxError);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+// MclEval.c
+// Runs on a Linux/macOS host
+// Evaluates the Lab10 Monte Carlo localization with different numbers of particles
+// and threads. The simulated robot starts a little away from where it believes it
+// is, then drives laps around the Lab10 course (Arena.c) with mis-sized wheels and
+// noisy distance sensors. The particle filter and plain dead reckoning see the same
+// tachometer steps and distance readings every 20 ms; their errors are measured
+// against the true pose, and the filter's predict and update steps are timed.
+//
+// Build (from the repository root):
+//   gcc -O2 -std=gnu11 -DMCL_MAX_PARTICLES=4096 -DMCL_MAX_THREADS=4 -pthread -I Host -I Lab10
+//       -o Host/bin/MclEval Host/MclEval.c Host/Sim.c Lab10/MCL.c Lab10/Arena.c Lab10/Distance.c -lm
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <time.h>
+#include "Sim.h"
+#include "MCL.h"
+
+
+#define PERIOD_MS       20      /* Estimator period, the same as BUG_PERIOD_MS (ms)       */
+#define LAPS            3       /* Laps of the course per run                             */
+#define RANGE_NOISE     0.03f   /* Distance sensor noise (fraction of the distance)       */
+#define WHEEL_ERROR     0.01f   /* Left wheel drives further, right wheel shorter         */
+#define START_ERROR_X   60      /* True start relative to the believed start (mm)         */
+#define START_ERROR_Y   -40     /* True start relative to the believed start (mm)         */
+#define START_ERROR_DEG 4       /* True start relative to the believed start (degrees)    */
+#define POS_SPREAD      100     /* Initial particle spread (mm)                           */
+#define HEADING_SPREAD  5       /* Initial particle spread (degrees)                      */
+#define CORNER_MM       80      /* Distance from a lap corner that counts as reaching it  */
+#define BASE_DUTY       3900    /* Duty cycle when driving straight                       */
+
+// Particles and threads of each run
+static const uint32_t Particles[] = {50, 100, 300, 1000, 1000, 4000, 4000};
+static const uint32_t Threads[]   = {1,  1,   1,   1,    4,    1,    4};
+#define RUNS (sizeof(Particles) / sizeof(Particles[0]))
+
+// Corners of a lap, 300 mm inside the course walls
+static const float LapX[] = {0,    ARENA_MAX_X_MM - 300, ARENA_MAX_X_MM - 300, ARENA_MIN_X_MM + 300, ARENA_MIN_X_MM + 300, 0};
+static const float LapY[] = {1500, 1500,                 ARENA_MIN_Y_MM + 300, ARENA_MIN_Y_MM + 300, 1500,                 1500};
+#define LAP_CORNERS (sizeof(LapX) / sizeof(LapX[0]))
+
+// Error statistics of one estimator
+typedef struct Errors{
+    double sumSq;
+    float final;
+    float maxHeading;
+} Errors;
+static Errors DeadReckoning, Filter;
+static uint32_t Periods;
+static uint64_t PredictNs, UpdateNs;
+
+static SimWall CourseWalls[ARENA_NUM_WALLS];
+
+
+// ---------- NowNs ----------
+static uint64_t NowNs(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+
+// ---------- WrapDegrees ----------
+static float WrapDegrees(float angle){
+    while(angle > 180){angle -= 360;}
+    while(angle < -180){angle += 360;}
+    return angle;
+}
+
+
+// ---------- Accumulate ----------
+static void Accumulate(Errors* e, float dx, float dy, float dh){
+    e->sumSq += dx*dx + dy*dy;
+    e->final = sqrtf(dx*dx + dy*dy);
+    if(fabsf(dh) > e->maxHeading){
+        e->maxHeading = fabsf(dh);
+    }
+}
+
+
+// ---------- Drive ----------
+// Program run by the simulation: drives the laps with the true pose and runs both
+// estimators on the sensor data
+static void Drive(void){
+    float x, y, h, bearing, dlX = 0, dlY = 0, dlH = PI / 2, leftDist, rightDist, distance, turn;
+    int32_t leftSteps, rightSteps, prevLeft = 0, prevRight = 0, steer;
+    uint32_t corner = 0, lap = 0, left, center, right;
+    uint64_t t0;
+    MCL_Estimate est;
+
+    while(lap < LAPS){
+        // Steer along the lap with the true pose
+        Sim_GetPose(&x, &y, &h);
+        if(hypotf(LapX[corner] - x, LapY[corner] - y) < CORNER_MM){
+            corner++;
+            if(corner == LAP_CORNERS){
+                corner = 1;
+                lap++;
+            }
+        }
+        bearing = WrapDegrees(atan2f(LapY[corner] - y, LapX[corner] - x) * 180.0f / PI - h);
+        if(bearing > 30){
+            Motor_Left(2500, 2500);
+        } else if(bearing < -30){
+            Motor_Right(2500, 2500);
+        } else {
+            steer = (int32_t)(bearing * 60);
+            Motor_Forward(BASE_DUTY - steer, BASE_DUTY + steer);
+        }
+        Clock_Delay1ms(PERIOD_MS);
+
+        // Both estimators see the same wheel distances and readings
+        Tachometer_Get_Steps(&leftSteps, &rightSteps);
+        leftDist = (leftSteps - prevLeft) * PI * DIAMETER_MM / PULSES_PER_REV;
+        rightDist = (rightSteps - prevRight) * PI * DIAMETER_MM / PULSES_PER_REV;
+        prevLeft = leftSteps;
+        prevRight = rightSteps;
+        Distance_GetDistances(&left, &center, &right);
+
+        distance = (leftDist + rightDist) / 2.0f;
+        turn = (rightDist - leftDist) / WIDTH_MM;
+        dlX += distance * cosf(dlH + turn / 2.0f);
+        dlY += distance * sinf(dlH + turn / 2.0f);
+        dlH += turn;
+
+        t0 = NowNs();
+        MCL_Predict(leftDist, rightDist);
+        PredictNs += NowNs() - t0;
+        t0 = NowNs();
+        MCL_Update(left, center, right);
+        UpdateNs += NowNs() - t0;
+        MCL_GetEstimate(&est);
+
+        // Errors against the true pose
+        Sim_GetPose(&x, &y, &h);
+        Accumulate(&DeadReckoning, dlX - x, dlY - y, WrapDegrees(dlH * 180.0f / PI - h));
+        Accumulate(&Filter, est.xPos - x, est.yPos - y, WrapDegrees(est.heading - h));
+        Periods++;
+    }
+
+    Motor_Stop();
+    while(1){
+        Clock_Delay1ms(PERIOD_MS);
+    }
+}
+
+
+int main(void){
+    static const SimArena Course = {"course", CourseWalls, ARENA_NUM_WALLS};
+    const Errors zero = {0, 0, 0};
+    SimConfig config;
+    uint32_t i, run;
+
+    for(i = 0; i < ARENA_NUM_WALLS; i++){
+        CourseWalls[i].x0 = ArenaWalls[i].x0;
+        CourseWalls[i].y0 = ArenaWalls[i].y0;
+        CourseWalls[i].x1 = ArenaWalls[i].x1;
+        CourseWalls[i].y1 = ArenaWalls[i].y1;
+    }
+
+    printf("%-9s %-7s | %-26s | %-26s | %s\n", "particles", "threads",
+           "dead reckoning: rms/final mm", "MCL: rms/final mm, max deg", "predict/update us per period");
+    for(run = 0; run < RUNS; run++){
+        Sim_Reset(&Course, START_ERROR_X, START_ERROR_Y, 90 + START_ERROR_DEG);
+        config.leftWheelError = WHEEL_ERROR;
+        config.rightWheelError = -WHEEL_ERROR;
+        config.rangeNoise = RANGE_NOISE;
+        config.seed = 443;
+        Sim_Configure(&config);
+
+        MCL_Init(0, 0, 90, POS_SPREAD, HEADING_SPREAD, Particles[run]);
+        MCL_SetThreads(Threads[run]);
+        DeadReckoning = zero;
+        Filter = zero;
+        Periods = 0;
+        PredictNs = 0;
+        UpdateNs = 0;
+        Sim_Run(Drive, 600000);
+
+        printf("%-9u %-7u | %7.0f %7.0f             | %7.0f %7.0f %6.1f      | %8.1f %8.1f\n",
+               Particles[run], Threads[run],
+               sqrt(DeadReckoning.sumSq / Periods), DeadReckoning.final,
+               sqrt(Filter.sumSq / Periods), Filter.final, Filter.maxHeading,
+               PredictNs / 1000.0 / Periods, UpdateNs / 1000.0 / Periods);
+    }
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+// NavSim.c
+// Runs on a Linux/macOS host
+// Compares the Lab10 navigation modes (spin-and-forward, grid planner and
+// Tangent-Bug/Bug2) in simulated arenas. The Lab10 main program is compiled once
+// per NAVIGATION_MODE and run unmodified on top of Host/Sim.c, from the starting
+// pose to the destination defined in Lab10/main.c. Mission time is the simulated
+// time until the robot stops for good, and path length is the distance its
+// center actually drove. The planner inflates its grid by the robot radius and
+// the bug mode keeps its distance from boundaries, so any wall contact in those
+// modes is reported as FAIL and NavSim exits with 1.
+//
+// Build (from the repository root):
+//   gcc -O2 -std=gnu11 -I Host -I Lab10 -o Host/bin/NavSim Host/NavSim.c Host/Sim.c
+//       Lab10/Odometry.c Lab10/Precision_Moves.c Lab10/Distance.c Lab10/Planner.c Lab10/Bug.c Lab10/Journal.c -lm
+//
+// Built with -DSIM_JOURNAL -DJOURNAL_SIZE=1048576, "Host/bin/NavSim <folder>" also saves
+// the journal of every run (Lab10/Journal.h) to <folder>/<arena>_<mode>.jrn for Host/Replay.c.
+
+#include <stdio.h>
+#include <math.h>
+#include "Sim.h"
+
+// The simulated drivers record with SIM_JOURNAL, main.c starts the journal with JOURNAL_RECORD
+#ifdef SIM_JOURNAL
+#define JOURNAL_RECORD
+#endif
+
+// Lab10's main program, once for each navigation mode
+#define NAVIGATION_MODE 0
+#define main  Lab10_MainSpinAndForward
+#define Pause Lab10_PauseSpinAndForward
+#include "main.c"
+#undef NAVIGATION_MODE
+#undef main
+#undef Pause
+
+#define NAVIGATION_MODE 1
+#define main  Lab10_MainPlanner
+#define Pause Lab10_PausePlanner
+#include "main.c"
+#undef NAVIGATION_MODE
+#undef main
+#undef Pause
+
+#define NAVIGATION_MODE 2
+#define main  Lab10_MainBug
+#define Pause Lab10_PauseBug
+#include "main.c"
+#undef NAVIGATION_MODE
+#undef main
+#undef Pause
+
+
+#define TIME_LIMIT_MS    180000  /* Simulated time before a run is declared stuck (ms)       */
+#define REACHED_MM       100     /* Final distance to the destination that counts as reached */
+
+// Outer walls of the arena around the start and the destination
+#define BOUNDARY \
+    {-1000,  -300,  1000,  -300}, \
+    { 1000,  -300,  1000,  2200}, \
+    { 1000,  2200, -1000,  2200}, \
+    {-1000,  2200, -1000,  -300}
+
+static const SimWall OpenWalls[] = {
+    BOUNDARY
+};
+
+// Box centered on the straight line to the destination
+static const SimWall BoxWalls[] = {
+    BOUNDARY,
+    {-200,  800,  200,  800},
+    { 200,  800,  200, 1000},
+    { 200, 1000, -200, 1000},
+    {-200, 1000, -200,  800}
+};
+
+// Long wall that is only open on the right
+static const SimWall WallWalls[] = {
+    BOUNDARY,
+    {-1000, 900,  400,  900}
+};
+
+// U opening towards the start, so driving straight at the destination gets trapped
+static const SimWall UTrapWalls[] = {
+    BOUNDARY,
+    {-400, 1100,  400, 1100},
+    {-400,  600, -400, 1100},
+    { 400,  600,  400, 1100}
+};
+
+// Two staggered walls
+static const SimWall SlalomWalls[] = {
+    BOUNDARY,
+    {-1000, 600,  300,  600},
+    { -300, 1300, 1000, 1300}
+};
+
+#define ARENA(name, walls) {name, walls, sizeof(walls) / sizeof(walls[0])}
+static const SimArena Arenas[] = {
+    ARENA("open",   OpenWalls),
+    ARENA("box",    BoxWalls),
+    ARENA("wall",   WallWalls),
+    ARENA("u_trap", UTrapWalls),
+    ARENA("slalom", SlalomWalls)
+};
+
+typedef struct Mode{
+    const char* name;
+    SimProgram program;
+    int contactFree;      // 1 if any contact with a wall fails the run
+} Mode;
+
+static const Mode Modes[] = {
+    {"spin_forward", Lab10_MainSpinAndForward, 0},
+    {"planner",      Lab10_MainPlanner,        1},
+    {"bug",          Lab10_MainBug,            1}
+};
+
+
+#ifdef SIM_JOURNAL
+// ---------- SaveJournal ----------
+static void SaveJournal(const char* folder, const char* arena, const char* mode){
+    char path[256];
+    FILE* file;
+
+    snprintf(path, sizeof(path), "%s/%s_%s.jrn", folder, arena, mode);
+    file = fopen(path, "wb");
+    if(file == 0){
+        perror(path);
+        return;
+    }
+    fwrite(&Journal, 1, JOURNAL_HEADER_BYTES + Journal.length, file);
+    fclose(file);
+}
+#endif
+
+
+int main(int argc, char** argv){
+    uint32_t a, m;
+    SimResult result;
+    float error;
+    int failed = 0;
+
+    printf("%-8s %-13s %-8s %9s %9s %9s %10s\n", "arena", "mode", "result", "time_s", "path_mm", "error_mm", "contact_ms");
+    for(a = 0; a < sizeof(Arenas) / sizeof(Arenas[0]); a++){
+        for(m = 0; m < sizeof(Modes) / sizeof(Modes[0]); m++){
+            Sim_Reset(&Arenas[a], STARTING_X_POS, STARTING_Y_POS, STARTING_HEADING);
+            result = Sim_Run(Modes[m].program, TIME_LIMIT_MS);
+            error = hypotf(result.xPos - DESTINATION_X_POS, result.yPos - DESTINATION_Y_POS);
+            printf("%-8s %-13s %-8s %9.1f %9.0f %9.0f %10u\n", Arenas[a].name, Modes[m].name,
+                   result.timedOut ? "timeout" : (error < REACHED_MM ? "reached" : "stopped"),
+                   result.timeMs / 1000.0f, result.pathMM, error, result.collisionMs);
+            if(Modes[m].contactFree && result.collisionMs > 0){
+                printf("FAIL: %s touched a wall in %s\n", Modes[m].name, Arenas[a].name);
+                failed = 1;
+            }
+#ifdef SIM_JOURNAL
+            if(argc > 1){
+                SaveJournal(argv[1], Arenas[a].name, Modes[m].name);
+            }
+#else
+            (void)argc;
+            (void)argv;
+#endif
+        }
+    }
+    return failed;
+}
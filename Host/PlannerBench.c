@@ -0,0 +1,270 @@
+// PlannerBench.c
+// Runs on a Linux/macOS host
+// Benchmarks the Lab10 D* Lite planner on synthetic mazes. A simulated robot
+// only sees the obstacles within SENSE_RADIUS cells, marks them in the planner
+// and replans every step, the same way the robot discovers an arena. Timing is
+// reported for the replans that followed newly seen obstacles.
+// Afterwards every incremental replan is checked against a full search of the
+// map as it was known at that replan.
+//
+// Build (from the repository root):
+//   gcc -O2 -std=c99 -I Lab10 -o Host/bin/PlannerBench Host/PlannerBench.c Lab10/Planner.c
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "Planner.h"
+
+
+#define SENSE_RADIUS   4      /* Cells around the robot that the simulated sensors can see */
+#define MAX_STEPS      2000   /* Steps before a run is declared stuck */
+#define WORST_CASE_REPEATS 100 /* Repetitions of the worst-case replan */
+#define RANDOM_PERCENT 2      /* Obstacle cells in the random maze (%), each blocks 5x5 cells after inflation */
+
+#define START_COL      (PLANNER_GRID_WIDTH / 2)
+#define START_ROW      4
+#define GOAL_COL       (PLANNER_GRID_WIDTH / 2)
+#define GOAL_ROW       (PLANNER_GRID_HEIGHT - 4)
+
+// Hidden arena and the step at which the robot first saw each obstacle (0 = unseen)
+static uint8_t World[PLANNER_GRID_HEIGHT][PLANNER_GRID_WIDTH];
+static uint32_t Known[PLANNER_GRID_HEIGHT][PLANNER_GRID_WIDTH];
+
+// Robot position and path cost at every replan
+typedef struct Replan{
+    int32_t col, row;
+    uint32_t step;
+    uint32_t cost;
+} Replan;
+static Replan Replans[MAX_STEPS];
+
+typedef void (*MazeBuilder)(void);
+
+
+// ---------- CellX / CellY ----------
+// Position of the center of a cell (mm)
+static int32_t CellX(int32_t col){ return PLANNER_ORIGIN_X_MM + col * PLANNER_CELL_MM + PLANNER_CELL_MM / 2; }
+static int32_t CellY(int32_t row){ return PLANNER_ORIGIN_Y_MM + row * PLANNER_CELL_MM + PLANNER_CELL_MM / 2; }
+
+
+// ---------- NowNs ----------
+static uint64_t NowNs(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+
+// ---------- Maze builders ----------
+static void Wall(int32_t c0, int32_t r0, int32_t c1, int32_t r1){
+    int32_t c, r;
+    for(r = r0; r <= r1; r++){
+        for(c = c0; c <= c1; c++){
+            World[r][c] = 1;
+        }
+    }
+}
+
+static void BuildOpen(void){
+}
+
+static void BuildUTrap(void){
+    // U opening towards the start, directly between the start and the goal
+    Wall(START_COL - 8, START_ROW + 14, START_COL + 8, START_ROW + 14);
+    Wall(START_COL - 8, START_ROW + 6, START_COL - 8, START_ROW + 14);
+    Wall(START_COL + 8, START_ROW + 6, START_COL + 8, START_ROW + 14);
+}
+
+static void BuildRandom(void){
+    int32_t c, r;
+    srand(443);
+    for(r = 0; r < PLANNER_GRID_HEIGHT; r++){
+        for(c = 0; c < PLANNER_GRID_WIDTH; c++){
+            World[r][c] = (rand() % 100) < RANDOM_PERCENT;
+        }
+    }
+}
+
+static void BuildCorridors(void){
+    int32_t r;
+    // Alternating walls with a gap at one end, forming a serpentine corridor
+    for(r = START_ROW + 5; r < GOAL_ROW - 3; r += 6){
+        if(((r - START_ROW) / 6) & 1){
+            Wall(4, r, PLANNER_GRID_WIDTH - 1, r);
+        } else {
+            Wall(0, r, PLANNER_GRID_WIDTH - 5, r);
+        }
+    }
+}
+
+
+// ---------- Sense ----------
+// Marks the hidden obstacles near the robot in the planner
+// Output: number of newly known obstacle cells
+static uint32_t Sense(int32_t col, int32_t row, uint32_t step){
+    int32_t c, r;
+    uint32_t found = 0;
+    for(r = row - SENSE_RADIUS; r <= row + SENSE_RADIUS; r++){
+        for(c = col - SENSE_RADIUS; c <= col + SENSE_RADIUS; c++){
+            if(r < 0 || c < 0 || r >= PLANNER_GRID_HEIGHT || c >= PLANNER_GRID_WIDTH){
+                continue;
+            }
+            if(World[r][c] && !Known[r][c]){
+                Known[r][c] = step;
+                Planner_MarkOccupied(CellX(c), CellY(r));
+                found++;
+            }
+        }
+    }
+    return found;
+}
+
+
+// ---------- FullSearchCost ----------
+// Plans from scratch on the map known at a step (reference for the incremental result)
+static uint32_t FullSearchCost(int32_t col, int32_t row, uint32_t step, uint64_t* ns, uint32_t* expansions){
+    int32_t c, r;
+    uint64_t t0;
+
+    t0 = NowNs();
+    Planner_Init(CellX(col), CellY(row), CellX(GOAL_COL), CellY(GOAL_ROW));
+    for(r = 0; r < PLANNER_GRID_HEIGHT; r++){
+        for(c = 0; c < PLANNER_GRID_WIDTH; c++){
+            if(Known[r][c] != 0 && Known[r][c] <= step){
+                Planner_MarkOccupied(CellX(c), CellY(r));
+            }
+        }
+    }
+    Planner_Replan(CellX(col), CellY(row));
+    *ns = NowNs() - t0;
+    *expansions = Planner_GetExpansions();
+    return Planner_GetPathCost();
+}
+
+
+// ---------- RunMaze ----------
+static void RunMaze(const char* name, MazeBuilder build){
+    Waypoint path[PLANNER_MAX_WAYPOINTS];
+    int32_t col = START_COL, row = START_ROW;
+    int32_t c, r, dc, dr;
+    uint32_t steps = 0, replans = 0, mismatches = 0, expansions, fullExpansions;
+    uint32_t maxExpansions = 0, maxFullExpansions = 0, fullCost, found, i;
+    uint64_t t0, ns, fullNs, totalNs = 0, maxNs = 0, totalFullNs = 0, maxFullNs = 0;
+    uint64_t totalExpansions = 0;
+    planner_t result;
+
+    for(r = 0; r < PLANNER_GRID_HEIGHT; r++){
+        for(c = 0; c < PLANNER_GRID_WIDTH; c++){
+            World[r][c] = 0;
+            Known[r][c] = 0;
+        }
+    }
+    build();
+    World[START_ROW][START_COL] = 0;
+    World[GOAL_ROW][GOAL_COL] = 0;
+
+    // Initial plan with an empty map
+    t0 = NowNs();
+    result = Planner_Init(CellX(col), CellY(row), CellX(GOAL_COL), CellY(GOAL_ROW));
+    ns = NowNs() - t0;
+    printf("%-10s initial search: %6llu ns, %5u expansions\n", name, (unsigned long long)ns, Planner_GetExpansions());
+
+    while(result == PLANNER_OK && (col != GOAL_COL || row != GOAL_ROW) && steps < MAX_STEPS){
+        // Discover obstacles and move the start to the robot's cell
+        found = Sense(col, row, steps + 1);
+        t0 = NowNs();
+        result = Planner_Replan(CellX(col), CellY(row));
+        ns = NowNs() - t0;
+        if(found > 0){
+            expansions = Planner_GetExpansions();
+            Replans[replans].col = col;
+            Replans[replans].row = row;
+            Replans[replans].step = steps + 1;
+            Replans[replans].cost = Planner_GetPathCost();
+            replans++;
+            totalNs += ns;
+            totalExpansions += expansions;
+            if(ns > maxNs){maxNs = ns;}
+            if(expansions > maxExpansions){maxExpansions = expansions;}
+        }
+        if(result != PLANNER_OK){
+            break;
+        }
+
+        // Step one cell towards the first waypoint
+        if(Planner_GetWaypoints(path, PLANNER_MAX_WAYPOINTS) == 0){
+            result = PLANNER_NO_PATH;
+            break;
+        }
+        dc = path[0].xPos - CellX(col);
+        dr = path[0].yPos - CellY(row);
+        col += (dc > PLANNER_CELL_MM / 2) - (dc < -PLANNER_CELL_MM / 2);
+        row += (dr > PLANNER_CELL_MM / 2) - (dr < -PLANNER_CELL_MM / 2);
+        steps++;
+    }
+
+    // A from-scratch search of the same map must agree with every repaired one
+    for(i = 0; i < replans; i++){
+        fullCost = FullSearchCost(Replans[i].col, Replans[i].row, Replans[i].step, &fullNs, &fullExpansions);
+        totalFullNs += fullNs;
+        if(fullNs > maxFullNs){maxFullNs = fullNs;}
+        if(fullExpansions > maxFullExpansions){maxFullExpansions = fullExpansions;}
+        if(fullCost != Replans[i].cost){
+            mismatches++;
+        }
+    }
+
+    printf("%-10s %s after %u steps, %u replans, %u cost mismatches\n", name,
+           (col == GOAL_COL && row == GOAL_ROW) ? "reached goal" : "FAILED", steps, replans, mismatches);
+    if(replans > 0){
+        printf("%-10s incremental replan: mean %6llu ns, max %6llu ns, mean %5llu / max %5u expansions\n", name,
+               (unsigned long long)(totalNs / replans), (unsigned long long)maxNs,
+               (unsigned long long)(totalExpansions / replans), maxExpansions);
+        printf("%-10s full search:        mean %6llu ns, max %6llu ns, max %5u expansions\n", name,
+               (unsigned long long)(totalFullNs / replans), (unsigned long long)maxFullNs, maxFullExpansions);
+    }
+}
+
+
+// ---------- WorstCase ----------
+// The robot is sealed in a box, so the backwards search has to expand every cell
+// reachable from the goal before it can report that there is no path
+static void WorstCase(void){
+    uint64_t t0, ns = 0;
+    uint32_t i, expansions = 0;
+    planner_t result = PLANNER_OK;
+
+    for(i = 0; i < WORST_CASE_REPEATS; i++){
+        Planner_Init(CellX(START_COL), CellY(START_ROW), CellX(GOAL_COL), CellY(GOAL_ROW));
+        Planner_MarkOccupied(CellX(START_COL), CellY(START_ROW + 2));
+        Planner_MarkOccupied(CellX(START_COL), CellY(START_ROW - 2));
+        Planner_MarkOccupied(CellX(START_COL + 2), CellY(START_ROW));
+        Planner_MarkOccupied(CellX(START_COL - 2), CellY(START_ROW));
+        Planner_MarkOccupied(CellX(START_COL + 2), CellY(START_ROW + 2));
+        Planner_MarkOccupied(CellX(START_COL - 2), CellY(START_ROW + 2));
+        Planner_MarkOccupied(CellX(START_COL + 2), CellY(START_ROW - 2));
+        Planner_MarkOccupied(CellX(START_COL - 2), CellY(START_ROW - 2));
+        t0 = NowNs();
+        result = Planner_Replan(CellX(START_COL), CellY(START_ROW));
+        ns += NowNs() - t0;
+        expansions += Planner_GetExpansions();
+    }
+
+    printf("%-10s %s, mean %6llu ns, %5u expansions, %llu ns per expansion\n", "sealed",
+           (result == PLANNER_NO_PATH) ? "no path" : "UNEXPECTED PATH",
+           (unsigned long long)(ns / WORST_CASE_REPEATS), expansions / WORST_CASE_REPEATS,
+           (unsigned long long)(ns / expansions));
+}
+
+
+int main(void){
+    printf("grid %dx%d cells of %d mm\n", PLANNER_GRID_WIDTH, PLANNER_GRID_HEIGHT, PLANNER_CELL_MM);
+    RunMaze("open", BuildOpen);
+    RunMaze("u_trap", BuildUTrap);
+    RunMaze("random", BuildRandom);
+    RunMaze("corridors", BuildCorridors);
+    WorstCase();
+    return 0;
+}
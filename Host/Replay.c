@@ -0,0 +1,350 @@
+// Replay.c
+// Runs on a Linux/macOS host
+// Replays journals recorded by Lab10/Journal.c through the Lab10 program and checks
+// that it gives the same motor commands. The recorded ADC results are returned by
+// ADC_In17_14_16, and the recorded tachometer edges are fed to Lab10/Tachometer.c's
+// own interrupt callbacks just before each read, so Distance, Tachometer,
+// Precision_Moves and Odometry all run unmodified. Delays take no time, so a run
+// replays as fast as the host can execute it. The first motor command that differs
+// from the journal, or a sensor read the journal does not have, fails the replay.
+// It is built with JOURNAL_RECORD, so the Lab10 code makes the same journal calls
+// as when it recorded, and this file answers them from the journal.
+//
+// Build (from the repository root):
+//   gcc -O2 -std=gnu11 -DJOURNAL_RECORD -I Host -I Lab10 -o Host/bin/Replay Host/Replay.c Lab10/Tachometer.c
+//       Lab10/Odometry.c Lab10/Precision_Moves.c Lab10/Distance.c Lab10/Planner.c Lab10/Bug.c -lm
+//
+// Usage: Host/bin/Replay <journal.jrn> ...
+// Journals come from a robot (see Lab10/Journal.h) or from Host/NavSim.c built with
+// -DSIM_JOURNAL. Exits with 1 if any replay fails, so a folder of captured runs can
+// be used as a regression test after changing the controllers.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+#include "msp.h"
+#include "Journal.h"
+
+// Lab10's main program, once for each navigation mode
+#define NAVIGATION_MODE 0
+#define main  Lab10_MainSpinAndForward
+#define Pause Lab10_PauseSpinAndForward
+#include "main.c"
+#undef NAVIGATION_MODE
+#undef main
+#undef Pause
+
+#define NAVIGATION_MODE 1
+#define main  Lab10_MainPlanner
+#define Pause Lab10_PausePlanner
+#include "main.c"
+#undef NAVIGATION_MODE
+#undef main
+#undef Pause
+
+#define NAVIGATION_MODE 2
+#define main  Lab10_MainBug
+#define Pause Lab10_PauseBug
+#include "main.c"
+#undef NAVIGATION_MODE
+#undef main
+#undef Pause
+
+
+#define IDLE_LIMIT_MS  60000  /* Delay without any sensor read or motor command that ends a replay (ms) */
+
+#define REPLAY_PASSED  0
+#define REPLAY_FAILED  1
+
+static void (* const Programs[])(void) = {Lab10_MainSpinAndForward, Lab10_MainPlanner, Lab10_MainBug};
+static const char* const ModeNames[] = {"spin_forward", "planner", "bug"};
+static const char* const CommandNames[] = {"Stop", "Forward", "Right", "Left", "Backward"};
+
+// State of Lab10/Tachometer.c, cleared before each replay
+extern uint16_t Tachometer_FirstRightTime, Tachometer_SecondRightTime;
+extern uint16_t Tachometer_FirstLeftTime, Tachometer_SecondLeftTime;
+extern uint32_t timeAccumulatorLeft, timeAccumulatorRight;
+extern int Tachometer_RightSteps, Tachometer_LeftSteps;
+
+// Registers written by the lab sources
+HostRegisters HostWatchdog;
+HostRegisters HostPort5;
+HostTimer HostTimerA3;
+
+// Journal being replayed
+static const uint8_t* Data;
+static uint32_t Length, Pos;
+static uint32_t ReadRepeats;      // Reads left in the current JOURNAL_READ record
+static uint16_t Capture[2];       // Capture time of each wheel's last edge
+static uint32_t Commands, Reads, IdleMs;
+static uint64_t DelayMs;
+static char Failure[200];
+static jmp_buf ReplayExit;
+
+// Tachometer interrupt callbacks registered by Tachometer_Init
+static void (*RightEdge)(uint16_t time);
+static void (*LeftEdge)(uint16_t time);
+
+
+// ---------- Get16 ----------
+static uint32_t Get16(const uint8_t* src){
+    return src[0] | ((uint32_t)src[1] << 8);
+}
+
+
+// ---------- Replay_Fail ----------
+static void Replay_Fail(void){
+    longjmp(ReplayExit, REPLAY_FAILED + 1);
+}
+
+
+// ---------- Replay_Edges ----------
+// Feeds the tachometer records at the current position to Tachometer.c. The edges
+// are spread evenly over the recorded time; the program only ever sees the totals.
+static void Replay_Edges(void){
+    uint32_t side, forward, backward, ticks, edges, i;
+    uint16_t interval;
+
+    while(Pos + JOURNAL_TACH_BYTES <= Length && (Data[Pos] & JOURNAL_TYPE_MASK) == JOURNAL_TACH){
+        side = Data[Pos] & 0x01;
+        forward = Data[Pos + 1];
+        backward = Data[Pos + 2];
+        ticks = Data[Pos + 3] | ((uint32_t)Data[Pos + 4] << 8) | ((uint32_t)Data[Pos + 5] << 16);
+        edges = forward + backward;
+        Pos += JOURNAL_TACH_BYTES;
+
+        for(i = 0; i < edges; i++){
+            interval = ticks / edges + (i < ticks % edges);
+            Capture[side] += interval;
+            if(side == JOURNAL_RIGHT){
+                HostPort5.IN = (i < forward) ? 0x01 : 0x00;
+                RightEdge(Capture[side]);
+            } else {
+                HostPort5.IN = (i < forward) ? 0x04 : 0x00;
+                LeftEdge(Capture[side]);
+            }
+        }
+    }
+}
+
+
+// ---------- Replay_Expect ----------
+// Moves to the next record the program should produce or consume
+// Inputs: uint32_t type - JOURNAL_ADC, JOURNAL_READ or JOURNAL_MOTOR
+//         uint32_t bytes - size of the record
+//         const char* what - what the program is doing, for the failure message
+// Output: const uint8_t* - the record
+static const uint8_t* Replay_Expect(uint32_t type, uint32_t bytes, const char* what){
+    const uint8_t* record;
+
+    Replay_Edges();
+    if(Pos >= Length){
+        // Everything recorded has been replayed
+        longjmp(ReplayExit, REPLAY_PASSED + 1);
+    }
+    if((Data[Pos] & JOURNAL_TYPE_MASK) != type || Pos + bytes > Length){
+        snprintf(Failure, sizeof(Failure), "byte %u: program %s, journal has record type 0x%02X",
+                 Pos, what, Data[Pos] & JOURNAL_TYPE_MASK);
+        Replay_Fail();
+    }
+
+    record = &Data[Pos];
+    Pos += bytes;
+    IdleMs = 0;
+    return record;
+}
+
+
+// ---------- Replay_Motor ----------
+// Checks a motor command against the journal
+static void Replay_Motor(uint32_t command, uint16_t leftDuty, uint16_t rightDuty){
+    const uint8_t* record = Replay_Expect(JOURNAL_MOTOR, JOURNAL_MOTOR_BYTES, "commanded the motors");
+    uint32_t recorded = record[0] & 0x0F;
+
+    if(recorded != command || Get16(&record[3]) != leftDuty || Get16(&record[5]) != rightDuty){
+        snprintf(Failure, sizeof(Failure), "motor command %u: program Motor_%s(%u, %u), journal Motor_%s(%u, %u)",
+                 Commands, CommandNames[command], leftDuty, rightDuty,
+                 (recorded < 5) ? CommandNames[recorded] : "?", Get16(&record[3]), Get16(&record[5]));
+        Replay_Fail();
+    }
+    Commands++;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////
+// Lab driver interfaces
+///////////////////////////////////////////////////////////////////////////////////////
+
+void Motor_Init(void){}
+void Motor_Stop(void){ Replay_Motor(JOURNAL_MOTOR_STOP, 0, 0); }
+void Motor_Forward(uint16_t leftDuty, uint16_t rightDuty){ Replay_Motor(JOURNAL_MOTOR_FORWARD, leftDuty, rightDuty); }
+void Motor_Right(uint16_t leftDuty, uint16_t rightDuty){ Replay_Motor(JOURNAL_MOTOR_RIGHT, leftDuty, rightDuty); }
+void Motor_Left(uint16_t leftDuty, uint16_t rightDuty){ Replay_Motor(JOURNAL_MOTOR_LEFT, leftDuty, rightDuty); }
+void Motor_Backward(uint16_t leftDuty, uint16_t rightDuty){ Replay_Motor(JOURNAL_MOTOR_BACKWARD, leftDuty, rightDuty); }
+
+void TimerA3Capture_Init01(void(*task0)(uint16_t time), void(*task1)(uint16_t time)){
+    RightEdge = task0;
+    LeftEdge = task1;
+}
+
+void ADC0_InitSWTriggerCh17_14_16(void){}
+
+void ADC_In17_14_16(uint32_t *ch17, uint32_t *ch14, uint32_t *ch16){
+    const uint8_t* record = Replay_Expect(JOURNAL_ADC, JOURNAL_ADC_BYTES, "read the distance sensors");
+
+    *ch17 = Get16(&record[3]);
+    *ch14 = Get16(&record[5]);
+    *ch16 = Get16(&record[7]);
+}
+
+void Clock_Init48MHz(void){}
+uint32_t Clock_GetFreq(void){ return 48000000; }
+
+void Clock_Delay1ms(uint32_t n){
+    DelayMs += n;
+    IdleMs += n;
+    if(IdleMs >= IDLE_LIMIT_MS){
+        // The program has stopped for good (Pause or finished)
+        Replay_Edges();
+        if(Pos < Length){
+            snprintf(Failure, sizeof(Failure), "program stopped with %u bytes of the journal left", Length - Pos);
+            Replay_Fail();
+        }
+        longjmp(ReplayExit, REPLAY_PASSED + 1);
+    }
+}
+
+void Clock_Delay1us(uint32_t n){
+    Clock_Delay1ms(n / 1000);
+}
+
+void MvtLED_Init(void){}
+void Front_Lights_ON(void){}
+void Front_Lights_OFF(void){}
+void Back_Lights_ON(void){}
+void Back_Lights_OFF(void){}
+void Lights_Init(void){}
+void Lights_SetPattern(uint32_t pattern){ (void)pattern; }
+void Lights_SetBrightness(uint8_t level){ (void)level; }
+
+// The lab's Journal.c is not linked: recording is replaced by the checks above
+void Journal_Init(uint32_t mode){ (void)mode; }
+void Journal_TachEdge(uint32_t side, uint16_t interval, uint32_t forward){ (void)side; (void)interval; (void)forward; }
+
+uint32_t Journal_TachReadStart(void){
+    const uint8_t* record;
+
+    if(ReadRepeats > 0){
+        ReadRepeats--;
+    } else {
+        record = Replay_Expect(JOURNAL_READ, 1, "read the tachometers");
+        ReadRepeats = record[0] & 0x0F;
+    }
+    Reads++;
+    IdleMs = 0;
+    return 0;
+}
+
+void Journal_TachReadEnd(uint32_t primask){ (void)primask; }
+
+
+// ---------- NowNs ----------
+static uint64_t NowNs(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+
+// ---------- Replay_File ----------
+// Replays one journal file
+// Output: int - REPLAY_PASSED or REPLAY_FAILED
+static int Replay_File(const char* path){
+    static uint8_t* buffer;
+    JournalLog header;
+    FILE* file;
+    long size;
+    uint64_t t0;
+    int result;
+
+    file = fopen(path, "rb");
+    if(file == 0){
+        perror(path);
+        return REPLAY_FAILED;
+    }
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    free(buffer);
+    buffer = malloc(size > 0 ? size : 1);
+    if(buffer == 0 || size < JOURNAL_HEADER_BYTES || fread(buffer, 1, size, file) != (size_t)size){
+        fclose(file);
+        printf("%-32s not a journal\n", path);
+        return REPLAY_FAILED;
+    }
+    fclose(file);
+
+    memcpy(&header, buffer, JOURNAL_HEADER_BYTES);
+    if(header.magic != JOURNAL_MAGIC || header.version != JOURNAL_VERSION || header.mode > NAV_BUG
+       || header.length > (uint32_t)size - JOURNAL_HEADER_BYTES){
+        printf("%-32s not a journal\n", path);
+        return REPLAY_FAILED;
+    }
+
+    // Start from the same state as the robot at reset
+    Data = buffer + JOURNAL_HEADER_BYTES;
+    Length = header.length;
+    Pos = 0;
+    ReadRepeats = 0;
+    Capture[0] = 0;
+    Capture[1] = 0;
+    Commands = 0;
+    Reads = 0;
+    IdleMs = 0;
+    DelayMs = 0;
+    Failure[0] = '\0';
+    Tachometer_FirstRightTime = Tachometer_SecondRightTime = 0;
+    Tachometer_FirstLeftTime = Tachometer_SecondLeftTime = 0;
+    timeAccumulatorLeft = timeAccumulatorRight = 0;
+    Tachometer_RightSteps = Tachometer_LeftSteps = 0;
+
+    t0 = NowNs();
+    result = setjmp(ReplayExit);
+    if(result == 0){
+        Programs[header.mode]();
+        // main never returns on the robot
+        snprintf(Failure, sizeof(Failure), "program returned from main");
+        result = REPLAY_FAILED + 1;
+    }
+    result--;
+
+    printf("%-32s %-13s %-6s %8u %8u %9u %9.1f %9.2f%s\n", path, ModeNames[header.mode],
+           (result == REPLAY_PASSED) ? "pass" : "FAIL", Length, Reads, Commands,
+           (DelayMs - IdleMs) / 1000.0, (NowNs() - t0) / 1e6, header.full ? "  (journal full)" : "");
+    if(result != REPLAY_PASSED){
+        printf("    %s\n", Failure);
+    }
+    return result;
+}
+
+
+int main(int argc, char** argv){
+    int i, failed = 0;
+
+    if(argc < 2){
+        printf("Usage: %s <journal.jrn> ...\n", argv[0]);
+        return 2;
+    }
+
+    printf("%-32s %-13s %-6s %8s %8s %9s %9s %9s\n", "journal", "mode", "result", "bytes", "reads", "commands", "run_s", "host_ms");
+    for(i = 1; i < argc; i++){
+        if(Replay_File(argv[i]) != REPLAY_PASSED){
+            failed++;
+        }
+    }
+    printf("%d of %d journals replayed with the same motor commands\n", argc - 1 - failed, argc - 1);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,137 @@
+// RingTest.c
+// Runs on a Linux/macOS host
+// Checks the single-producer, single-consumer ring of Lab08/Ring.h with the two
+// sides on two threads, the producer standing in for an interrupt handler. Every
+// item carries a sequence number and a check word across all of its bytes, so an
+// item that is torn, repeated, out of order or lost without being counted as
+// dropped fails the run. The producer either waits for room (every item must
+// arrive and none is dropped) or never waits, like an interrupt (every missing
+// item must be counted as dropped), and puts items in bursts so the ring keeps
+// filling and emptying. Both sides yield while they wait, so the test also runs
+// on a single core.
+//
+// Build (from the repository root):
+//   gcc -O2 -std=gnu11 -pthread -I Lab08 -o Host/bin/RingTest Host/RingTest.c
+//
+// "Host/bin/RingTest [items]" exits with status 1 if any check fails.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include "Ring.h"
+
+#define RING_SIZE     64        /* Items the ring under test holds                    */
+#define DEFAULT_ITEMS 2000000   /* Items put per run                                  */
+#define BURST_MASK    0x3FF     /* Items in a burst are 1 to BURST_MASK + 1           */
+
+// Payload of several words, so a torn copy shows up
+typedef struct TestItem{
+    uint32_t sequence;
+    uint32_t data[2];
+    uint32_t check;
+} TestItem;
+
+RING_DEFINE(TestRing, TestItem, RING_SIZE)
+
+static TestRing Ring;
+static volatile uint32_t ProducerDone;
+static uint32_t Items;
+static uint32_t Wait;   // 1 if the producer waits for room
+
+
+// ---------- Check ----------
+static uint32_t Check(const TestItem* item){
+    return (item->sequence * 2654435761u) ^ item->data[0] ^ (item->data[1] << 7);
+}
+
+
+// ---------- Producer ----------
+// Stands in for the interrupt handler: puts Items items in bursts
+static void* Producer(void* arg){
+    TestItem item;
+    uint32_t i = 0, burst, seed = 443;
+
+    (void)arg;
+    while(i < Items){
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        burst = 1 + (seed & BURST_MASK);
+        while(burst-- && (i < Items)){
+            item.sequence = i;
+            item.data[0] = seed + i;
+            item.data[1] = ~i;
+            item.check = Check(&item);
+            while(Wait && (TestRing_Count(&Ring) >= RING_SIZE)){
+                sched_yield();
+            }
+            TestRing_Put(&Ring, &item);
+            i++;
+        }
+        sched_yield();   // Time between bursts of interrupts
+    }
+    __atomic_store_n(&ProducerDone, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+
+// ---------- Run ----------
+// Output: int - number of failed checks
+static int Run(const char* name){
+    pthread_t thread;
+    TestItem item;
+    uint32_t received = 0, skipped = 0, errors = 0, next = 0;
+    struct timespec start, end;
+    double seconds;
+
+    TestRing_Init(&Ring);
+    ProducerDone = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_create(&thread, 0, Producer, 0);
+
+    // Consumer: everything left once the producer is done is still taken
+    while(1){
+        if(TestRing_Get(&Ring, &item)){
+            if((item.check != Check(&item)) || (item.sequence < next)){
+                errors++;
+            } else {
+                skipped += item.sequence - next;
+                next = item.sequence + 1;
+            }
+            received++;
+        } else if(__atomic_load_n(&ProducerDone, __ATOMIC_ACQUIRE) && (TestRing_Count(&Ring) == 0)){
+            break;
+        } else {
+            sched_yield();
+        }
+    }
+    pthread_join(thread, 0);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    skipped += Items - next;
+    if(Wait && ((received != Items) || Ring.dropped)){
+        errors++;
+    }
+    if((received + Ring.dropped != Items) || (skipped != Ring.dropped) || (Ring.highWater > RING_SIZE)){
+        errors++;
+    }
+    printf("%-8s %10u %10u %9u %10u %8.1f %7s\n", name, Items, received, Ring.dropped,
+           Ring.highWater, seconds * 1e9 / Items, errors ? "FAIL" : "ok");
+    return errors;
+}
+
+
+int main(int argc, char** argv){
+    int errors;
+
+    Items = (argc > 1) ? (uint32_t)strtoul(argv[1], 0, 0) : DEFAULT_ITEMS;
+    printf("%-8s %10s %10s %9s %10s %8s %7s\n", "producer", "items", "received", "dropped", "high_water", "ns_item", "result");
+    Wait = 1;
+    errors = Run("waits");
+    Wait = 0;
+    errors += Run("isr");
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,409 @@
+// Sim.c
+// Runs on a Linux/macOS host
+// Robot simulation behind the lab driver interfaces, see Sim.h.
+
+#include <math.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include "msp.h"
+#include "Sim.h"
+#ifdef SIM_JOURNAL
+#include "Journal.h"
+#endif
+
+#define SIM_PI         3.14159265f
+#define SIM_TRACK_MM   140.0f   /* Distance between the wheels (mm)     */
+#define SIM_WHEEL_MM   70.0f    /* Diameter of the wheels (mm)          */
+#define SIM_STEPS_REV  360      /* Tachometer steps per wheel revolution */
+#define SIM_DUTY_PER_RPM 60.0f /* Duty cycle per wheel RPM (RPM_TO_DUTY_EST in Precision_Moves.h) */
+#define SIM_SIDE_ANGLE 45.0f    /* Angle of the side distance sensors from the center one (degrees) */
+#define SIM_STEP_MM    (SIM_PI * SIM_WHEEL_MM / SIM_STEPS_REV)
+#define SIM_TICKS_PER_MS (SIM_TACH_HZ / 1000)
+
+#define SIM_LOCAL static _Thread_local
+
+// Registers written by the lab sources
+HostRegisters HostWatchdog;
+HostRegisters HostPort5;
+HostTimer HostTimerA3;
+
+// One wheel: commanded and actual speed, distance and tachometer state
+typedef struct SimWheel{
+    float command;        // Commanded speed (mm/s)
+    float speed;          // Actual speed (mm/s)
+    float travel;         // Distance travelled (mm)
+    int32_t steps;        // Tachometer steps
+    uint32_t time;        // Tachometer time accumulator (12 MHz ticks)
+    uint64_t lastEdge;    // Time of the last tachometer edge (12 MHz ticks)
+} SimWheel;
+
+SIM_LOCAL const SimArena* Arena;
+SIM_LOCAL float RobotX, RobotY, RobotHeading; // mm, mm, radians
+SIM_LOCAL SimWheel LeftWheel, RightWheel;
+SIM_LOCAL uint64_t Ticks;                     // Simulated time (12 MHz ticks)
+SIM_LOCAL uint32_t TimeMs, MicrosecondCarry;
+SIM_LOCAL uint32_t StoppedSinceMs, TimeLimitMs, CollisionMs;
+SIM_LOCAL float PathMM;
+SIM_LOCAL uint8_t TimedOut;
+SIM_LOCAL jmp_buf RunExit;
+SIM_LOCAL SimConfig Config;
+SIM_LOCAL uint32_t Random;
+SIM_LOCAL SimMonitor Monitor;
+
+
+// ---------- Sim_Closest ----------
+// Closest point of any wall to a point
+// Output: float - distance to the closest point (mm)
+static float Sim_Closest(float x, float y, float* closestX, float* closestY){
+    float clearance = 1e9f, dx, dy, t, px, py, distance;
+    uint32_t i;
+
+    for(i = 0; i < Arena->numWalls; i++){
+        const SimWall* w = &Arena->walls[i];
+        dx = w->x1 - w->x0;
+        dy = w->y1 - w->y0;
+        t = ((x - w->x0)*dx + (y - w->y0)*dy) / (dx*dx + dy*dy);
+        if(t < 0){t = 0;}
+        if(t > 1){t = 1;}
+        px = w->x0 + t*dx;
+        py = w->y0 + t*dy;
+        distance = sqrtf((px - x)*(px - x) + (py - y)*(py - y));
+        if(distance < clearance){
+            clearance = distance;
+            *closestX = px;
+            *closestY = py;
+        }
+    }
+    return clearance;
+}
+
+
+// ---------- Sim_Move ----------
+// Moves the robot's body, sliding along a wall instead of going through it
+// Output: float - distance moved (mm)
+static float Sim_Move(float dx, float dy){
+    float wallX, wallY, nx, ny, into;
+    float clearance = Sim_Closest(RobotX + dx, RobotY + dy, &wallX, &wallY);
+
+    if(clearance < SIM_ROBOT_RADIUS_MM){
+        // Remove the part of the motion that pushes into the wall
+        nx = (RobotX + dx - wallX) / clearance;
+        ny = (RobotY + dy - wallY) / clearance;
+        into = dx*nx + dy*ny;
+        if(into < 0){
+            dx -= into*nx;
+            dy -= into*ny;
+        }
+        CollisionMs++;
+        if(Sim_Closest(RobotX + dx, RobotY + dy, &wallX, &wallY) < clearance){
+            return 0;
+        }
+    }
+
+    RobotX += dx;
+    RobotY += dy;
+    return sqrtf(dx*dx + dy*dy);
+}
+
+
+// ---------- Sim_Raycast ----------
+// Distance along a ray to the first wall
+// Inputs: float xPos, yPos - origin of the ray (mm)
+//         float angle - direction of the ray (radians)
+//         float maxRange - distance returned if no wall is hit (mm)
+// Output: float - distance to the first wall (mm)
+float Sim_Raycast(float xPos, float yPos, float angle, float maxRange){
+    float dx = cosf(angle), dy = sinf(angle);
+    float best = maxRange;
+    uint32_t i;
+
+    for(i = 0; i < Arena->numWalls; i++){
+        const SimWall* w = &Arena->walls[i];
+        float ex = w->x1 - w->x0, ey = w->y1 - w->y0;
+        float denom = dx*ey - dy*ex;
+        float t, u;
+        if(fabsf(denom) < 1e-6f){
+            continue;
+        }
+        t = ((w->x0 - xPos)*ey - (w->y0 - yPos)*ex) / denom;
+        u = ((w->x0 - xPos)*dy - (w->y0 - yPos)*dx) / denom;
+        if(t >= 0 && u >= 0 && u <= 1 && t < best){
+            best = t;
+        }
+    }
+    return best;
+}
+
+
+// ---------- Sim_Gaussian ----------
+// Normally distributed random number with zero mean and unit standard deviation
+static float Sim_Gaussian(void){
+    float u1, u2;
+    do{
+        Random ^= Random << 13;
+        Random ^= Random >> 17;
+        Random ^= Random << 5;
+        u1 = (float)(Random >> 8) / 16777216.0f;
+    } while(u1 <= 0);
+    Random ^= Random << 13;
+    Random ^= Random >> 17;
+    Random ^= Random << 5;
+    u2 = (float)(Random >> 8) / 16777216.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * SIM_PI * u2);
+}
+
+
+// ---------- Sim_Wheel ----------
+// Advances one wheel by 1 ms and generates its tachometer edges
+// Output: float - distance the wheel moved (mm)
+static float Sim_Wheel(SimWheel* wheel){
+    float before = wheel->travel;
+    int32_t step, target;
+
+    wheel->speed += (wheel->command - wheel->speed) / SIM_WHEEL_TAU_MS;
+    wheel->travel += wheel->speed / 1000.0f;
+
+    // Every step boundary crossed is a tachometer edge, timed within this millisecond
+    target = (int32_t)floorf(wheel->travel / SIM_STEP_MM);
+    while(wheel->steps != target){
+        step = (target > wheel->steps) ? 1 : -1;
+        float boundary = (float)(wheel->steps + (step > 0 ? 1 : 0)) * SIM_STEP_MM;
+        float fraction = (boundary - before) / (wheel->travel - before);
+        uint64_t edge = Ticks + (uint64_t)(fraction * SIM_TICKS_PER_MS);
+        // The input capture timer is 16 bits, so only the low bits of the interval survive
+        wheel->time += (uint16_t)(edge - wheel->lastEdge);
+#ifdef SIM_JOURNAL
+        Journal_TachEdge((wheel == &LeftWheel) ? JOURNAL_LEFT : JOURNAL_RIGHT, (uint16_t)(edge - wheel->lastEdge), step > 0);
+#endif
+        wheel->lastEdge = edge;
+        wheel->steps += step;
+    }
+
+    return wheel->travel - before;
+}
+
+
+// ---------- Sim_StepMs ----------
+// Advances the simulation by 1 ms
+static void Sim_StepMs(void){
+    float left = Sim_Wheel(&LeftWheel) * (1.0f + Config.leftWheelError);
+    float right = Sim_Wheel(&RightWheel) * (1.0f + Config.rightWheelError);
+    float distance = (left + right) / 2.0f;
+    float turn = (right - left) / SIM_TRACK_MM;
+
+    // Against a wall the wheels slip, so the robot only slides along it
+    PathMM += Sim_Move(distance * cosf(RobotHeading + turn / 2.0f), distance * sinf(RobotHeading + turn / 2.0f));
+    RobotHeading += turn;
+
+    Ticks += SIM_TICKS_PER_MS;
+    TimeMs++;
+    HostTimerA3.R = (uint16_t)Ticks;
+    if(Monitor){
+        Monitor();
+    }
+
+    // Stop the program once it has been idle for a while or has run out of time
+    if(LeftWheel.command != 0 || RightWheel.command != 0){
+        StoppedSinceMs = TimeMs;
+    } else if(TimeMs - StoppedSinceMs >= SIM_IDLE_MS){
+        longjmp(RunExit, 1);
+    }
+    if(TimeMs >= TimeLimitMs){
+        TimedOut = 1;
+        longjmp(RunExit, 1);
+    }
+}
+
+
+// ---------- Sim_Reset ----------
+// Places the robot in an arena with the motors stopped and the tachometers cleared
+// Inputs: const SimArena* arena - walls to drive in
+//         float xPos, yPos - position of the robot's center (mm)
+//         float heading - heading of the robot (degrees)
+// Output: none
+void Sim_Reset(const SimArena* arena, float xPos, float yPos, float heading){
+    SimWheel stopped = {0, 0, 0, 0, 0, 0};
+    SimConfig exact = {0, 0, 0, 1};
+    Arena = arena;
+    Config = exact;
+    Random = exact.seed;
+    RobotX = xPos;
+    RobotY = yPos;
+    RobotHeading = heading * SIM_PI / 180.0f;
+    LeftWheel = stopped;
+    RightWheel = stopped;
+    Ticks = 0;
+    TimeMs = 0;
+    MicrosecondCarry = 0;
+    StoppedSinceMs = 0;
+    CollisionMs = 0;
+    PathMM = 0;
+    TimedOut = 0;
+    Monitor = 0;
+}
+
+
+// ---------- Sim_Configure ----------
+// Sets the imperfections of the robot for the next run (call after Sim_Reset)
+// Inputs: const SimConfig* config - wheel errors and sensor noise
+// Output: none
+void Sim_Configure(const SimConfig* config){
+    Config = *config;
+    Random = config->seed ? config->seed : 1;
+}
+
+
+// ---------- Sim_Run ----------
+// Runs a program until its motors have been stopped for SIM_IDLE_MS or the time limit
+// Inputs: SimProgram program - program to run, normally does not return
+//         uint32_t timeLimitMs - simulated time after which the program is stopped (ms)
+// Output: SimResult - mission time, path length and final pose
+SimResult Sim_Run(SimProgram program, uint32_t timeLimitMs){
+    SimResult result;
+
+    TimeLimitMs = timeLimitMs;
+    if(setjmp(RunExit) == 0){
+        program();
+    }
+
+    result.timeMs = TimedOut ? TimeMs : StoppedSinceMs;
+    result.collisionMs = CollisionMs;
+    result.pathMM = PathMM;
+    result.xPos = RobotX;
+    result.yPos = RobotY;
+    result.heading = RobotHeading * 180.0f / SIM_PI;
+    result.timedOut = TimedOut;
+    return result;
+}
+
+
+// ---------- Sim_Stop ----------
+// Ends the current run right away (called by the program)
+void Sim_Stop(void){
+    longjmp(RunExit, 1);
+}
+
+
+// ---------- Sim_SetMonitor ----------
+// Sets a function that is called after every simulated millisecond of the next run
+// (call after Sim_Reset)
+void Sim_SetMonitor(SimMonitor monitor){
+    Monitor = monitor;
+}
+
+
+// ---------- Sim_GetWheels ----------
+// Actual and commanded speed of each wheel (mm/s, negative when turning backward)
+void Sim_GetWheels(float* leftSpeed, float* rightSpeed, float* leftCommand, float* rightCommand){
+    *leftSpeed = LeftWheel.speed;
+    *rightSpeed = RightWheel.speed;
+    *leftCommand = LeftWheel.command;
+    *rightCommand = RightWheel.command;
+}
+
+
+// ---------- Sim_GetPose ----------
+// True pose of the robot (mm, mm, degrees)
+void Sim_GetPose(float* xPos, float* yPos, float* heading){
+    *xPos = RobotX;
+    *yPos = RobotY;
+    *heading = RobotHeading * 180.0f / SIM_PI;
+}
+
+
+// ---------- Sim_GetTimeMs ----------
+// Simulated time since Sim_Reset (ms)
+uint32_t Sim_GetTimeMs(void){
+    return TimeMs;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////
+// Lab driver interfaces
+///////////////////////////////////////////////////////////////////////////////////////
+
+static void Sim_Command(float left, float right){
+    LeftWheel.command = left * SIM_LEFT_GAIN * SIM_PI * SIM_WHEEL_MM / (60.0f * SIM_DUTY_PER_RPM);
+    RightWheel.command = right * SIM_PI * SIM_WHEEL_MM / (60.0f * SIM_DUTY_PER_RPM);
+}
+
+#ifdef SIM_JOURNAL
+// The drivers record into the journal exactly where the lab's Motor, Tachometer and
+// ADC14 drivers do, so a simulated run can be replayed like a recorded one
+#define SIM_JOURNAL_MOTOR(command, left, right) Journal_Motor(command, left, right)
+#else
+#define SIM_JOURNAL_MOTOR(command, left, right)
+#endif
+
+void Motor_Init(void){ Sim_Command(0, 0); }
+void Motor_Stop(void){ SIM_JOURNAL_MOTOR(JOURNAL_MOTOR_STOP, 0, 0); Sim_Command(0, 0); }
+void Motor_Forward(uint16_t leftDuty, uint16_t rightDuty){ SIM_JOURNAL_MOTOR(JOURNAL_MOTOR_FORWARD, leftDuty, rightDuty); Sim_Command(leftDuty, rightDuty); }
+void Motor_Right(uint16_t leftDuty, uint16_t rightDuty){ SIM_JOURNAL_MOTOR(JOURNAL_MOTOR_RIGHT, leftDuty, rightDuty); Sim_Command(leftDuty, -(float)rightDuty); }
+void Motor_Left(uint16_t leftDuty, uint16_t rightDuty){ SIM_JOURNAL_MOTOR(JOURNAL_MOTOR_LEFT, leftDuty, rightDuty); Sim_Command(-(float)leftDuty, rightDuty); }
+void Motor_Backward(uint16_t leftDuty, uint16_t rightDuty){ SIM_JOURNAL_MOTOR(JOURNAL_MOTOR_BACKWARD, leftDuty, rightDuty); Sim_Command(-(float)leftDuty, -(float)rightDuty); }
+
+void Tachometer_Init(void){}
+
+void Tachometer_Get_Steps(int32_t *leftSteps, int32_t *rightSteps){
+#ifdef SIM_JOURNAL
+    Journal_TachReadEnd(Journal_TachReadStart());
+#endif
+    *leftSteps = LeftWheel.steps;
+    *rightSteps = RightWheel.steps;
+}
+
+void Tachometer_Get_SpaceTime(int32_t *leftSteps, int32_t *rightSteps, uint32_t *leftTime, uint32_t *rightTime){
+    Tachometer_Get_Steps(leftSteps, rightSteps);
+    *leftTime = LeftWheel.time;
+    *rightTime = RightWheel.time;
+}
+
+// Inverse of Distance_ComputeDistance: ADC reading that the sensor gives at a distance
+static uint32_t Sim_DistanceToADC(float angle, float scale, float exponent){
+    float x = RobotX + SIM_SENSOR_OFFSET_MM * cosf(RobotHeading);
+    float y = RobotY + SIM_SENSOR_OFFSET_MM * sinf(RobotHeading);
+    float distance = Sim_Raycast(x, y, RobotHeading + angle * SIM_PI / 180.0f, SIM_MAX_RANGE_MM);
+    distance += Config.rangeNoise * distance * Sim_Gaussian();
+    if(distance < SIM_MIN_RANGE_MM){distance = SIM_MIN_RANGE_MM;}
+    return (uint32_t)powf(scale / distance, 1.0f / exponent);
+}
+
+void ADC0_InitSWTriggerCh17_14_16(void){}
+
+// Channel 17 feeds the formula Distance.c uses for the robot's right sensor and
+// channel 16 the left one (Distance_ComputeDistances swaps them back)
+void ADC_In17_14_16(uint32_t *ch17, uint32_t *ch14, uint32_t *ch16){
+    *ch17 = Sim_DistanceToADC(-SIM_SIDE_ANGLE, 3.0e6f, 1.110f);
+    *ch14 = Sim_DistanceToADC(0, 6.0e6f, 1.182f);
+    *ch16 = Sim_DistanceToADC(SIM_SIDE_ANGLE, 3.0e6f, 1.116f);
+#ifdef SIM_JOURNAL
+    Journal_ADC(*ch17, *ch14, *ch16);
+#endif
+}
+
+void Clock_Init48MHz(void){}
+uint32_t Clock_GetFreq(void){ return 48000000; }
+
+void Clock_Delay1ms(uint32_t n){
+    while(n > 0){
+        Sim_StepMs();
+        n--;
+    }
+}
+
+void Clock_Delay1us(uint32_t n){
+    MicrosecondCarry += n;
+    while(MicrosecondCarry >= 1000){
+        MicrosecondCarry -= 1000;
+        Sim_StepMs();
+    }
+}
+
+void MvtLED_Init(void){}
+void Front_Lights_ON(void){}
+void Front_Lights_OFF(void){}
+void Back_Lights_ON(void){}
+void Back_Lights_OFF(void){}
+void Lights_Init(void){}
+void Lights_SetPattern(uint32_t pattern){ (void)pattern; }
+void Lights_SetBrightness(uint8_t level){ (void)level; }
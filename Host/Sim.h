@@ -0,0 +1,78 @@
+#ifndef SIM_H
+#define SIM_H
+
+// Sim.h
+// Runs on a Linux/macOS host
+// Differential drive simulation of the TI-RSLK MAX robot in an arena of wall segments.
+// Sim.c provides the Motor, Tachometer, ADC14, Clock, RobotLights and Lights functions,
+// so the lab's own navigation code (main.c, Odometry.c, Precision_Moves.c, Distance.c, ...)
+// runs unmodified on the host. Simulated time only advances inside Clock_Delay1ms and
+// Clock_Delay1us, exactly where the robot would be waiting.
+//
+// All simulation state is thread local, so independent runs can share a process.
+
+#include <stdint.h>
+
+
+// --------------------- Definitions ---------------------
+
+#define SIM_ROBOT_RADIUS_MM   75     /* Radius of the robot's body (mm)                            */
+#define SIM_SENSOR_OFFSET_MM  60     /* Distance of the distance sensors in front of the center (mm) */
+#define SIM_MIN_RANGE_MM      70     /* Shortest distance the distance sensors report (mm)         */
+#define SIM_MAX_RANGE_MM      800    /* Longest distance the distance sensors report (mm)          */
+#define SIM_WHEEL_TAU_MS      50     /* Time constant of the wheel speed response (ms)             */
+#define SIM_LEFT_GAIN         0.98f  /* Left motor speed relative to the right (motor mismatch)    */
+#define SIM_IDLE_MS           2000   /* Time with the motors stopped that ends a run (ms)          */
+#define SIM_TACH_HZ           12000000 /* Clock of the tachometer input capture timer (Hz)        */
+
+
+// Straight wall from (x0, y0) to (x1, y1) in mm
+typedef struct SimWall{
+    float x0, y0;
+    float x1, y1;
+} SimWall;
+
+// Set of walls the robot drives in
+typedef struct SimArena{
+    const char* name;
+    const SimWall* walls;
+    uint32_t numWalls;
+} SimArena;
+
+// Imperfections of the simulated robot (all zero after Sim_Reset)
+typedef struct SimConfig{
+    float leftWheelError;   // Fraction the left wheel drives further than its tachometer says
+    float rightWheelError;  // Fraction the right wheel drives further than its tachometer says
+    float rangeNoise;       // Standard deviation of the distance sensor noise, fraction of the distance
+    uint32_t seed;          // Seed for the sensor noise
+} SimConfig;
+
+// Outcome of a run
+typedef struct SimResult{
+    uint32_t timeMs;       // Time at which the motors last stopped (mission time, ms)
+    uint32_t collisionMs;  // Time spent pushing against a wall (ms)
+    float pathMM;          // Distance driven by the robot's center (mm)
+    float xPos, yPos;      // True final position (mm)
+    float heading;         // True final heading (degrees)
+    uint8_t timedOut;      // 1 if the run was stopped by the time limit
+} SimResult;
+
+// Program that is run by the simulation (normally a lab's main)
+typedef void (*SimProgram)(void);
+
+// Function called after every simulated millisecond, to record what the robot does
+typedef void (*SimMonitor)(void);
+
+
+// --------------------- Function Prototypes ---------------------
+void Sim_Reset(const SimArena* arena, float xPos, float yPos, float heading);
+void Sim_Configure(const SimConfig* config);
+SimResult Sim_Run(SimProgram program, uint32_t timeLimitMs);
+void Sim_Stop(void);
+void Sim_SetMonitor(SimMonitor monitor);
+void Sim_GetWheels(float* leftSpeed, float* rightSpeed, float* leftCommand, float* rightCommand);
+float Sim_Raycast(float xPos, float yPos, float angle, float maxRange);
+void Sim_GetPose(float* xPos, float* yPos, float* heading);
+uint32_t Sim_GetTimeMs(void);
+
+#endif
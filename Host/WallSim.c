@@ -0,0 +1,214 @@
+// WallSim.c
+// Runs on a Linux/macOS host
+// Compares the Lab07 wall followers (three fixed turns with stops and spins at the
+// corners, and PD steering on the distance from the wall with arcs at the corners)
+// in simulated arenas. The Lab07 main program is compiled once per FOLLOW_MODE and
+// run unmodified on top of Host/Sim.c; the bump switches never close (pushing on a
+// wall is counted as contact instead). Each follower drives LAPS laps with the wall
+// on its left, without and with noise on the distance sensors. Lap time is the
+// mean over the laps. The oscillation is measured on the straights, away from the
+// corners: the standard deviation and the swing (largest minus smallest) of the
+// distance from the robot's center to the wall, sampled every simulated ms.
+//
+// Build (from the repository root):
+//   gcc -O2 -std=gnu11 -I Host -I Lab07 -o Host/bin/WallSim Host/WallSim.c Host/Sim.c
+//       Lab07/Wall.c Lab07/Maneuver.c -lm
+
+#include <stdio.h>
+#include <math.h>
+#include "Sim.h"
+
+// Lab07's main program, once for each wall follower
+#define FOLLOW_MODE 0
+#define main  Lab07_MainFsm
+#define computeDistances Lab07_ComputeDistancesFsm
+#define computeDistance Lab07_ComputeDistanceFsm
+#define Avoid Lab07_AvoidFsm
+#include "main.c"
+#undef FOLLOW_MODE
+#undef main
+#undef computeDistances
+#undef computeDistance
+#undef Avoid
+
+#define FOLLOW_MODE 1
+#define main  Lab07_MainPd
+#define computeDistances Lab07_ComputeDistancesPd
+#define computeDistance Lab07_ComputeDistancePd
+#define Avoid Lab07_AvoidPd
+#include "main.c"
+#undef FOLLOW_MODE
+#undef main
+#undef computeDistances
+#undef computeDistance
+#undef Avoid
+
+
+#define TIME_LIMIT_MS     300000  /* Simulated time before a run is declared stuck (ms)              */
+#define LAPS              3       /* Laps driven by each follower                                   */
+#define START_WALL_MM     130     /* Distance of the robot's center from the wall at the start (mm) */
+#define CORNER_MARGIN_MM  350     /* Samples closer than this to the end of a wall are corners (mm) */
+#define LOST_MM           600     /* Farther than this from every wall the robot has left it (mm)   */
+#define NOISE             0.03f   /* Distance sensor noise of the noisy runs (fraction)              */
+#define PI_F              3.14159265f
+
+
+// Inside corners only
+static const SimWall RoomWalls[] = {
+    {0, 0, 2000, 0}, {2000, 0, 2000, 1400}, {2000, 1400, 0, 1400}, {0, 1400, 0, 0}
+};
+
+// Outside corners only: around a 1.2 m by 0.6 m block in a larger room
+static const SimWall BlockWalls[] = {
+    {600, 600, 1800, 600}, {1800, 600, 1800, 1200}, {1800, 1200, 600, 1200}, {600, 1200, 600, 600},
+    {0, 0, 2400, 0}, {2400, 0, 2400, 1800}, {2400, 1800, 0, 1800}, {0, 1800, 0, 0}
+};
+
+// Five inside corners and one outside corner
+static const SimWall LWalls[] = {
+    {0, 0, 2000, 0}, {2000, 0, 2000, 800}, {2000, 800, 1000, 800},
+    {1000, 800, 1000, 1600}, {1000, 1600, 0, 1600}, {0, 1600, 0, 0}
+};
+
+// Arena, the starting pose with the wall on the left, and a point every part of
+// the path can be seen from, that laps are counted around
+typedef struct Course{
+    SimArena arena;
+    float xPos, yPos, heading;
+    float centerX, centerY;
+} Course;
+
+static const Course Courses[] = {
+    {{"room",  RoomWalls,  sizeof(RoomWalls) / sizeof(RoomWalls[0])},   300, 1400 - START_WALL_MM, 0, 1000, 700},
+    {{"block", BlockWalls, sizeof(BlockWalls) / sizeof(BlockWalls[0])}, 800, 600 - START_WALL_MM,  0, 1200, 900},
+    {{"L",     LWalls,     sizeof(LWalls) / sizeof(LWalls[0])},         200, 1600 - START_WALL_MM, 0, 500,  400}
+};
+
+typedef struct Mode{
+    const char* name;
+    SimProgram program;
+} Mode;
+
+static const Mode Modes[] = {
+    {"fsm", Lab07_MainFsm},
+    {"pd",  Lab07_MainPd}
+};
+
+// Progress and oscillation of the run
+static const Course* Current;
+static float LastAngle;
+static float Turned;               // Angle turned around the course's center (radians)
+static uint32_t LapMs[LAPS];
+static uint32_t Laps;
+static double Sum, SquaredSum;
+static float MinWall, MaxWall;
+static uint32_t Samples;
+static uint8_t Lost;
+
+
+// ---------- Wall_Nearest ----------
+// Distance from a point to the nearest wall, and how far the nearest point on
+// that wall is from the closer of its ends
+static float Wall_Nearest(float x, float y, float* fromEnd){
+    const SimWall* w;
+    float dx, dy, length, t, distance, best = 1e9f;
+    uint32_t i;
+
+    *fromEnd = 0;
+    for(i = 0; i < Current->arena.numWalls; i++){
+        w = &Current->arena.walls[i];
+        dx = w->x1 - w->x0;
+        dy = w->y1 - w->y0;
+        length = hypotf(dx, dy);
+        t = ((x - w->x0) * dx + (y - w->y0) * dy) / (length * length);
+        if(t < 0){t = 0;}
+        if(t > 1){t = 1;}
+        distance = hypotf(w->x0 + t * dx - x, w->y0 + t * dy - y);
+        if(distance < best){
+            best = distance;
+            *fromEnd = length * ((t < 0.5f) ? t : 1 - t);
+        }
+    }
+    return best;
+}
+
+
+// ---------- Monitor ----------
+// Counts the laps and measures the distance from the wall on the straights
+static void Monitor(void){
+    float x, y, heading, angle, step, wall, fromEnd;
+
+    Sim_GetPose(&x, &y, &heading);
+    angle = atan2f(y - Current->centerY, x - Current->centerX);
+    step = angle - LastAngle;
+    if(step > PI_F){step -= 2 * PI_F;}
+    if(step < -PI_F){step += 2 * PI_F;}
+    Turned += step;
+    LastAngle = angle;
+    if(fabsf(Turned) >= 2 * PI_F * (Laps + 1)){
+        LapMs[Laps++] = Sim_GetTimeMs();
+        if(Laps == LAPS){
+            Sim_Stop();
+        }
+    }
+
+    wall = Wall_Nearest(x, y, &fromEnd);
+    if(wall > LOST_MM){
+        Lost = 1;
+        Sim_Stop();
+    }
+    if(fromEnd >= CORNER_MARGIN_MM){
+        Sum += wall;
+        SquaredSum += (double)wall * wall;
+        if(wall < MinWall){MinWall = wall;}
+        if(wall > MaxWall){MaxWall = wall;}
+        Samples++;
+    }
+}
+
+
+// Bump switches that never close, and BumpInt's time for Maneuver.c
+void BumpInt_Init(void){}
+uint32_t BumpInt_GetEvent(BumpEvent *event){ (void)event; return 0; }
+uint32_t BumpInt_Now(void){ return Sim_GetTimeMs(); }
+uint8_t BumpInt_Read(void){ return 0; }
+
+
+int main(void){
+    SimConfig config = {0, 0, 0, 443};
+    SimResult result;
+    uint32_t c, m, n;
+    double mean;
+
+    printf("%-6s %-4s %5s %-9s %4s %7s %7s %7s %8s %8s %10s\n", "arena", "mode", "noise", "result", "laps", "lap_s",
+           "mean_mm", "osc_mm", "swing_mm", "min_mm", "contact_ms");
+    for(c = 0; c < sizeof(Courses) / sizeof(Courses[0]); c++){
+        for(n = 0; n < 2; n++){
+            for(m = 0; m < sizeof(Modes) / sizeof(Modes[0]); m++){
+                Current = &Courses[c];
+                Sim_Reset(&Current->arena, Current->xPos, Current->yPos, Current->heading);
+                config.rangeNoise = n ? NOISE : 0;
+                Sim_Configure(&config);
+                Sim_SetMonitor(Monitor);
+                LastAngle = atan2f(Current->yPos - Current->centerY, Current->xPos - Current->centerX);
+                Turned = 0;
+                Laps = 0;
+                Sum = 0;
+                SquaredSum = 0;
+                MinWall = 1e9f;
+                MaxWall = 0;
+                Samples = 0;
+                Lost = 0;
+                result = Sim_Run(Modes[m].program, TIME_LIMIT_MS);
+
+                mean = Samples ? Sum / Samples : 0;
+                printf("%-6s %-4s %5.2f %-9s %4u %7.2f %7.1f %7.1f %8.1f %8.1f %10u\n", Current->arena.name,
+                       Modes[m].name, config.rangeNoise, Lost ? "lost" : (Laps == LAPS ? "completed" : "stopped"),
+                       Laps, Laps ? LapMs[Laps - 1] / 1000.0f / Laps : 0.0f, mean,
+                       Samples ? sqrt(SquaredSum / Samples - mean * mean) : 0.0,
+                       Samples ? MaxWall - MinWall : 0.0f, Samples ? MinWall : 0.0f, result.collisionMs);
+            }
+        }
+    }
+    return 0;
+}
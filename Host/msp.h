@@ -0,0 +1,69 @@
+#ifndef HOST_MSP_H
+#define HOST_MSP_H
+
+// msp.h
+// Runs on a Linux/macOS host
+// Stands in for the TI device header when lab sources are compiled for the host
+// simulation. Only the registers touched by the lab files that the host tools
+// compile directly are provided; the drivers underneath them (Motor, Tachometer,
+// ADC14, Clock, RobotLights) are replaced by Host/Sim.c or Host/Replay.c.
+
+#include <stdint.h>
+
+
+// Register block shared by the peripherals used by the lab sources
+typedef struct HostRegisters{
+    volatile uint32_t CTL;
+    volatile uint32_t IN;
+    volatile uint32_t OUT;
+    volatile uint32_t DIR;
+    volatile uint32_t SEL0;
+    volatile uint32_t SEL1;
+} HostRegisters;
+
+// Timer with a free running count
+typedef struct HostTimer{
+    volatile uint32_t CTL;
+    volatile uint32_t R;
+} HostTimer;
+
+// eUSCI in UART mode
+typedef struct HostUart{
+    volatile uint32_t CTLW0;
+    volatile uint32_t BRW;
+    volatile uint32_t MCTLW;
+    volatile uint32_t IE;
+    volatile uint32_t IFG;
+    volatile uint32_t RXBUF;
+    volatile uint32_t TXBUF;
+} HostUart;
+
+// Interrupt controller registers written by the drivers
+typedef struct HostInterrupts{
+    volatile uint32_t IP[16];
+    volatile uint32_t ISER[2];
+} HostInterrupts;
+
+extern HostRegisters HostWatchdog;
+extern HostRegisters HostPort3;
+extern HostRegisters HostPort5;
+extern HostTimer HostTimerA3;
+extern HostUart HostUartA2;
+extern HostInterrupts HostNvic;
+
+#define WDT_A           (&HostWatchdog)
+#define WDT_A_CTL_PW    0x5A00
+#define WDT_A_CTL_HOLD  0x0080
+
+#define P3              (&HostPort3)
+#define P5              (&HostPort5)
+#define TIMER_A3        (&HostTimerA3)
+#define EUSCI_A2        (&HostUartA2)
+#define NVIC            (&HostNvic)
+
+// There are no interrupts on the host, so critical sections are empty
+static inline uint32_t __get_PRIMASK(void){ return 0; }
+static inline void __disable_irq(void){}
+static inline void __set_PRIMASK(uint32_t primask){ (void)primask; }
+
+#endif
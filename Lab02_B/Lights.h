@@ -0,0 +1,65 @@
+#ifndef LIGHTS_H
+#define LIGHTS_H
+
+#include <stdint.h>
+
+/*
+ * Light patterns played from the Timer32 2 interrupt on the chassis LEDs and the
+ * BGR LED of RobotLights.c (front P8.0 and P8.5, rear P8.6 and P8.7, BGR P2.2-0).
+ *
+ * A pattern is a list of steps in flash, each with a brightness for the front
+ * lights, the rear lights and the BGR LED, and how long it lasts. The interrupt
+ * runs at LIGHTS_TICK_HZ, dims the LEDs with software PWM over LIGHTS_LEVELS
+ * ticks and moves through the steps, starting over after the last one. The main
+ * program picks a pattern with Lights_SetPattern, which returns right away, so
+ * no Clock_Delay1ms is needed to blink the lights.
+ *
+ * LIGHTS_NONE leaves the LEDs to Front_Lights_ON/OFF and Back_Lights_ON/OFF.
+ * Timer32 2 counts MCLK, so Clock_Init48MHz must run before Lights_Init.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#define LIGHTS_TICK_HZ       2000   /* Software PWM interrupts per second                     */
+#define LIGHTS_LEVELS        16     /* Ticks in a PWM period, so it runs at 125 Hz (power of 2) */
+#define LIGHTS_FULL          LIGHTS_LEVELS  /* Brightness of an LED that is always on      */
+#define LIGHTS_TICKS_PER_MS  (LIGHTS_TICK_HZ / 1000)
+
+// Colors of the BGR LED (P2.2-0)
+#define LIGHTS_RED     0x01   /* P2.0 */
+#define LIGHTS_GREEN   0x02   /* P2.1 */
+#define LIGHTS_BLUE    0x04   /* P2.2 */
+#define LIGHTS_YELLOW  0x03   /* Red and green */
+#define LIGHTS_WHITE   0x07   /* All three     */
+
+// Patterns
+#define LIGHTS_NONE           0   /* No pattern, the RobotLights functions drive the LEDs     */
+#define LIGHTS_OFF            1   /* All off                                                  */
+#define LIGHTS_ON             2   /* Front lights and white BGR on, as Front_Lights_ON        */
+#define LIGHTS_BLINK_SLOW     3   /* Front lights and white BGR blink at 1 Hz                 */
+#define LIGHTS_BLINK_FAST     4   /* Front lights and white BGR blink at 4 Hz                 */
+#define LIGHTS_BRAKING        5   /* Rear lights on, dim red BGR                              */
+#define LIGHTS_OBSTACLE       6   /* Front and rear lights take turns, yellow BGR flashing    */
+#define LIGHTS_WAITING        7   /* Blue BGR fades in and out every 2 s, waiting for a phone */
+#define LIGHTS_FAULT          8   /* Three red flashes with the rear lights, then a pause     */
+#define LIGHTS_CHASE          9   /* Lab 2: front, rear, off five times, then all for 1 s     */
+#define LIGHTS_BLE_CONNECTED  10  /* Blue BGR on, a phone is connected (AP_Connected)         */
+#define LIGHTS_PATTERNS       11
+
+// One step of a pattern
+typedef struct LightsStep{
+    uint8_t front;        // Front lights brightness, 0 to LIGHTS_FULL
+    uint8_t back;         // Rear lights brightness, 0 to LIGHTS_FULL
+    uint8_t color;        // BGR LED color (LIGHTS_RED, ...)
+    uint8_t colorLevel;   // BGR LED brightness, 0 to LIGHTS_FULL
+    uint16_t time;        // ms the step lasts, 0 to stay on it
+} LightsStep;
+
+
+// --------------------- Function Prototypes ---------------------
+void Lights_Init(void);
+void Lights_SetPattern(uint32_t pattern);
+void Lights_SetBrightness(uint8_t level);
+
+#endif
@@ -11,24 +11,31 @@
 #include "CortexM.h" // Global Interrupt Control
 
 
-void(*rTask)(uint8_t); // Globalizing input function
+#include "BumpInt.h"
+#include "Ring.h"
+#include "RamFunc.h"
 
 
+// Events from the TimerA2 interrupt (producer) to the main program (consumer)
+RING_DEFINE(BumpRing, BumpEvent, BUMPINT_QUEUE_SIZE)
+static BumpRing BumpIntQueue;
 
+static volatile uint32_t BumpIntMs;        // Time since BumpInt_Init (ms)
+static volatile uint32_t BumpIntDebounce;  // ms until the switches are read, 0 when not debouncing
 
 
-
-
-void BumpInt_Init(void(*task)(uint8_t)){
+void BumpInt_Init(void){
     // Initialize Bump sensors
     // Make six Port 4 pins inputs
     // Activate interface pullup
     // pins 7,6,5,3,2,0 -> 0xED
     // Interrupt on falling edge (on touch)
 
-    rTask = task;
-
     DisableInterrupts();
+    BumpRing_Init(&BumpIntQueue);
+    BumpIntMs = 0;
+    BumpIntDebounce = 0;
+
     P4->SEL0 &= ~0xED;
     P4->SEL1 &= ~0xED;
     P4->DIR &= ~0xED;
@@ -39,11 +46,20 @@ void BumpInt_Init(void(*task)(uint8_t)){
     P4->IE |= 0xED;
     NVIC->IP[9] = (NVIC->IP[9]&0xFF00FFFF) | 0x00400000;
     NVIC->ISER[1] |= 0x00000040;
+
+    // TimerA2 interrupt every 1 ms: SMCLK 12 MHz / 4 / 3 = 1 MHz, up mode to 999
+    TIMER_A2->CTL = 0x0284;        // Stop, SMCLK, /4, clear
+    TIMER_A2->EX0 = 0x0002;        // /3
+    TIMER_A2->CCTL[0] = 0x0010;    // Compare interrupt
+    TIMER_A2->CCR[0] = 999;
+    NVIC->IP[3] = (NVIC->IP[3]&0xFFFFFF00) | 0x00000040;  // Priority 2, same as the switches
+    NVIC->ISER[0] = 0x00001000;    // TA2_0 is interrupt 12
+    TIMER_A2->CTL |= 0x0014;       // Up mode, clear
     EnableInterrupts();
 }
 
 
-uint8_t Bump_Read(void){
+uint8_t BumpInt_Read(void){
     // Read current state of 6 switches
     // Returns a 6-bit positive logic result (0 to 63)
     // bit 5 Bump5
@@ -53,7 +69,7 @@ uint8_t Bump_Read(void){
     // bit 1 Bump1
     // bit 0 Bump0
 
-    uint8_t data = P4->IN;
+    uint8_t data = ~(P4->IN);
     uint8_t ret = 0;
 
     ret |= (data&0x01);      // Bump0
@@ -62,10 +78,45 @@ uint8_t Bump_Read(void){
 
     return ret;
 }
-// we do not care about critical section/race conditions
+
+
+uint32_t BumpInt_GetEvent(BumpEvent *event){
+    return BumpRing_Get(&BumpIntQueue, event);
+}
+
+
+uint32_t BumpInt_Now(void){
+    return BumpIntMs;
+}
+
+
 // triggered on touch, falling edge
-void PORT4_IRQHandler(void){
-    rTask(Bump_Read()); // Execute task from high-level software
-    P4 -> IFG &= ~0xED; // ACK all
+// The switches bounce, so they are left alone until they settle
+RAMFUNC void PORT4_IRQHandler(void){
+    P4->IE &= ~0xED;    // Ignore the bounces
+    P4->IFG &= ~0xED;   // ACK all
+    BumpIntDebounce = BUMPINT_DEBOUNCE_MS;
 }
 
+
+// every 1 ms
+RAMFUNC void TA2_0_IRQHandler(void){
+    BumpEvent event;
+
+    TIMER_A2->CCTL[0] &= ~0x0001;  // ACK
+    BumpIntMs++;
+    if(BumpIntDebounce == 0){
+        return;
+    }
+    BumpIntDebounce--;
+    if(BumpIntDebounce == 0){
+        // Settled: queue the switches that are pressed (releases bounce too)
+        event.time = BumpIntMs;
+        event.bumps = BumpInt_Read();
+        if(event.bumps){
+            BumpRing_Put(&BumpIntQueue, &event);  // Dropped (and counted) if full
+        }
+        P4->IFG &= ~0xED;  // Edges while settling
+        P4->IE |= 0xED;
+    }
+}
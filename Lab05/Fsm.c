@@ -0,0 +1,61 @@
+#include <stdint.h>
+#include "Clock.h"
+#include "Motor.h"
+#include "RobotLights.h"
+#include "Fsm.h"
+
+
+// ---------- Fsm_Stop ----------
+// Motor_Stop with the arguments of the other Motor functions
+static void Fsm_Stop(uint16_t leftDuty, uint16_t rightDuty){
+    (void)leftDuty;
+    (void)rightDuty;
+    Motor_Stop();
+}
+
+// Motor function of each direction, and light function for each light bit value
+static void (* const FsmMotor[FSM_DIRECTIONS])(uint16_t leftDuty, uint16_t rightDuty) = {
+    Fsm_Stop, Motor_Forward, Motor_Backward, Motor_Left, Motor_Right
+};
+static void (* const FsmFrontLights[2])(void) = {Front_Lights_OFF, Front_Lights_ON};
+static void (* const FsmBackLights[2])(void) = {Back_Lights_OFF, Back_Lights_ON};
+
+
+// ---------- Fsm_Output ----------
+// Sends a motor command to the motors and lights
+// Inputs: const FsmOutput* out - the command
+// Output: none
+void Fsm_Output(const FsmOutput* out){
+    FsmMotor[out->direction](out->leftDuty, out->rightDuty);
+    FsmFrontLights[out->lights & FSM_LIGHTS_FRONT]();
+    FsmBackLights[(out->lights & FSM_LIGHTS_BACK) >> 1]();
+}
+
+
+// ---------- Fsm_Next ----------
+// Inputs: const Fsm* fsm - state machine
+//         uint32_t state - current state
+//         uint32_t input - input read in the current state (bits above inputBits are ignored)
+// Output: uint32_t - next state
+uint32_t Fsm_Next(const Fsm* fsm, uint32_t state, uint32_t input){
+    return fsm->next[(state << fsm->inputBits) | (input & ((1u << fsm->inputBits) - 1))];
+}
+
+
+// ---------- Fsm_Run ----------
+// Runs a state machine forever: outputs the state's command, waits its delay,
+// reads the input and moves to the next state
+// Inputs: const Fsm* fsm - state machine
+//         uint32_t state - starting state
+//         FsmInput_t input - reads the input
+// Output: none (does not return)
+void Fsm_Run(const Fsm* fsm, uint32_t state, FsmInput_t input){
+    const FsmState* current;
+
+    while(1){
+        current = &fsm->states[state];
+        Fsm_Output(&current->out);
+        Clock_Delay1ms(current->delay);
+        state = Fsm_Next(fsm, state, input());
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef FSM_H
+#define FSM_H
+
+#include <stdint.h>
+
+/*
+ * Moore FSM engine for the robot. Each state's output is the motor command
+ * itself (direction, both duty cycles and the lights), so running a state is one
+ * lookup and one call, with nothing decoded. The next-state table has one row per
+ * state and one entry per input value, indexed by (state << inputBits) | input.
+ *
+ * Define the tables const at file scope so they are placed in flash, write the
+ * rows with FSM_NEXT2/4/8 and check them with FSM_TABLE_CHECK. The build then
+ * fails when a state has no output or no row, a row is missing an input, or an
+ * entry is not a state:
+ *
+ *   enum { Center, Left, ..., STATES };
+ *   static const FsmState States[] = {{FSM_OUTPUT(FSM_FORWARD, 2000, 2000, FSM_LIGHTS_FRONT), 20}, ...};
+ *   static const uint8_t Next[][4] = {FSM_NEXT4(STATES, OffFront, Left, Right, Center), ...};
+ *   FSM_TABLE_CHECK(Line, States, Next, STATES, 2);
+ *   static const Fsm LineFsm = {States, &Next[0][0], 2};
+ */
+
+
+// --------------------- Definitions ---------------------
+
+// Directions of a motor command
+#define FSM_STOP       0   /* Motor_Stop, duty cycles are not used      */
+#define FSM_FORWARD    1   /* Motor_Forward                             */
+#define FSM_BACKWARD   2   /* Motor_Backward                            */
+#define FSM_LEFT       3   /* Motor_Left: spin left                     */
+#define FSM_RIGHT      4   /* Motor_Right: spin right                   */
+#define FSM_DIRECTIONS 5
+
+// Lights of a motor command
+#define FSM_LIGHTS_FRONT  0x01  /* Front lights on, off otherwise  */
+#define FSM_LIGHTS_BACK   0x02  /* Back lights on, off otherwise   */
+
+#define FSM_MAX_DUTY      14998 /* Largest duty cycle the Motor functions take */
+
+// Motor command of a state, checked when the table is built
+#define FSM_OUTPUT(DIRECTION, LEFT, RIGHT, LIGHTS) \
+    {FSM_CHECKED(LEFT, (LEFT) <= FSM_MAX_DUTY), FSM_CHECKED(RIGHT, (RIGHT) <= FSM_MAX_DUTY), \
+     FSM_CHECKED(DIRECTION, (DIRECTION) < FSM_DIRECTIONS), FSM_CHECKED(LIGHTS, (LIGHTS) <= 0x03)}
+
+// Row of a next-state table for 1, 2 or 3 input bits, each entry checked to be below COUNT
+#define FSM_NEXT2(COUNT, N0, N1) \
+    {FSM_CHECKED(N0, (N0) < (COUNT)), FSM_CHECKED(N1, (N1) < (COUNT))}
+#define FSM_NEXT4(COUNT, N0, N1, N2, N3) \
+    {FSM_CHECKED(N0, (N0) < (COUNT)), FSM_CHECKED(N1, (N1) < (COUNT)), \
+     FSM_CHECKED(N2, (N2) < (COUNT)), FSM_CHECKED(N3, (N3) < (COUNT))}
+#define FSM_NEXT8(COUNT, N0, N1, N2, N3, N4, N5, N6, N7) \
+    {FSM_CHECKED(N0, (N0) < (COUNT)), FSM_CHECKED(N1, (N1) < (COUNT)), \
+     FSM_CHECKED(N2, (N2) < (COUNT)), FSM_CHECKED(N3, (N3) < (COUNT)), \
+     FSM_CHECKED(N4, (N4) < (COUNT)), FSM_CHECKED(N5, (N5) < (COUNT)), \
+     FSM_CHECKED(N6, (N6) < (COUNT)), FSM_CHECKED(N7, (N7) < (COUNT))}
+
+// Fails the build unless the output and next-state tables have COUNT states and
+// every row has an entry for each of the 1 << INPUT_BITS inputs
+#define FSM_TABLE_CHECK(NAME, STATES, NEXT, COUNT, INPUT_BITS) \
+    FSM_ASSERT(sizeof(STATES) / sizeof((STATES)[0]) == (COUNT), NAME##_OutputForEveryState); \
+    FSM_ASSERT(sizeof(NEXT) / sizeof((NEXT)[0]) == (COUNT), NAME##_RowForEveryState); \
+    FSM_ASSERT(sizeof((NEXT)[0]) == (1u << (INPUT_BITS)), NAME##_EntryForEveryInput)
+
+// VALUE, or a negative array size (build error) if OK is 0
+#define FSM_CHECKED(VALUE, OK) ((VALUE) + 0 * sizeof(char[(OK) ? 1 : -1]))
+#define FSM_ASSERT(OK, NAME) typedef char NAME[(OK) ? 1 : -1]
+
+
+// Motor command
+typedef struct FsmOutput{
+    uint16_t leftDuty;    // Duty cycle of the left wheel
+    uint16_t rightDuty;   // Duty cycle of the right wheel
+    uint8_t direction;    // FSM_STOP, FSM_FORWARD, ...
+    uint8_t lights;       // FSM_LIGHTS_FRONT | FSM_LIGHTS_BACK
+} FsmOutput;
+
+// State: its output and the time it is held before the input is read
+typedef struct FsmState{
+    FsmOutput out;
+    uint16_t delay;       // ms
+} FsmState;
+
+// State machine
+typedef struct Fsm{
+    const FsmState* states;   // Indexed by state
+    const uint8_t* next;      // Next state, indexed by (state << inputBits) | input
+    uint8_t inputBits;        // Bits of the input
+} Fsm;
+
+// Reads the input of a state machine
+typedef uint32_t (*FsmInput_t)(void);
+
+
+// --------------------- Function Prototypes ---------------------
+void Fsm_Output(const FsmOutput* out);
+uint32_t Fsm_Next(const Fsm* fsm, uint32_t state, uint32_t input);
+void Fsm_Run(const Fsm* fsm, uint32_t state, FsmInput_t input);
+
+#endif
@@ -0,0 +1,119 @@
+#include <stdint.h>
+#include "Line.h"
+
+
+// Weight of each sensor, bit0 first (robot's right to left, 0.1 mm)
+static const int32_t LineWeight[8] = {332, 237, 142, 47, -47, -142, -237, -332};
+
+static int32_t LineLastPosition;   // Position the last time the line was in sight
+static int32_t LineLastError;      // Position used by the previous Line_Follow
+static uint32_t LineLostFrames;    // Frames in a row without the line
+
+
+// ---------- Line_Init ----------
+// Forgets the line, as if it was last seen under the center of the array
+// Inputs: none
+// Output: none
+void Line_Init(void){
+    LineLastPosition = 0;
+    LineLastError = 0;
+    LineLostFrames = 0;
+}
+
+
+// ---------- Line_Position ----------
+// Finds the line under the array. Each run of adjacent sensors on the line is a
+// line, and the one nearest the last position is followed, so a line crossing at
+// an angle does not pull the robot off. With most sensors on the line the robot
+// is over a crossing and keeps the last position. With none, the line was either
+// lost off a side, which gives LINE_LOST_POSITION on that side, or has a gap,
+// which keeps the last position.
+// Inputs: uint8_t data - frame of the sensors, 1 for each sensor on the line
+//         int32_t* position - set to the line's position (0.1 mm, positive to the right)
+// Output: uint32_t - LINE_ON, LINE_INTERSECTION or LINE_LOST
+uint32_t Line_Position(uint8_t data, int32_t* position){
+    int32_t sum = 0, centroid, distance;
+    int32_t best = 0, bestDistance = INT32_MAX;
+    uint32_t i, count = 0, total = 0, runs = 0;
+
+    if(data == 0){
+        if(LineLastPosition >= LINE_EDGE_POSITION){
+            *position = LINE_LOST_POSITION;
+        } else if(LineLastPosition <= -LINE_EDGE_POSITION){
+            *position = -LINE_LOST_POSITION;
+        } else {
+            *position = LineLastPosition;
+        }
+        return LINE_LOST;
+    }
+
+    // Centroid of each run, ended by a sensor off the line or the end of the array
+    for(i = 0; i <= 8; i++){
+        if((i < 8) && (data & (1 << i))){
+            sum += LineWeight[i];
+            count++;
+            total++;
+        } else if(count){
+            centroid = sum / (int32_t)count;
+            distance = centroid - LineLastPosition;
+            if(distance < 0){
+                distance = -distance;
+            }
+            if(distance < bestDistance){
+                best = centroid;
+                bestDistance = distance;
+            }
+            runs++;
+            sum = 0;
+            count = 0;
+        }
+    }
+
+    if(total >= LINE_INTERSECTION_COUNT){
+        *position = LineLastPosition;
+        return LINE_INTERSECTION;
+    }
+    LineLastPosition = best;
+    *position = best;
+    return (runs > 1) ? LINE_INTERSECTION : LINE_ON;
+}
+
+
+// ---------- Line_Follow ----------
+// PD steering for one frame: the wheel on the side of the line slows down and
+// the other speeds up, both staying forward. Call once per frame, the derivative
+// is per frame.
+// Inputs: uint8_t data - frame of the sensors, 1 for each sensor on the line
+//         uint16_t baseDuty - duty cycle of both wheels with the line centered
+//         uint16_t* leftDuty, rightDuty - set to the duty cycles for Motor_Forward
+// Output: uint32_t - LINE_ON, LINE_INTERSECTION, LINE_LOST, or LINE_GONE when the
+//         line has been lost for LINE_LOST_FRAMES (duty cycles are 0)
+uint32_t Line_Follow(uint8_t data, uint16_t baseDuty, uint16_t* leftDuty, uint16_t* rightDuty){
+    int32_t position, steer, left, right;
+    uint32_t status;
+
+    status = Line_Position(data, &position);
+    if(status == LINE_LOST){
+        if(LineLostFrames >= LINE_LOST_FRAMES){
+            *leftDuty = 0;
+            *rightDuty = 0;
+            return LINE_GONE;
+        }
+        LineLostFrames++;
+    } else {
+        LineLostFrames = 0;
+    }
+
+    steer = (LINE_KP * position + LINE_KD * (position - LineLastError)) / LINE_GAIN_DIVISOR;
+    LineLastError = position;
+
+    left = (int32_t)baseDuty + steer;
+    right = (int32_t)baseDuty - steer;
+    if(left < 0){left = 0;}
+    if(right < 0){right = 0;}
+    if(left > LINE_MAX_DUTY){left = LINE_MAX_DUTY;}
+    if(right > LINE_MAX_DUTY){right = LINE_MAX_DUTY;}
+    *leftDuty = left;
+    *rightDuty = right;
+    return status;
+}
@@ -0,0 +1,46 @@
+#ifndef LINE_H
+#define LINE_H
+
+#include <stdint.h>
+
+/*
+ * Line position and PD line follower on the eight reflectance sensors.
+ *
+ * Line_Position turns a frame of the sensors (bit0 is the robot's right sensor)
+ * into the position of the line under the array, in fixed point: 0.1 mm from the
+ * center of the array, positive when the line is to the robot's right. It is the
+ * weighted centroid of the sensors on the line, with the weights of
+ * Reflectance_Position. With the line out of sight the position is remembered from
+ * the last frames, and crossings are told apart from the line being followed.
+ *
+ * Line_Follow runs the PD steering on that position once per frame and gives the
+ * duty cycles for Motor_Forward.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#define LINE_EDGE_POSITION       190   /* Line further out than this when lost is off to that side   */
+#define LINE_LOST_POSITION       475   /* Position used once the line is lost off a side (0.1 mm)    */
+#define LINE_INTERSECTION_COUNT  6     /* Sensors on the line that make a crossing                   */
+#define LINE_LOST_FRAMES         250   /* Frames without the line before Line_Follow gives up        */
+
+// PD gains, as duty cycle per 0.1 mm times LINE_GAIN_DIVISOR
+#define LINE_KP                  6000  /* Duty cycle per 0.1 mm of position                          */
+#define LINE_KD                  60000 /* Duty cycle per 0.1 mm the position moves in one frame      */
+#define LINE_GAIN_DIVISOR        256
+#define LINE_MAX_DUTY            14998 /* Largest duty cycle Motor_Forward takes                     */
+
+// Status of a frame
+#define LINE_ON            0   /* One line under the array                                          */
+#define LINE_INTERSECTION  1   /* Crossing: followed the part nearest the last position             */
+#define LINE_LOST          2   /* No sensor on the line: position is remembered                     */
+#define LINE_GONE          3   /* Lost for LINE_LOST_FRAMES frames (Line_Follow only)               */
+
+
+// --------------------- Function Prototypes ---------------------
+void Line_Init(void);
+uint32_t Line_Position(uint8_t data, int32_t* position);
+uint32_t Line_Follow(uint8_t data, uint16_t baseDuty, uint16_t* leftDuty, uint16_t* rightDuty);
+
+#endif
@@ -57,6 +57,18 @@ policies, either expressed or implied, of the FreeBSD Project.
 #include <stdint.h>
 #include "msp432.h"
 #include "Clock.h"
+#include "Reflectance.h"
+
+// Phases of the background scan, each ends with a TimerA1 compare interrupt
+#define REFLECTANCE_CHARGE  0   // LEDs on, sensors charging
+#define REFLECTANCE_RELEASE 1   // Sensors decaying
+#define REFLECTANCE_SAMPLE  2   // Waiting for the next scan
+
+static uint32_t ReflectancePhase;
+static uint32_t ReflectanceSampleTime;   // us from release to sample
+static uint32_t ReflectanceWaitTime;     // us from sample to the next charge
+static volatile uint8_t ReflectanceData;         // Latest frame
+static volatile uint32_t ReflectanceSequence;    // Frames since Reflectance_Scan
 
 // ------------Reflectance_Init------------
 // Initialize the GPIO pins associated with the QTR-8RC
@@ -143,3 +155,104 @@ uint8_t Reflectance_Center(uint32_t time){
     uint8_t result = Reflectance_Read(time);
     return (uint8_t)( (result >> 3) & 0x03 );
 }
+
+// ------------Reflectance_Scan------------
+// Read the eight sensors in the background at a fixed rate.
+// TimerA1 interrupts step each scan through its phases
+// LEDs on and charge the sensors for 10 us
+// Make the sensor pins input and wait sampleTime us
+// Read sensors, turn off the LEDs and publish the frame
+// so the IR LEDs are only on for the sample window.
+// Input: period, us from one scan to the next
+//        sampleTime, us to wait before reading (as in
+//          Reflectance_Read)
+// Output: none
+// Assumes: Reflectance_Init() has been called, period is
+//          at least sampleTime+REFLECTANCE_CHARGE_US+10 and
+//          at most 65535
+// Do not call Reflectance_Read while scanning
+void Reflectance_Scan(uint32_t period, uint32_t sampleTime){
+    TIMER_A1->CTL &= ~0x0030;         // halt TimerA1 during setup
+    ReflectanceSampleTime = sampleTime;
+    ReflectanceWaitTime = period - sampleTime - REFLECTANCE_CHARGE_US;
+    ReflectancePhase = REFLECTANCE_CHARGE;
+    ReflectanceSequence = 0;
+
+    // SMCLK 12 MHz /4 /3, 1 us per count, continuous mode
+    TIMER_A1->CTL = 0x0284;           // SMCLK, /4, stopped, clear
+    TIMER_A1->EX0 = 0x0002;           // /3
+    TIMER_A1->CCTL[0] = 0x0010;       // compare mode, interrupt on CCR0
+    TIMER_A1->CCR[0] = REFLECTANCE_CHARGE_US;
+    NVIC->IP[2] = (NVIC->IP[2]&0xFF00FFFF)|0x00400000; // priority 2
+    NVIC->ISER[0] = 0x00000400;       // enable interrupt 10 in NVIC
+    TIMER_A1->CTL |= 0x0020;          // continuous mode
+}
+
+// ------------Reflectance_ScanStop------------
+// Stop the background scan and turn off the LEDs
+// Input: none
+// Output: none
+void Reflectance_ScanStop(void){
+    TIMER_A1->CTL &= ~0x0030;         // halt TimerA1
+    TIMER_A1->CCTL[0] &= ~0x0011;     // disarm and acknowledge
+    P7->DIR &= ~0xFF;
+    P5->OUT &= ~0x08;
+    P9->OUT &= ~0x04;
+}
+
+// ------------TA1_0_IRQHandler------------
+// One phase of the background scan; the next compare is
+// set relative to this one, so the rate does not drift
+void TA1_0_IRQHandler(void){
+    TIMER_A1->CCTL[0] &= ~0x0001;     // acknowledge compare interrupt
+    switch(ReflectancePhase){
+    case REFLECTANCE_CHARGE:
+        P5->OUT |= 0x08;              // turn on the 8 IR LEDs
+        P9->OUT |= 0x04;
+        P7->DIR |= 0xFF;              // charge the sensors
+        P7->OUT |= 0xFF;
+        TIMER_A1->CCR[0] += REFLECTANCE_CHARGE_US;
+        ReflectancePhase = REFLECTANCE_RELEASE;
+        break;
+    case REFLECTANCE_RELEASE:
+        P7->DIR &= ~0xFF;             // make the sensor pins inputs
+        TIMER_A1->CCR[0] += ReflectanceSampleTime;
+        ReflectancePhase = REFLECTANCE_SAMPLE;
+        break;
+    default:
+        ReflectanceData = P7->IN;     // read sensors
+        ReflectanceSequence++;
+        P5->OUT &= ~0x08;             // turn off the 8 IR LEDs
+        P9->OUT &= ~0x04;
+        TIMER_A1->CCR[0] += ReflectanceWaitTime;
+        ReflectancePhase = REFLECTANCE_CHARGE;
+        break;
+    }
+}
+
+// ------------Reflectance_Get------------
+// Return last reading of the background scan
+// Input: none
+// Output: sensor readings (white is 0, black is 1)
+// Assumes: Reflectance_Scan() has been called
+uint8_t Reflectance_Get(void){
+    return ReflectanceData;
+}
+
+// ------------Reflectance_GetFrame------------
+// Return last reading of the background scan and its
+// sequence number, read together
+// Input: data, set to the sensor readings
+// Output: sequence number, frames read since
+//         Reflectance_Scan (0 until the first frame)
+// Assumes: Reflectance_Scan() has been called
+uint32_t Reflectance_GetFrame(uint8_t *data){
+    uint32_t sequence, primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    *data = ReflectanceData;
+    sequence = ReflectanceSequence;
+    __set_PRIMASK(primask);
+    return sequence;
+}
@@ -72,6 +72,11 @@ policies, either expressed or implied, of the FreeBSD Project.
 #define REFLECTANCE_H_
 
 
+/**
+ * Time the sensors charge in each background scan (us)
+ */
+#define REFLECTANCE_CHARGE_US 10
+
 /**
  * Initialize the GPIO pins associated with the QTR-8RC.
  * One output to IR LED, 8 inputs from the sensor array.
@@ -168,15 +173,48 @@ void Reflectance_Start(void);
  */
 uint8_t Reflectance_End(void);
 
+/**
+ * <b>Read the eight sensors in the background at a fixed rate</b>:<br>
+ * TimerA1 interrupts step each scan through non-blocking phases<br>
+  1) Turn on the 8 IR LEDs and pulse the 8 sensors high for 10 us<br>
+  2) Make the sensor pins input and wait <b>sampleTime</b> us<br>
+  3) Read sensors, turn off the 8 IR LEDs and publish the frame<br>
+ * The LEDs are only on for the sample window, and the main loop is never stalled.
+ * @param  period us from one scan to the next, at most 65535
+ * @param  sampleTime us to wait before reading, as in Reflectance_Read()
+ * @return none
+ * @note Assumes Reflectance_Init() has been called
+ * @note Uses TimerA1; do not call Reflectance_Read() while scanning
+ * @brief  Start the background scan.
+ */
+void Reflectance_Scan(uint32_t period, uint32_t sampleTime);
+
+/**
+ * Stop the background scan and turn off the LEDs.
+ * @param  none
+ * @return none
+ * @brief  Stop the background scan.
+ */
+void Reflectance_ScanStop(void);
+
 /**
  * <b>Return last reading</b>
  * @param  none
  * @return 8-bit result
- * @note  Assumes: Reflectance_Init() has been called
- * @note  Assumes: Reflectance_Start() was called
- * @note  Assumes: Reflectance_End() was called 1 ms after Start
+ * @note  Assumes: Reflectance_Scan() has been called
  * @brief  Get last reading of the eight sensors.
  */
 uint8_t Reflectance_Get(void);
 
+/**
+ * <b>Return last reading and its sequence number</b>, read together.
+ * The sequence number counts the frames, so a loop can tell a new frame from
+ * one it already used.
+ * @param  data set to the 8-bit result
+ * @return frames read since Reflectance_Scan() (0 until the first frame)
+ * @note  Assumes: Reflectance_Scan() has been called
+ * @brief  Get last reading of the eight sensors and its sequence number.
+ */
+uint32_t Reflectance_GetFrame(uint8_t *data);
+
 #endif /* REFLECTANCE_H_ */
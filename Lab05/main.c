@@ -3,39 +3,68 @@
 #include "Reflectance.h"
 #include "RobotLights.h"
 #include "Motor.h"
+#include "Line.h"
+#include "Fsm.h"
 
 
+// Line followers (FOLLOW_MODE)
+#define FOLLOW_FSM  0  /* 6-state Moore FSM on the two center sensors            */
+#define FOLLOW_PD   1  /* PD steering on the line position from all eight sensors */
+
+#ifndef FOLLOW_MODE
+#define FOLLOW_MODE FOLLOW_PD  /* Host/LineSim.c builds both to compare them */
+#endif
+
 #define SPEED     ((uint16_t) 2000)  /* Base speed for the motors (duty cycle out of 15000) */
+#define PD_SPEED  ((uint16_t) 5000)  /* Speed with the line centered, FOLLOW_PD (duty cycle) */
 #define TIME      ((uint32_t) 1000)  /* Time for the reflectance sensor to wait (usec)      */
+#define PERIOD    ((uint32_t) 2000)  /* Time between background reflectance scans (usec)   */
+#define POLL      ((uint32_t) 100)   /* Time between checks for a new scan, FOLLOW_PD (usec) */
+
+
+#if FOLLOW_MODE == FOLLOW_FSM
 
 // States (dependent on the position of the robot)
-#define Center    &fsm[0]  /* Aligned with center of the line */
-#define Left      &fsm[1]  /* On the left side of the line    */
-#define Right     &fsm[2]  /* On the right side of the line   */
-#define OffLeft   &fsm[3]  /* Off the line to the left side   */
-#define OffRight  &fsm[4]  /* Off the line to the right side  */
-#define OffFront  &fsm[5]  /* Off the line to the front       */
-
-
-// Linked data structure for each state
-struct State {
-    uint32_t out; // 4-bit output (left backwards, right backwards, left forwards, right forwards)
-    uint32_t delay; // time to delay in 1ms
-    const struct State *next[4]; // Next if 2-bit input is 0-3
+enum {
+    Center,    /* Aligned with center of the line */
+    Left,      /* On the left side of the line    */
+    Right,     /* On the right side of the line   */
+    OffLeft,   /* Off the line to the left side   */
+    OffRight,  /* Off the line to the right side  */
+    OffFront,  /* Off the line to the front       */
+    STATES
 };
 
-typedef const struct State State_t;
+// Output of each state, with the time to stay in it (ms)
+static const FsmState States[] = {
+    {FSM_OUTPUT(FSM_FORWARD,  SPEED, SPEED, FSM_LIGHTS_FRONT),                   20},  // Center: forward
+    {FSM_OUTPUT(FSM_FORWARD,  SPEED, 0,     FSM_LIGHTS_FRONT),                   20},  // Left: slight right
+    {FSM_OUTPUT(FSM_FORWARD,  0,     SPEED, FSM_LIGHTS_FRONT),                   20},  // Right: slight left
+    {FSM_OUTPUT(FSM_RIGHT,    SPEED, SPEED, FSM_LIGHTS_FRONT | FSM_LIGHTS_BACK), 20},  // OffLeft: spin right
+    {FSM_OUTPUT(FSM_LEFT,     SPEED, SPEED, FSM_LIGHTS_FRONT | FSM_LIGHTS_BACK), 20},  // OffRight: spin left
+    {FSM_OUTPUT(FSM_BACKWARD, SPEED, SPEED, FSM_LIGHTS_BACK),                    20}   // OffFront: backwards
+};
 
+// Next state for each 2-bit input from the center sensors
+static const uint8_t Next[][4] = {
+    FSM_NEXT4(STATES, OffFront, Left, Right, Center),  // Center
+    FSM_NEXT4(STATES, OffLeft,  Left, Right, Center),  // Left
+    FSM_NEXT4(STATES, OffRight, Left, Right, Center),  // Right
+    FSM_NEXT4(STATES, OffLeft,  Left, Right, Center),  // OffLeft
+    FSM_NEXT4(STATES, OffRight, Left, Right, Center),  // OffRight
+    FSM_NEXT4(STATES, OffFront, Left, Right, Center)   // OffFront
+};
 
-// States are locations relative to the line
-State_t fsm[6] = {{0x03 /* Forward      */, 20, { OffFront, Left, Right, Center }},  // Center
-                  {0x02 /* Slight right */, 20, { OffLeft,  Left, Right, Center }},  // Left
-                  {0x01 /* Slight left  */, 20, { OffRight, Left, Right, Center }},  // Right
-                  {0x06 /* Spin right   */, 20, { OffLeft,  Left, Right, Center }},  // OffLeft
-                  {0x09 /* Spin left    */, 20, { OffRight, Left, Right, Center }},  // OffRight
-                  {0x0C /* Backwards    */, 20, { OffFront, Left, Right, Center }}}; // OffFront
+FSM_TABLE_CHECK(LineFollower, States, Next, STATES, 2);
 
-State_t *Spt; // pointer to the current state
+static const Fsm LineFsm = {States, &Next[0][0], 2};
+
+
+// Input of the states: the two center sensors from the latest background scan
+static uint32_t CenterSensors(void) {
+    return (Reflectance_Get() >> 3) & 0x03;
+}
+#endif
 
 
 // Program entry point
@@ -44,77 +73,43 @@ void main(void) {
 	WDT_A->CTL = WDT_A_CTL_PW | WDT_A_CTL_HOLD;
 	Clock_Init48MHz();
 
-	// Containers
-	uint8_t dataCenter;
-	uint8_t rightData, leftData;
-	uint8_t leftBack, rightBack;
-
 	// Initializations
 	Reflectance_Init();
 	Motor_Init();
 	MvtLED_Init();
 
-	// Start in the center state
-	Spt = Center;
+	// Read the sensors in the background, so the states are not held up by reads
+	Reflectance_Scan(PERIOD, TIME);
 
-	// Main loop
-	while (1) {
-	    // Extract state output data for the right wheel
-	    rightData = (Spt->out) & 0x05;
-	    rightBack = 0;
-
-	    // Check if right wheel needs to turn backwards
-	    if(rightData > 0x03){
-	        rightBack = 1;
-	        rightData = 0x01;
-	    } else {
-	        // Else, right wheel is moving forwards (or stopped)
-	        rightData = rightData & 0x01;
-	    }
+#if FOLLOW_MODE == FOLLOW_FSM
+	// Start in the center state, the states' outputs drive the motors
+	Fsm_Run(&LineFsm, Center, &CenterSensors);
+#else
+	// Containers
+	uint8_t data;
+	uint16_t leftDuty, rightDuty;
+	uint32_t sequence = 0, frame;
 
-	    // Extract state output data for the left wheel
-	    leftData = (Spt->out) & 0x0A;
-	    leftBack = 0;
+	Line_Init();
 
-	    // Check if left wheel needs to turn backwards
-	    if(leftData > 0x03){
-	        leftBack = 1;
-	        leftData = 0x01;
-	    } else {
-	        // Else, left wheel is moving forwards (or stopped)
-	        leftData = (leftData >> 1) & 0x01;
+	// Main loop
+	while (1) {
+	    // Wait for the next scan, so the steering runs once per scan
+	    while ((frame = Reflectance_GetFrame(&data)) == sequence) {
+	        Clock_Delay1us(POLL);
 	    }
+	    sequence = frame;
 
-	    // Check which motor function to call
-	    if(rightBack == 1 && leftBack == 1){
-	        // Both wheels backwards
-	        Motor_Backward(leftData*SPEED, rightData*SPEED);
+	    // Steer towards the line, or stop once it has been lost for too long
+	    if (Line_Follow(data, PD_SPEED, &leftDuty, &rightDuty) == LINE_GONE) {
+	        Motor_Stop();
 	        Back_Lights_ON();
 	        Front_Lights_OFF();
-	    } else if(rightBack == 1 && leftBack == 0){
-	        // Right wheel back, left wheel forward (spinning right)
-	        Motor_Right(leftData*SPEED, rightData*SPEED);
-	        Back_Lights_ON();
-	        Front_Lights_ON();
-	    } else if(leftBack == 1 && rightBack == 0){
-	        // Left wheel back, right wheel forward (spinning left)
-	        Motor_Left(leftData*SPEED, rightData*SPEED);
-	        Back_Lights_ON();
-	        Front_Lights_ON();
 	    } else {
-	        // Both wheels forward
-	        Motor_Forward(leftData*SPEED, rightData*SPEED);
+	        Motor_Forward(leftDuty, rightDuty);
 	        Back_Lights_OFF();
 	        Front_Lights_ON();
 	    }
-
-	    // Stay in that state for specified delay
-	    Clock_Delay1ms(Spt->delay);
-
-	    // Get input from central sensors
-	    dataCenter = Reflectance_Center(TIME);
-
-	    // Set the next state
-	    Spt = Spt->next[dataCenter];
 	}
+#endif
 }
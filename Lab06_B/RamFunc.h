@@ -0,0 +1,31 @@
+#ifndef RAMFUNC_H
+#define RAMFUNC_H
+
+/*
+ * Runs a function from SRAM instead of flash.
+ *
+ * At 48 MHz Clock_Init48MHz sets 2 flash wait states, so code in flash waits on
+ * every fetch the read buffer misses. SRAM has no wait states. RAMFUNC places a
+ * function in the .TI.ramfunc section, which msp432p401r.cmd loads in MAIN and runs
+ * from SRAM_CODE through the BINIT copy table; _c_int00 copies it before main, so
+ * it is in place before any interrupt is enabled. Interrupt vectors and calls use
+ * the SRAM address.
+ *
+ *   RAMFUNC void TA3_0_IRQHandler(void){ ... }
+ *
+ * It is meant for interrupt handlers and the functions they call, which run often
+ * and briefly; everything else stays in flash, as the SRAM it takes is shared with
+ * the data. Predefine RAMFUNC_IN_FLASH to leave every function in flash (to time
+ * the difference, Bench/main.c), and host builds ignore RAMFUNC.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#if defined(__TI_COMPILER_VERSION__) && (__TI_COMPILER_VERSION__ >= 15009000) && !defined(RAMFUNC_IN_FLASH)
+#define RAMFUNC __attribute__((ramfunc))
+#else
+#define RAMFUNC
+#endif
+
+#endif
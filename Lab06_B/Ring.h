@@ -0,0 +1,97 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+
+/*
+ * Single-producer, single-consumer ring of typed items, to pass events and data
+ * from one interrupt handler (TA3, PORT4, EUSCIA2, ADC14, ...) to the main
+ * program, or the other way round. Header only: RING_DEFINE makes the ring type
+ * and its functions for one payload type and size,
+ *
+ *   RING_DEFINE(BumpRing, BumpEvent, 8)
+ *   static BumpRing Bumps;
+ *   BumpRing_Init(&Bumps);
+ *   BumpRing_Put(&Bumps, &event);        // interrupt (producer) only
+ *   BumpRing_Get(&Bumps, &event);        // main program (consumer) only
+ *
+ * The put and get indices run free and are each written by one side only, so no
+ * critical section is needed. Items come out in the order they went in; when the
+ * ring is full the new item is dropped and counted, so the consumer can tell how
+ * many it lost. highWater is the most items that were ever waiting.
+ *
+ * On the MSP432 both sides run on the one core, and the volatile buffer and
+ * indices keep the compiler from moving the item past its index. Built with
+ * GCC or Clang for the host (Host/RingTest.c runs the two sides on two threads),
+ * RING_RELEASE and RING_ACQUIRE also order them for the other core.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(__TI_COMPILER_VERSION__)
+#define RING_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)  /* Item written before its index */
+#define RING_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)  /* Index read before its item    */
+#else
+#define RING_RELEASE()
+#define RING_ACQUIRE()
+#endif
+
+// Fails the build unless SIZE is a power of 2
+#define RING_ASSERT_SIZE(NAME, SIZE) \
+    typedef char NAME##_SizeIsPowerOf2[(((SIZE) > 0) && (((SIZE) & ((SIZE) - 1)) == 0)) ? 1 : -1]
+
+// Ring type NAME of SIZE items of TYPE, with NAME_Init, NAME_Put, NAME_Get and NAME_Count
+#define RING_DEFINE(NAME, TYPE, SIZE) \
+    RING_ASSERT_SIZE(NAME, SIZE); \
+    typedef struct NAME{ \
+        volatile uint32_t putI;       /* Items put, written by the producer only        */ \
+        volatile uint32_t getI;       /* Items taken, written by the consumer only      */ \
+        volatile uint32_t dropped;    /* Items dropped because the ring was full        */ \
+        volatile uint32_t highWater;  /* Most items ever waiting                        */ \
+        volatile TYPE buffer[SIZE]; \
+    } NAME; \
+    \
+    /* Empties the ring and clears the counters (neither side may be running) */ \
+    static inline void NAME##_Init(NAME* ring){ \
+        ring->putI = ring->getI = 0; \
+        ring->dropped = ring->highWater = 0; \
+    } \
+    \
+    /* Producer: adds a copy of item, returns 1, or 0 if the ring is full (dropped) */ \
+    static inline uint32_t NAME##_Put(NAME* ring, const TYPE* item){ \
+        uint32_t putI = ring->putI; \
+        uint32_t count = putI - ring->getI; \
+        if(count >= (SIZE)){ \
+            ring->dropped++; \
+            return 0; \
+        } \
+        RING_ACQUIRE(); \
+        ring->buffer[putI & ((SIZE) - 1)] = *item; \
+        RING_RELEASE(); \
+        ring->putI = putI + 1; \
+        if(count + 1 > ring->highWater){ \
+            ring->highWater = count + 1; \
+        } \
+        return 1; \
+    } \
+    \
+    /* Consumer: takes the oldest item, returns 1, or 0 if the ring is empty */ \
+    static inline uint32_t NAME##_Get(NAME* ring, TYPE* item){ \
+        uint32_t getI = ring->getI; \
+        if(getI == ring->putI){ \
+            return 0; \
+        } \
+        RING_ACQUIRE(); \
+        *item = ring->buffer[getI & ((SIZE) - 1)]; \
+        RING_RELEASE(); \
+        ring->getI = getI + 1; \
+        return 1; \
+    } \
+    \
+    /* Either side: items waiting (the other side may have changed it since) */ \
+    static inline uint32_t NAME##_Count(const NAME* ring){ \
+        return ring->putI - ring->getI; \
+    }
+
+#endif
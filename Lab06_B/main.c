@@ -4,6 +4,7 @@
 #include "RobotLights.h"
 #include "Motor.h"
 #include "BumpInt.h"
+#include "Maneuver.h"
 #include <math.h>
 
 
@@ -27,12 +28,10 @@
 // Distance where it is on a collision course
 #define COLLISION_DISTANCE_MM     100
 
-// Bumper numbers for the front two
-#define FRONT_RIGHT_BUMPER        2
-#define FRONT_LEFT_BUMPER         3
+// Collision maneuver, run by the main loop after a bump (the front turns for both spinning times)
+static const ManeuverConfig Avoid = {BACKWARDS_SPEED, SPINNING_SPEED, BACKWARDS_TIME, SPINNING_TIME, SPINNING_TIME};
 
 
-void HandleCollision(uint8_t ISR_BumpData);
 void computeDistances(uint32_t leftADC, uint32_t *leftDist, uint32_t centerADC, uint32_t *centerDist, uint32_t rightADC, uint32_t *rightDist);
 uint32_t computeDistance(uint32_t adcReading, char side);
 
@@ -49,7 +48,8 @@ void main(void){
     ADC0_InitSWTriggerCh17_14_16();
     MvtLED_Init();
     Motor_Init();
-    BumpInt_Init(&HandleCollision); // Pass the function in from main
+    BumpInt_Init();
+    Maneuver_Init(&Avoid);
 
     // Move the robot forwards and turn on the front lights
     Motor_Forward(FORWARDS_SPEED, FORWARDS_SPEED);
@@ -59,6 +59,11 @@ void main(void){
     uint32_t leftDist, centerDist, rightDist;
 
     while(1){
+        // Back up and turn after a bump, the sensors wait until it is over
+        if(Maneuver_Update()){
+            Clock_Delay1ms(SAMPLE_TIME);
+            continue;
+        }
 
         // Get distances from each sensor
         ADC_In17_14_16(&leftADC, &centerADC, &rightADC);
@@ -101,63 +106,6 @@ void main(void){
 }
 
 
-// Handle Collision
-// Bumper Interrupt Service Routine
-// Input: The data from the bumpers
-void HandleCollision(uint8_t ISR_BumpData){
-    // Store the bumper data
-    uint8_t Bump_Data = ISR_BumpData;
-
-    // Containers
-    uint32_t left = 0;      // How many of the left bumpers were hit
-    uint32_t right = 0;     // How many of the right bumpers were hit
-    uint32_t hit_front = 0; // Were either of the front two bumpers hit?
-
-    int i;
-
-    // Check which bumpers were hit
-    for(i = 0; i < 6; i++){
-        // Check if the current bumper was hit
-        if( (Bump_Data & (0x01 << i)) == 0 ){
-            if(i < 3){ // Right Side
-                if(i == FRONT_RIGHT_BUMPER)
-                    hit_front = 1;
-                right++;
-            } else { // Left Side
-                if(i == FRONT_LEFT_BUMPER)
-                    hit_front = 1;
-                left++;
-            }
-        }
-    }
-
-    // Move the robot backwards
-    Motor_Backward(BACKWARDS_SPEED, BACKWARDS_SPEED);
-    Front_Lights_OFF();
-    Back_Lights_ON();
-    Clock_Delay1ms(BACKWARDS_TIME);
-    Back_Lights_OFF();
-
-    // Determined direction to turn the robot
-    if(hit_front > 0) {
-        // Turn left for an extended period of time
-        Motor_Left(SPINNING_SPEED, SPINNING_SPEED);
-        Clock_Delay1ms(SPINNING_TIME);
-    } else if(left >= right) {
-        // If left side was hit, turn right
-        Motor_Right(SPINNING_SPEED, SPINNING_SPEED);
-    } else {
-        // If the right side was hit, turn left
-        Motor_Left(SPINNING_SPEED, SPINNING_SPEED);
-    }
-
-    // Wait, then move the robot forwards
-    Clock_Delay1ms(SPINNING_TIME);
-    Motor_Forward(FORWARDS_SPEED, FORWARDS_SPEED);
-    Front_Lights_ON();
-}
-
-
 // Compute all distances from the center
 // Inputs: ADC values and pointers to store distances
 void computeDistances(uint32_t leftADC, uint32_t *leftDist, uint32_t centerADC,
@@ -5,7 +5,7 @@
  1) Hardware uses negative logic with internal pullup<br>
  2) Positioned on the front of the robot to detect collisions<br>
  3) Software returns 6-bit positive logic (1 means collision)<br>
- 4) Interrupt driven event handler
+ 4) Interrupt driven, debounced events queued for the main program
  * @version   TI-RSLK MAX v1.1
  * @author    Daniel Valvano and Jonathan Valvano
  * @copyright Copyright 2019 by Jonathan W. Valvano, valvano@mail.utexas.edu,
@@ -60,16 +60,56 @@ policies, either expressed or implied, of the FreeBSD Project.
 */
 
 
+#ifndef BUMPINT_H_
+#define BUMPINT_H_
+
+#include <stdint.h>
+
+#define BUMPINT_DEBOUNCE_MS  10  /**< Time the switches settle after an edge before they are read */
+#define BUMPINT_QUEUE_SIZE   8   /**< Events the queue holds (power of 2) */
+
+/**
+ * \brief Bump event: the switches that were pressed once they settled
+ */
+typedef struct BumpEvent{
+    uint32_t time;   /**< BumpInt_Now() when the switches were read (ms) */
+    uint8_t bumps;   /**< 6-bit positive logic, as BumpInt_Read() */
+} BumpEvent;
+
 /**
  * Initialize Bump sensors<br>
  * Make P4.7-P4.0 as interrupt-driven inputs<br>
  * Activate interface pull-up<br>
- * Interrupt on falling edge
- * @param task user function to run on collision
+ * Interrupt on falling edge<br>
+ * TimerA2 interrupts every 1 ms for the time and the debouncing.
+ * An edge masks the switch interrupts for BUMPINT_DEBOUNCE_MS, then the
+ * switches are read and, if any is pressed, a BumpEvent is queued.
+ * The interrupts return right away, the main program takes the events
+ * with BumpInt_GetEvent().
+ * @param none
  * @return none
  * @brief  Initialize Bump sensors
  */
-void BumpInt_Init(void(*task)(uint8_t));
+void BumpInt_Init(void);
+
+/**
+ * Take the oldest bump event from the queue (Ring.h)<br>
+ * The queue has a single producer (TimerA2 interrupt) and a single
+ * consumer (main program), so it needs no critical section.
+ * Events are dropped while the queue is full.
+ * @param event set to the oldest event
+ * @return 1 if there was an event, 0 if the queue is empty
+ * @brief  Take the oldest bump event
+ */
+uint32_t BumpInt_GetEvent(BumpEvent *event);
+
+/**
+ * Time since BumpInt_Init()
+ * @param none
+ * @return time in ms
+ * @brief  Time since BumpInt_Init()
+ */
+uint32_t BumpInt_Now(void);
 
 /**
  * Read current state of 6 switches<br>
@@ -88,3 +128,4 @@ void BumpInt_Init(void(*task)(uint8_t));
  */
 uint8_t BumpInt_Read(void);
 
+#endif /* BUMPINT_H_ */
@@ -0,0 +1,89 @@
+#include <stdint.h>
+#include "BumpInt.h"
+#include "Motor.h"
+#include "RobotLights.h"
+#include "Maneuver.h"
+
+
+static const ManeuverConfig* ManeuverSettings;
+static uint32_t ManeuverPhase;
+static uint32_t ManeuverStart;     // BumpInt_Now() when the phase started (ms)
+static uint32_t ManeuverTime;      // Length of the phase (ms)
+static uint8_t ManeuverBumps;      // Switches pressed by the bump that started it
+
+
+// ---------- Maneuver_Init ----------
+// Inputs: const ManeuverConfig* config - speeds and times, kept (not copied)
+// Output: none
+void Maneuver_Init(const ManeuverConfig* config){
+    ManeuverSettings = config;
+    ManeuverPhase = MANEUVER_IDLE;
+}
+
+
+// ---------- Maneuver_Count ----------
+// Output: uint32_t - bits set in bumps
+static uint32_t Maneuver_Count(uint8_t bumps){
+    uint32_t count = 0;
+
+    while(bumps){
+        count += bumps & 0x01;
+        bumps >>= 1;
+    }
+    return count;
+}
+
+
+// ---------- Maneuver_Turn ----------
+// Starts turning away from the side that was hit: left for longer when the
+// front was hit, right when the left side was hit at least as much as the right
+static void Maneuver_Turn(uint32_t now){
+    ManeuverPhase = MANEUVER_TURNING;
+    ManeuverStart = now;
+    ManeuverTime = ManeuverSettings->turningTime;
+    Back_Lights_OFF();
+
+    if(ManeuverBumps & MANEUVER_FRONT_BUMPS){
+        ManeuverTime += ManeuverSettings->frontExtraTime;
+        Motor_Left(ManeuverSettings->turningSpeed, ManeuverSettings->turningSpeed);
+    } else if(Maneuver_Count(ManeuverBumps & MANEUVER_LEFT_BUMPS)
+              >= Maneuver_Count(ManeuverBumps & MANEUVER_RIGHT_BUMPS)){
+        Motor_Right(ManeuverSettings->turningSpeed, ManeuverSettings->turningSpeed);
+    } else {
+        Motor_Left(ManeuverSettings->turningSpeed, ManeuverSettings->turningSpeed);
+    }
+}
+
+
+// ---------- Maneuver_Update ----------
+// Starts a maneuver for each bump event (a new bump starts it over) and moves it
+// on to its next phase once the current one has lasted long enough. Call it
+// every pass of the main loop
+// Inputs: none
+// Output: uint32_t - 1 while the maneuver drives the motors, 0 once it is over
+//         (the front lights are back on and the main loop drives again)
+uint32_t Maneuver_Update(void){
+    BumpEvent event;
+    uint32_t now;
+
+    while(BumpInt_GetEvent(&event)){
+        ManeuverPhase = MANEUVER_BACKING;
+        ManeuverStart = event.time;
+        ManeuverTime = ManeuverSettings->backwardsTime;
+        ManeuverBumps = event.bumps;
+        Motor_Backward(ManeuverSettings->backwardsSpeed, ManeuverSettings->backwardsSpeed);
+        Front_Lights_OFF();
+        Back_Lights_ON();
+    }
+
+    now = BumpInt_Now();
+    if((ManeuverPhase != MANEUVER_IDLE) && ((now - ManeuverStart) >= ManeuverTime)){
+        if(ManeuverPhase == MANEUVER_BACKING){
+            Maneuver_Turn(now);
+        } else {
+            ManeuverPhase = MANEUVER_IDLE;
+            Front_Lights_ON();
+        }
+    }
+    return ManeuverPhase != MANEUVER_IDLE;
+}
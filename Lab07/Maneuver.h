@@ -0,0 +1,41 @@
+#ifndef MANEUVER_H
+#define MANEUVER_H
+
+#include <stdint.h>
+#include "BumpInt.h"
+
+/*
+ * Collision maneuver run from the main loop: backs up and turns away after a
+ * bump, without waiting inside an interrupt. Maneuver_Update takes the bump
+ * events queued by BumpInt and moves the maneuver on by the time that has
+ * passed, so it returns right away; the main loop skips its own behaviour
+ * while it returns 1.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#define MANEUVER_RIGHT_BUMPS  0x07  /* Bump0-2, right side of the robot   */
+#define MANEUVER_LEFT_BUMPS   0x38  /* Bump3-5, left side of the robot    */
+#define MANEUVER_FRONT_BUMPS  0x0C  /* Bump2 and Bump3, front of the robot */
+
+// Phases of the maneuver
+#define MANEUVER_IDLE      0   /* No maneuver, the main loop drives      */
+#define MANEUVER_BACKING   1   /* Backing up                              */
+#define MANEUVER_TURNING   2   /* Turning away from the side that was hit */
+
+// Speeds and times of the maneuver
+typedef struct ManeuverConfig{
+    uint16_t backwardsSpeed;   // Duty cycle backing up
+    uint16_t turningSpeed;     // Duty cycle turning
+    uint16_t backwardsTime;    // ms backing up, from the bump
+    uint16_t turningTime;      // ms turning
+    uint16_t frontExtraTime;   // Extra ms turning left when the front was hit
+} ManeuverConfig;
+
+
+// --------------------- Function Prototypes ---------------------
+void Maneuver_Init(const ManeuverConfig* config);
+uint32_t Maneuver_Update(void);
+
+#endif
@@ -0,0 +1,97 @@
+#include <stdint.h>
+#include "Wall.h"
+
+
+static int32_t WallHistory[WALL_HISTORY];   // Last distances, oldest at WallI
+static uint32_t WallI;
+static uint8_t WallLost;                    // 1 while the side wall is out of range
+static uint32_t WallLostSamples;            // Samples since the side wall went out of range
+
+
+// ---------- Wall_Init ----------
+// Forgets the history, as if the wall was last at WALL_TARGET_MM
+// Inputs: none
+// Output: none
+void Wall_Init(void){
+    uint32_t i;
+
+    for(i = 0; i < WALL_HISTORY; i++){
+        WallHistory[i] = WALL_TARGET_MM;
+    }
+    WallI = 0;
+    WallLost = 0;
+    WallLostSamples = 0;
+}
+
+
+// ---------- Wall_Estimate ----------
+// Distance from the side wall and its rate, from one side sensor reading. The
+// history starts over when the wall comes back in range, so the jump back from
+// out of range is not taken for the robot heading towards the wall.
+// Inputs: uint32_t sideDist - side sensor reading (mm along its beam)
+//         int32_t* distance - set to the distance from the wall (mm from the sensor)
+//         int32_t* rate - set to the change in distance over WALL_HISTORY samples
+//                         (mm, positive heading away from the wall)
+// Output: uint32_t - WALL_ON, or WALL_CORNER_OUT with the wall out of range
+uint32_t Wall_Estimate(uint32_t sideDist, int32_t* distance, int32_t* rate){
+    uint32_t i;
+
+    *distance = ((int32_t)sideDist * WALL_SIDE_SCALE) >> 8;
+    if(*distance > WALL_LOST_MM){
+        WallLost = 1;
+        *rate = 0;
+        return WALL_CORNER_OUT;
+    }
+    if(WallLost){
+        for(i = 0; i < WALL_HISTORY; i++){
+            WallHistory[i] = *distance;
+        }
+        WallLost = 0;
+    }
+    *rate = *distance - WallHistory[WallI];
+    WallHistory[WallI] = *distance;
+    WallI = (WallI + 1) & (WALL_HISTORY - 1);
+    return WALL_ON;
+}
+
+
+// ---------- Wall_Follow ----------
+// PD steering for one sample: the wheel on the side of the wall slows down and
+// the other speeds up, both staying forward. Call once per sample, the rate is
+// per WALL_HISTORY samples.
+// Inputs: uint32_t sideDist - side sensor reading (mm along its beam)
+//         uint32_t frontDist - center sensor reading (mm)
+//         uint16_t baseDuty - duty cycle of both wheels at WALL_TARGET_MM
+//         uint16_t* leftDuty, rightDuty - set to the duty cycles for Motor_Forward
+// Output: uint32_t - WALL_ON, WALL_CORNER_IN or WALL_CORNER_OUT
+uint32_t Wall_Follow(uint32_t sideDist, uint32_t frontDist, uint16_t baseDuty, uint16_t* leftDuty, uint16_t* rightDuty){
+    int32_t distance, rate, steer, left, right;
+    uint32_t status;
+
+    // Positive steers towards the wall
+    status = Wall_Estimate(sideDist, &distance, &rate);
+    if(status == WALL_CORNER_OUT){
+        // Curvature grows from straight to the arc, so the robot clears the end of the wall
+        if(WallLostSamples < WALL_ARC_SAMPLES){
+            WallLostSamples++;
+        }
+        steer = ((int32_t)baseDuty * WALL_ARC * (int32_t)WallLostSamples) / (256 * WALL_ARC_SAMPLES);
+    } else {
+        WallLostSamples = 0;
+        steer = (WALL_KP * (distance - WALL_TARGET_MM) + WALL_KD * rate) / WALL_GAIN_DIVISOR;
+    }
+    if(frontDist < WALL_FRONT_MM){
+        steer -= (WALL_KF * (WALL_FRONT_MM - (int32_t)frontDist)) / WALL_GAIN_DIVISOR;
+        status = WALL_CORNER_IN;
+    }
+
+    left = (int32_t)baseDuty - steer;
+    right = (int32_t)baseDuty + steer;
+    if(left < 0){left = 0;}
+    if(right < 0){right = 0;}
+    if(left > WALL_MAX_DUTY){left = WALL_MAX_DUTY;}
+    if(right > WALL_MAX_DUTY){right = WALL_MAX_DUTY;}
+    *leftDuty = left;
+    *rightDuty = right;
+    return status;
+}
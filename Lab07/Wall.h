@@ -0,0 +1,54 @@
+#ifndef WALL_H
+#define WALL_H
+
+#include <stdint.h>
+
+/*
+ * PD wall follower on the side and center distance sensors.
+ *
+ * The side sensor looks 45 degrees off the heading, so with the robot parallel
+ * to the wall its reading is sqrt(2) times the distance from the wall. Wall_Estimate
+ * scales it to that distance, in mm from the sensor, and takes how much it changed
+ * over the last WALL_HISTORY samples as the rate: at a steady speed the rate is
+ * proportional to the sine of the angle between the heading and the wall,
+ * positive when heading away from it. Taking the rate over a few samples rather
+ * than one keeps the sensor noise out of the derivative.
+ *
+ * Wall_Follow runs the PD law on the distance and the rate once per sample and
+ * gives the duty cycles for Motor_Forward. Corners are arcs rather than stops and
+ * spins: a wall ahead adds a turn away from the side wall that grows as it gets
+ * closer, and once the side wall ends the robot arcs around its end until it is
+ * back in range, the curvature growing over WALL_ARC_SAMPLES so the robot clears
+ * the end of the wall.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#define WALL_SIDE_SCALE       181   /* sin(45 degrees) * 256, side reading to wall distance       */
+#define WALL_HISTORY          4     /* Samples the rate is taken over (power of 2)                */
+#define WALL_TARGET_MM        120   /* Distance from the wall to hold (mm from the sensor)        */
+#define WALL_LOST_MM          300   /* Farther than this the wall has ended (mm)                  */
+#define WALL_FRONT_MM         320   /* Wall ahead closer than this starts the turn away (mm)      */
+
+// PD gains, as duty cycle times WALL_GAIN_DIVISOR
+#define WALL_KP               25000 /* Duty cycle per mm from WALL_TARGET_MM                      */
+#define WALL_KD               40000 /* Duty cycle per mm the distance changes over WALL_HISTORY   */
+#define WALL_KF               10000 /* Duty cycle per mm the wall ahead is inside WALL_FRONT_MM   */
+#define WALL_ARC              90    /* Steering around the end of a wall, per 256 of baseDuty     */
+#define WALL_ARC_SAMPLES      60    /* Samples the arc takes to reach WALL_ARC                    */
+#define WALL_GAIN_DIVISOR     256
+#define WALL_MAX_DUTY         14998 /* Largest duty cycle Motor_Forward takes                     */
+
+// Status of a sample
+#define WALL_ON          0   /* Following the side wall                                          */
+#define WALL_CORNER_IN   1   /* Turning away from a wall ahead                                   */
+#define WALL_CORNER_OUT  2   /* Side wall ended: arcing around its end                           */
+
+
+// --------------------- Function Prototypes ---------------------
+void Wall_Init(void);
+uint32_t Wall_Estimate(uint32_t sideDist, int32_t* distance, int32_t* rate);
+uint32_t Wall_Follow(uint32_t sideDist, uint32_t frontDist, uint16_t baseDuty, uint16_t* leftDuty, uint16_t* rightDuty);
+
+#endif
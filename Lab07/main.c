@@ -4,6 +4,8 @@
 #include "RobotLights.h"
 #include "Motor.h"
 #include "BumpInt.h"
+#include "Maneuver.h"
+#include "Wall.h"
 #include <math.h>
 
 
@@ -15,9 +17,13 @@
 #define CENTER_DISTANCE_SENSOR   'c'
 #define LEFT_DISTANCE_SENSOR     'l'
 
-// Bumper numbers for the front right and left bumpers
-#define FRONT_RIGHT_BUMPER    2
-#define FRONT_LEFT_BUMPER     3
+// Wall followers (FOLLOW_MODE)
+#define FOLLOW_FSM  0  /* Three fixed turns between MIN_DISTANCE and MAX_DISTANCE, stop and spin at corners */
+#define FOLLOW_PD   1  /* PD steering on the distance from the wall and its rate, arcs at corners (Wall.h) */
+
+#ifndef FOLLOW_MODE
+#define FOLLOW_MODE FOLLOW_PD  /* Host/WallSim.c builds both to compare them */
+#endif
 
 // Three states for the robot: driving (mostly) straight, turning left, and turning right
 #define NORMAL_STATE       0
@@ -37,6 +43,9 @@
 #define SLIGHT_TURN_FAST FORWARDS_SPEED
 #define SLIGHT_TURN_SLOW FORWARDS_SPEED / 2
 
+// Speed with the wall at WALL_TARGET_MM, FOLLOW_PD
+#define PD_SPEED 6000
+
 // Speeds for the left turn state
 #define TURN_LEFT_SPEED_FAST FORWARDS_SPEED
 #define TURN_LEFT_SPEED_SLOW FORWARDS_SPEED / 2
@@ -56,7 +65,9 @@
 
 typedef int state_t;
 
-void HandleCollision(uint8_t ISR_BumpData);
+// Collision maneuver, run by the main loop after a bump (the front turns for both spinning times)
+static const ManeuverConfig Avoid = {BACKWARDS_SPEED, SPINNING_SPEED, BACKWARDS_TIME, SPINNING_TIME, SPINNING_TIME};
+
 void computeDistances(uint32_t leftADC, uint32_t *leftDist, uint32_t centerADC, uint32_t *centerDist, uint32_t rightADC, uint32_t *rightDist);
 uint32_t computeDistance(uint32_t adcReading, char side);
 
@@ -73,7 +84,9 @@ void main(void){
 	ADC0_InitSWTriggerCh17_14_16();
 	MvtLED_Init();
 	Motor_Init();
-	BumpInt_Init(&HandleCollision);
+	BumpInt_Init();
+	Maneuver_Init(&Avoid);
+	Wall_Init();
 
 	// Move the robot forwards and turn on the front lights
 	Motor_Forward(FORWARDS_SPEED, FORWARDS_SPEED);
@@ -84,18 +97,30 @@ void main(void){
 	uint32_t leftADC, centerADC, rightADC;
 	uint32_t leftDist, centerDist, rightDist;
 
+#if FOLLOW_MODE == FOLLOW_FSM
 	// Containers for the state, and some of their variables
 	state_t state = NORMAL_STATE;
 	int stage;
 	int targetDist;
 	int prevDist;
+#else
+	// Containers for the duty cycles from the wall follower
+	uint16_t leftDuty, rightDuty;
+#endif
 
 	// Main Loop
 	while(1){
+	    // Back up and turn after a bump, the states wait until it is over
+	    if(Maneuver_Update()){
+	        Clock_Delay1ms(SAMPLE_TIME);
+	        continue;
+	    }
+
 	    // Get distances from each sensor
 	    ADC_In17_14_16(&leftADC, &centerADC, &rightADC);
 	    computeDistances(leftADC, &leftDist, centerADC, &centerDist, rightADC, &rightDist);
 
+#if FOLLOW_MODE == FOLLOW_FSM
 	    // Check which state to enter (if already in another state continue with that one)
 	    if( (rightDist > START_TURN_DISTANCE && state == NORMAL_STATE) || state == SPIN_LEFT_STATE ){
 	        // State for making a left turn
@@ -182,69 +207,17 @@ void main(void){
 	            }
 	        }
 	    }
+#else
+	    // Steer on the distance from the wall, turning smoothly at corners
+	    Wall_Follow(rightDist, centerDist, PD_SPEED, &leftDuty, &rightDuty);
+	    Motor_Forward(leftDuty, rightDuty);
+#endif
 
 	    // Wait for the sample time
 	    Clock_Delay1ms(SAMPLE_TIME);
 	}
 }
 
-// Handle Collision
-// Bumper Interrupt Service Routine
-// Input: The data from the bumpers
-void HandleCollision(uint8_t ISR_BumpData){
-    // Store the bumper data
-    uint8_t Bump_Data = ISR_BumpData;
-
-    // Containers
-    uint32_t left = 0;      // How many of the left bumpers were hit
-    uint32_t right = 0;     // How many of the right bumpers were hit
-    uint32_t hit_front = 0; // Were either of the front two bumpers hit?
-
-    int i;
-
-    // Check which bumpers were hit
-    for(i = 0; i < 6; i++){
-        // Check if the current bumper was hit
-        if( (Bump_Data & (0x01 << i)) == 0 ){
-            if(i < 3){ // Right Side
-                if(i == FRONT_RIGHT_BUMPER)
-                    hit_front = 1;
-                right++;
-            } else { // Left Side
-                if(i == FRONT_LEFT_BUMPER)
-                    hit_front = 1;
-                left++;
-            }
-        }
-    }
-
-    // Move the robot backwards
-    Motor_Backward(BACKWARDS_SPEED, BACKWARDS_SPEED);
-    Front_Lights_OFF();
-    Back_Lights_ON();
-    Clock_Delay1ms(BACKWARDS_TIME);
-    Back_Lights_OFF();
-
-    // Determined direction to turn the robot
-    if(hit_front > 0) {
-        // Turn left for an extended period of time
-        Motor_Left(SPINNING_SPEED, SPINNING_SPEED);
-        Clock_Delay1ms(SPINNING_TIME);
-    } else if(left >= right) {
-        // If left side was hit, turn right
-        Motor_Right(SPINNING_SPEED, SPINNING_SPEED);
-    } else {
-        // If the right side was hit, turn left
-        Motor_Left(SPINNING_SPEED, SPINNING_SPEED);
-    }
-
-    // Wait, then move the robot forwards
-    Clock_Delay1ms(SPINNING_TIME);
-    Motor_Forward(FORWARDS_SPEED, FORWARDS_SPEED);
-    Front_Lights_ON();
-}
-
-
 // Compute all distances from the center
 // Inputs: ADC values and pointers to store distances
 void computeDistances(uint32_t leftADC, uint32_t *leftDist, uint32_t centerADC,
@@ -80,10 +80,21 @@ uint32_t TimeOutErr;  // debugging counts of no response errors
 uint32_t NoSOFErr;    // debugging counts of no SOF errors
 
 #define APTIMEOUT 40000   // 10 ms
+
+// Baud rates AP_Init tries, fastest first. The SNP has no command to change
+// its UART rate, it runs at the rate its image was built with, so AP_Init
+// finds the rate by resetting the SNP and listening for its power up message
+// at each rate in turn. The last rate is the one TI ships the SNP with.
+#define APBAUDRATES 4
+const uint32_t APBaudRates[APBAUDRATES] = {921600, 460800, 230400, UART1_DEFAULTBAUD};
+uint32_t APBaud;        // rate found by AP_Init
 /* If you define APDEBUG then all LP-SNP traffic is displayed on UART0.
    If you do not define APDEBUG then no UART0 output is performed, and thus it runs faster.
+   AP_BENCHMARK builds (APBench.c) leave it undefined, so nothing they time waits for UART0.
  */
+#ifndef AP_BENCHMARK
 #define APDEBUG 1
+#endif
 //**debug macros**********
 #ifdef APDEBUG
 #define OutString(STRING) UART0_OutString(STRING)
@@ -96,6 +107,248 @@ uint32_t NoSOFErr;    // debugging counts of no SOF errors
 #define OutUHex2(NUM)
 #define OutChar(N)
 #endif
+/* If you also define APTRACE then the frames AP_BackgroundProcess sends and receives,
+   and the data of each notification, are displayed on UART0 as well. UART0 output
+   blocks, so with APTRACE AP_SendNotification must not be called from an ISR.
+ */
+//#define APTRACE
+#ifdef APTRACE
+#define TraceString(STRING) OutString(STRING)
+#define TraceUHex(NUM) OutUHex(NUM)
+#define TraceUHex2(NUM) OutUHex2(NUM)
+#define TraceChar(N) OutChar(N)
+#define TraceReceived(R) AP_EchoReceived(R)
+#else
+#define TraceString(STRING)
+#define TraceUHex(NUM)
+#define TraceUHex2(NUM)
+#define TraceChar(N)
+#define TraceReceived(R)
+#endif
+
+//*************event-driven SNP transfers**********
+// AP_BackgroundProcess runs the MRDY/SRDY handshake as a state machine, so
+// that no call waits for the SNP. The UART1 interrupts move the bytes, the
+// SRDY interrupt records when the SNP asks for a transfer, and each call
+// advances the transfer as far as it can without waiting.
+#define AP_IDLE        0  // MRDY high, nothing in progress
+#define AP_WAITSEND    1  // MRDY low, waiting for SRDY low to send a frame
+#define AP_SENDING     2  // frame queued in UART1, waiting for the last stop bit
+#define AP_RECEIVING   3  // MRDY low, collecting a frame from the SNP
+#define AP_WAITRELEASE 4  // MRDY high, waiting for SRDY high
+#define APBUSY         2  // frame not complete yet
+
+#define APQUEUESIZE    4        // frames waiting to be sent (power of 2)
+#define APNOTIFYQUEUED 2        // notifications waiting to be sent, leaves room for confirmations
+#define APOUTSTANDING  4        // requests waiting for a response
+#define APLATENCYTYPES 8        // message types with latency statistics
+#define APNOTYPE       0xFF     // no latency statistics for this frame
+#define APTICKSPERUS   3        // Timer32 ticks per us (48 MHz/16)
+#define APHANDSHAKETIMEOUT 30000   // 10 ms for SRDY to answer MRDY
+#define APFRAMETIMEOUT     30000   // 10 ms to receive a whole frame
+#define APBYTETIMEOUT      3000    // 1 ms for each byte AP_RecvMessage waits for
+#define APRESPONSETIMEOUT  300000  // 100 ms for the SNP to answer a request
+#define APEVENT_CONNECTED   0x0001  // SNP Event Indication: connection established
+#define APEVENT_TERMINATED  0x0002  // SNP Event Indication: connection terminated
+
+/**
+ * \brief frame waiting to be sent by AP_BackgroundProcess, staged in the UART1 TX FIFO
+ */
+typedef struct queuedFrame{
+  uint16_t size;               /**< bytes in the frame, SOF to FCS */
+  uint8_t cmd0,cmd1;           /**< command of the frame */
+  uint8_t response;            /**< 1 if the SNP answers this frame */
+  uint8_t type;                /**< latency statistics entry, or APNOTYPE */
+  uint32_t start;              /**< AP_Now when the exchange started */
+}queuedFrame_t;
+queuedFrame_t APQueue[APQUEUESIZE];
+uint32_t APQueueGetI, APQueueCount;
+
+/**
+ * \brief request waiting for a response from the SNP
+ */
+typedef struct outstanding{
+  uint8_t active;              /**< 1 while waiting for the response */
+  uint8_t cmd0,cmd1;           /**< command of the expected response */
+  uint8_t type;                /**< latency statistics entry, or APNOTYPE */
+  uint32_t start;              /**< AP_Now when the request was queued */
+}outstanding_t;
+outstanding_t APOutstanding[APOUTSTANDING];
+uint32_t APOutstandingCount;
+
+APLatency_t APLatency[APLATENCYTYPES];
+uint32_t APLatencyCount;
+
+uint32_t APState = AP_IDLE;
+uint32_t APStateTime;           // AP_Now when APState was entered
+uint32_t RecvCount,RecvSize,RecvSOFCount;
+uint8_t RecvFCS;
+uint32_t RecvStart;             // AP_Now when the SNP asked to send
+volatile uint32_t SRDYEvent;    // set by a falling edge on SRDY
+volatile uint32_t SRDYTime;     // AP_Now at the falling edge
+uint32_t NotifyQueued;          // notifications in APQueue
+uint32_t APConnected;           // 1 from the connection established event until it terminates
+uint8_t APBuildFCS;             // FCS of the frame being built
+uint32_t APBuildPrimask;        // interrupt state before AP_FrameBegin
+
+//------------AP_Now------------
+// Time from Timer32 1, started by AP_Init
+// Input: none
+// Output: ticks of 1/3 us, wraps every 23 minutes
+uint32_t AP_Now(void){
+  return ~TIMER32_1->VALUE;    // counts down from 0xFFFFFFFF
+}
+
+//------------SRDY_IRQHandler------------
+// Falling edge on SRDY, the SNP wants a transfer
+// only timestamps the edge for the latency statistics, AP_BackgroundProcess
+// still has to run to notice SRDY low and start the transfer
+void SRDY_IRQHandler(void){
+  AckSRDY();
+  SRDYTime = AP_Now();
+  SRDYEvent = 1;
+}
+
+//------------AP_LatencyType------------
+// Find or add the latency statistics entry of a message type
+// Input: cmd0, cmd1 of the request or indication
+// Output: index into APLatency, APNOTYPE if the table is full
+static uint8_t AP_LatencyType(uint8_t cmd0, uint8_t cmd1){ uint32_t i,primask;
+  primask = __get_PRIMASK();
+  __disable_irq();              // AP_SendNotification may add one from an ISR
+  for(i=0; i<APLatencyCount; i++){
+    if((APLatency[i].cmd0 == cmd0)&&(APLatency[i].cmd1 == cmd1)) break;
+  }
+  if(i == APLatencyCount){      // new type
+    if(i >= APLATENCYTYPES){
+      i = APNOTYPE;
+    }else{
+      APLatency[i].cmd0 = cmd0;
+      APLatency[i].cmd1 = cmd1;
+      APLatency[i].count = APLatency[i].timeouts = 0;
+      APLatency[i].minUs = 0xFFFFFFFF;
+      APLatency[i].maxUs = APLatency[i].totalUs = 0;
+      APLatencyCount++;
+    }
+  }
+  __set_PRIMASK(primask);
+  return i;
+}
+
+//------------AP_RecordLatency------------
+// Add one completed exchange to the statistics
+// Input: type index into APLatency (APNOTYPE to ignore)
+//        start, now times from AP_Now
+// Output: none
+static void AP_RecordLatency(uint8_t type, uint32_t start, uint32_t now){ uint32_t us;
+  if(type == APNOTYPE) return;
+  us = (now-start)/APTICKSPERUS;
+  APLatency[type].count++;
+  APLatency[type].totalUs += us;
+  if(us < APLatency[type].minUs) APLatency[type].minUs = us;
+  if(us > APLatency[type].maxUs) APLatency[type].maxUs = us;
+}
+
+//*************frame builder**********
+// Frames are built in place in the UART1 TX FIFO: the bytes are staged as
+// they are added, the FCS is accumulated on the way, and AP_BackgroundProcess
+// commits the frame once the SNP is ready. Interrupts are disabled from
+// AP_FrameBegin to AP_FrameEnd, so frames can be built from an ISR.
+
+//------------AP_FrameAdd8------------
+// Append one byte to the frame being built
+static void AP_FrameAdd8(uint8_t data){
+  APBuildFCS ^= data;
+  UART1_StagePut(data);
+}
+
+//------------AP_FrameAdd16------------
+// Append a 16-bit value, little endian as NPI fields are
+static void AP_FrameAdd16(uint16_t data){
+  AP_FrameAdd8(data&0xFF);
+  AP_FrameAdd8(data>>8);
+}
+
+//------------AP_FrameAddData------------
+// Append user data using its copy plan
+// Input: pt user data, size number of bytes, swap from AP_IsNumber
+// Output: none
+static void AP_FrameAddData(const uint8_t *pt, uint32_t size, uint8_t swap){ uint32_t j;
+  if(swap){
+    pt = pt+size-1;
+    for(j=0; j<size; j++) AP_FrameAdd8(*pt--);  // little endian to big endian
+  }else{
+    for(j=0; j<size; j++) AP_FrameAdd8(pt[j]);
+  }
+}
+
+//------------AP_FrameStart------------
+// Stage SOF, length, CMD0, CMD1, there must be room for the whole frame
+// Input: cmd0, cmd1 command, length number of payload bytes
+// Output: none
+static void AP_FrameStart(uint8_t cmd0, uint8_t cmd1, uint16_t length){
+  UART1_StagePut(SOF);
+  APBuildFCS = 0;
+  AP_FrameAdd16(length);
+  AP_FrameAdd8(cmd0);
+  AP_FrameAdd8(cmd1);
+}
+
+//------------AP_FrameBegin------------
+// Start a frame for AP_BackgroundProcess to send, disables interrupts
+// until AP_FrameEnd
+// Input: cmd0, cmd1 command, length number of payload bytes
+// Output: APOK if there is room, APFAIL if the queue or UART1 FIFO is full,
+//         or if APNOTIFYQUEUED notifications are waiting and this is one
+//         (interrupts are enabled again on APFAIL)
+static int AP_FrameBegin(uint8_t cmd0, uint8_t cmd1, uint16_t length){
+  APBuildPrimask = __get_PRIMASK();
+  __disable_irq();
+  if((APQueueCount >= APQUEUESIZE)||(UART1_StageFree() < length+6)||
+     ((cmd0 == 0x55)&&(cmd1 == 0x89)&&(NotifyQueued >= APNOTIFYQUEUED))){ // leave room for confirmations
+    __set_PRIMASK(APBuildPrimask);
+    return APFAIL;
+  }
+  AP_FrameStart(cmd0,cmd1,length);
+  return APOK;
+}
+
+//------------AP_FrameEnd------------
+// Append the FCS and queue the frame, enables interrupts again
+// Input: cmd0, cmd1, length as given to AP_FrameBegin
+//        response is 1 if the SNP answers the frame
+//        type index into APLatency, APNOTYPE for none
+//        start AP_Now when the exchange started
+// Output: none
+static void AP_FrameEnd(uint8_t cmd0, uint8_t cmd1, uint16_t length,
+  uint8_t response, uint8_t type, uint32_t start){ uint32_t i;
+  UART1_StagePut(APBuildFCS);
+  i = (APQueueGetI+APQueueCount)&(APQUEUESIZE-1);
+  APQueue[i].size = length+6;
+  APQueue[i].cmd0 = cmd0;
+  APQueue[i].cmd1 = cmd1;
+  APQueue[i].response = response;
+  APQueue[i].type = type;
+  APQueue[i].start = start;
+  APQueueCount++;
+  if((cmd0 == 0x55)&&(cmd1 == 0x89)){
+    NotifyQueued++;             // AP_CommitFrame takes it off
+  }
+  __set_PRIMASK(APBuildPrimask);
+}
+
+//------------AP_QueueConfirmation------------
+// Queue a 3-byte confirmation of an SNP indication
+// Input: cmd1 command of the indication
+//        start AP_Now when the indication arrived
+// Output: APOK if queued, APFAIL if the queue is full
+static int AP_QueueConfirmation(uint8_t cmd1, uint32_t start){
+  if(AP_FrameBegin(0x55,cmd1,3) == APFAIL) return APFAIL;
+  AP_FrameAdd8(0x00);           // Success
+  AP_FrameAdd16(0x0000);        // handle of connection always 0
+  AP_FrameEnd(0x55,cmd1,3,0,AP_LatencyType(0x55,cmd1),start);
+  return APOK;
+}
 
 //------------AP_Reset------------
 // reset the Bluetooth module
@@ -197,36 +450,6 @@ const uint8_t NPI_StartAdvertisement[] = {
   0x00,0x01,0x00,0x00,0x00,0xC5, // RFU
   0x02,           // Advertising will restart with connectable advertising when a connection is terminated
   0xBB};          // FCS (calculated by AP_SendMessageResponse)
-uint8_t NPI_ReadConfirmation[] = {   
-  SOF,0x08,0x00,  // length = 8 (7+data length, filled in dynamically)
-  0x55,0x87,      // SNP Characteristic Read Confirmation (0x87)
-  0x00,           // Success
-  0x00,0x00,      // handle of connection always 0
-  0x00,0x00,      // Handle of the characteristic value attribute being read (filled in dynamically
-  0x00,0x00,      // offset, ignored, assumes small chucks of data
-  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // actual data (filled in dynamically)
-  0x00};          // FCS (calculated by AP_SendMessageResponse)
-uint8_t NPI_WriteConfirmation[] = {   
-  SOF,0x03,0x00,  // length = 3
-  0x55,0x88,      // SNP Characteristic Write Confirmation
-  0x00,           // Success
-  0x00,0x00,      // handle of connection always 0
-  0xDE};          // FCS (calculated by AP_SendMessageResponse)
-uint8_t NPI_CCCDUpdatedConfirmation[] = {   
-  SOF,0x03,0x00,  // length = 3
-  0x55,0x8B,      // SNP CCCD Updated Confirmation (0x8B)
-  0x00,           // Success
-  0x00,0x00,      // handle of connection always 0
-  0xDD};          // FCS (calculated by AP_SendMessageResponse)
-uint8_t NPI_SendNotificationIndication[] = {   
-  SOF,0x07,0x00,  // length = 7 to 14 depending on data size
-  0x55,0x89,      // SNP Send Notification Indication (0x89))
-  0x00,0x00,      // handle of connection always 0
-  0x00,0x00,      // Handle of the characteristic value attribute to notify / indicate (filled in dynamically
-  0x00,           // RFU
-  0x01,           // Indication Request type
-  0x00,0,0,0,0,0,0,0, // 1 to 8 bytes of data filled in dynamically
-  0xDD};      // FCS (calculated by AP_SendMessageResponse)
 
 uint8_t NPI_AddCharValue[] = {   
   SOF,0x08,0x00,  // length = 8
@@ -251,9 +474,11 @@ uint8_t NPI_AddCharDescriptor[] = {
 // Initialize serial link and GPIO to Bluetooth module
 // see GPIO.c file for hardware connections 
 // reset the Bluetooth module and initialize connection
+// finds the baud rate of the SNP, fastest of APBaudRates first
 // Input: none
-// Output: APOK on success, APFAIL on timeout
-int AP_Init(void){int bwaiting;   int count = 0;
+// Output: APOK on success, APFAIL on timeout or if the SNP answers at
+//         none of APBaudRates
+int AP_Init(void){int bwaiting;   int count = 0; uint32_t rate;
   GPIO_Init(); // MRDY, SRDY, reset
 #ifdef APDEBUG
   if(UCA0CTLW0 != 0x00C0){
@@ -261,25 +486,38 @@ int AP_Init(void){int bwaiting;   int count = 0;
   }
   UART0_OutString("\n\rReset CC2650");
 #endif
-  UART1_Init();
+  TIMER32_1->CONTROL = 0;           // disable Timer32 1 during setup
+  TIMER32_1->LOAD = 0xFFFFFFFF;     // free running time base for AP_Now
+  TIMER32_1->CONTROL = 0x00000086;  // enable, free running, no interrupts, 48MHz/16, 32-bit
   fcserr = 0;     // number of packets with FCS errors
   TimeOutErr = 0; // debugging counts of no response error
   NoSOFErr =0 ;   // debugging counts of no SOF error
   bwaiting = 1; // waiting for reset
-  while(bwaiting){
+  rate = 0;
+  while(bwaiting && (rate < APBAUDRATES)){
+    UART1_Init(APBaudRates[rate]);  // empties the staged frames too
+    APQueueCount = APOutstandingCount = NotifyQueued = 0;
     AP_Reset();
     count = 0;  // should get SNP power up within 30 ms (duration is arbitrary and 'count' value is uncalibrated)
     while(count < 600000){
       if(AP_RecvStatus()){
-        AP_RecvMessage(RecvBuf,RECVSIZE);
-        if((RecvBuf[3]==0x55)&&(RecvBuf[4]==0x01)){
+        if((AP_RecvMessage(RecvBuf,RECVSIZE) == APOK)&&(RecvBuf[3]==0x55)&&(RecvBuf[4]==0x01)){
           count = 600000;
           bwaiting = 0; // success
         }
       }
       count = count + 1;
     }
+    if(bwaiting){
+      rate = rate+1;  // no power up message at this rate, try the next one
+    }
   } 
+  if(bwaiting){
+    APBaud = 0;
+    TimeOutErr++;  // no answer at any rate
+    return APFAIL;
+  }
+  APBaud = APBaudRates[rate];
   AP_SendMessageResponse((uint8_t*)HCI_EXT_ResetSystemCmd,RecvBuf,RECVSIZE); 
   count = 0;  // should get SNP power up within 120 ms (duration is arbitrary and 'count' value is uncalibrated)
   bwaiting = 1; // waiting for SNP power up
@@ -293,12 +531,23 @@ int AP_Init(void){int bwaiting;   int count = 0;
     }
     count = count + 1;
   } 
+  APState = AP_IDLE;     // AP_BackgroundProcess takes over from here
+  SRDYEvent = 0;
+  APConnected = 0;
+  GPIO_InitSRDYInterrupt();
   if(bwaiting){
     TimeOutErr++;  // no response error
     return APFAIL;
   }  
   return APOK;
 }
+//------------AP_GetBaud------------
+// Baud rate of the link to the SNP found by AP_Init
+// Input: none
+// Output: baud rate in bits/sec
+uint32_t AP_GetBaud(void){
+  return APBaud;
+}
 //***********AP_GetSize***************
 // returns the size of an NPI message
 // Inputs:  pointer to NPI message
@@ -348,6 +597,29 @@ void AP_EchoReceived(int response){ uint32_t size; int i;
 #define AP_EchoSendMessage(MESSAGE)
 #define AP_EchoReceived(R)
 #endif
+//------------AP_WriteFrame------------
+// Stage an NPI frame in UART1 and send it, the FCS is calculated while
+// the bytes are staged, the array itself is not changed
+// Input: pointer to NPI encoded array
+// Output: APOK on success, APFAIL if frames are waiting in APQueue
+static int AP_WriteFrame(const uint8_t *pt){
+  uint32_t size,i,primask;
+  size = AP_GetSize((uint8_t*)pt);
+  primask = __get_PRIMASK();
+  __disable_irq();              // an ISR may build a frame
+  if(APQueueCount||(UART1_StageFree() < size+6)){
+    __set_PRIMASK(primask);
+    return APFAIL;              // staged frames would go out first
+  }
+  AP_FrameStart(pt[3],pt[4],size);
+  for(i=5; i<size+5; i++){
+    AP_FrameAdd8(pt[i]);        // payload
+  }
+  UART1_StagePut(APBuildFCS);   // FCS
+  __set_PRIMASK(primask);
+  UART1_Commit(size+6);
+  return APOK;
+}
 //------------AP_SendMessage------------
 // sends a message to the Bluetooth module
 // calculates/sends FCS at end 
@@ -357,7 +629,7 @@ void AP_EchoReceived(int response){ uint32_t size; int i;
 // Input: pointer to NPI encoded array
 // Output: APOK on success, APFAIL on timeout
 int AP_SendMessage(uint8_t *pt){
-  uint8_t fcs; uint32_t waitCount; uint8_t data; uint32_t size;
+  uint32_t waitCount;
 // 1) Make MRDY=0
   ClearMRDY();
 // 2) wait for SRDY to be low
@@ -370,19 +642,12 @@ int AP_SendMessage(uint8_t *pt){
     } 
   }
 // 3) Send NPI package
-  size = AP_GetSize(pt);
-  fcs=0;
-  UART1_OutChar(SOF); pt++;
-  data=*pt; UART1_OutChar(data); fcs=fcs^data; pt++;   // LSB length
-  data=*pt; UART1_OutChar(data); fcs=fcs^data; pt++;   // MSB length
-  data=*pt; UART1_OutChar(data); fcs=fcs^data; pt++;   // CMD0
-  data=*pt; UART1_OutChar(data); fcs=fcs^data; pt++;   // CMD1
-  for(int i=0;i<size;i++){
-    data=*pt; UART1_OutChar(data); fcs=fcs^data; pt++; // payload
+  if(AP_WriteFrame(pt) == APFAIL){
+    SetMRDY();      // MRDY=1
+    return APFAIL;
   }
-  UART1_OutChar(fcs);                                  // FCS
   
-// 4) Wait for entire message to be sent
+// 4) Wait for entire message to be sent, SNP requires MRDY low until the last byte
   UART1_FinishOutput();
 // 5) Make MRDY=1
   SetMRDY();        //   MRDY=1  
@@ -400,6 +665,30 @@ int AP_SendMessage(uint8_t *pt){
 
 
   
+//------------AP_InCharTimed------------
+// Wait for the next byte from the SNP, at most APBYTETIMEOUT
+// Input: data pointer to the byte received
+// Output: APOK if a byte came, APFAIL on timeout
+static int AP_InCharTimed(uint8_t *data){ uint32_t start = AP_Now();
+  while(UART1_InStatus() == 0){
+    if((AP_Now()-start) > APBYTETIMEOUT){
+      return APFAIL;
+    }
+  }
+  *data = UART1_InChar();
+  return APOK;
+}
+
+//------------AP_RecvTimedOut------------
+// End a frame that stopped coming
+// Input: none
+// Output: APFAIL
+static int AP_RecvTimedOut(void){
+  SetMRDY();         //   MRDY=1
+  TimeOutErr++;      // frame cut short
+  return APFAIL;
+}
+
 //------------AP_RecvMessage------------
 // receive a message from the Bluetooth module
 // 1) receive NPI package
@@ -407,6 +696,8 @@ int AP_SendMessage(uint8_t *pt){
 // Input: pointer to empty buffer into which data is returned
 //        maximum size (discard data beyond this limit)
 // Output: APOK if ok, APFAIL on error (timeout or fcs error)
+// each byte is waited for at most APBYTETIMEOUT, so a frame at the wrong
+// baud rate or cut short does not hang AP_Init
 int AP_RecvMessage(uint8_t *pt, uint32_t max){
   uint8_t fcs; uint32_t waitCount; uint8_t data,cmd0,cmd1; 
   uint8_t msb,lsb;
@@ -425,7 +716,7 @@ int AP_RecvMessage(uint8_t *pt, uint32_t max){
 // 3) receive NPI package
   // wait for SOF
   do{
-    data = UART1_InChar();
+    if(AP_InCharTimed(&data) == APFAIL) return AP_RecvTimedOut();
     SOFcount--;
     if(SOFcount==0){
       SetMRDY();     //   MRDY=1  
@@ -436,16 +727,20 @@ int AP_RecvMessage(uint8_t *pt, uint32_t max){
   *pt = data; pt++;
   fcs = 0;
 // get size, once we get SOF, it is highly likely for the rest to come
-  lsb = UART1_InChar(); *pt = lsb; fcs=fcs^lsb; pt++;
-  msb = UART1_InChar(); *pt = msb; fcs=fcs^msb; pt++;
+  if(AP_InCharTimed(&lsb) == APFAIL) return AP_RecvTimedOut();
+  *pt = lsb; fcs=fcs^lsb; pt++;
+  if(AP_InCharTimed(&msb) == APFAIL) return AP_RecvTimedOut();
+  *pt = msb; fcs=fcs^msb; pt++;
 // get command
-  cmd0 = UART1_InChar(); *pt = cmd0; fcs=fcs^cmd0; pt++;
-  cmd1 = UART1_InChar(); *pt = cmd1; fcs=fcs^cmd1; pt++;
+  if(AP_InCharTimed(&cmd0) == APFAIL) return AP_RecvTimedOut();
+  *pt = cmd0; fcs=fcs^cmd0; pt++;
+  if(AP_InCharTimed(&cmd1) == APFAIL) return AP_RecvTimedOut();
+  *pt = cmd1; fcs=fcs^cmd1; pt++;
   count = 5;
   size = (msb<<8)+lsb;
 // get payload
   for(int i=0;i<size;i++){
-    data = UART1_InChar(); 
+    if(AP_InCharTimed(&data) == APFAIL) return AP_RecvTimedOut();
     fcs = fcs^data; 
     count++;
     if(count <= max){
@@ -454,7 +749,7 @@ int AP_RecvMessage(uint8_t *pt, uint32_t max){
     }
   }
 // get FCB
-  data = UART1_InChar(); 
+  if(AP_InCharTimed(&data) == APFAIL) return AP_RecvTimedOut();
   count++;
   if(count <= max){
     *pt = data; 
@@ -470,6 +765,10 @@ int AP_RecvMessage(uint8_t *pt, uint32_t max){
   waitCount = 0;
   while(ReadSRDY()==0){
     waitCount++;
+    if(waitCount>APTIMEOUT){
+      TimeOutErr++;  // SNP did not release SRDY
+      return APFAIL;
+    }
   }
   return APOK;
 }
@@ -522,12 +821,13 @@ int AP_SendMessageResponse(uint8_t *msgPt, uint8_t *responsePt,uint32_t max){
  */
 typedef struct characteristics{
   uint16_t theHandle;          /**< each object has an ID */
-  uint16_t size;               /**< number of bytes in user data (1,2,4,8) */
-  uint8_t *pt;                 /**< pointer to user data, stored little endian */
+  uint16_t size;               /**< number of bytes in user data (1 to APMAXDATA) */
+  uint8_t swap;                /**< 1 if user data is a number, sent big endian */
+  uint8_t *pt;                 /**< pointer to user data, numbers stored little endian */
   void (*callBackRead)(void);  /**< action if SNP Characteristic Read Indication */
   void (*callBackWrite)(void); /**< action if SNP Characteristic Write Indication */
 }characteristic_t;
-#define MAXCHARACTERISTICS 10
+#define MAXCHARACTERISTICS APMAXCHARACTERISTICS
 uint32_t CharacteristicCount=0;
 characteristic_t CharacteristicList[MAXCHARACTERISTICS];
 /**
@@ -538,14 +838,60 @@ typedef struct NotifyCharacteristics{
   uint16_t theHandle;          /**< each object has an ID (used to notify) */
   uint16_t CCCDhandle;         /**< generated/assigned by SNP */
   uint16_t CCCDvalue;          /**< sent by phone to this object */
-  uint16_t size;               /**</ number of bytes in user data (1,2,4,8) */
-  uint8_t *pt;                 /**< pointer to user data array, stored little endian */
+  uint16_t size;               /**< number of bytes in user data (1 to APMAXDATA) */
+  uint16_t maxSize;            /**< size when the characteristic was added */
+  uint8_t swap;                /**< 1 if user data is a number, sent big endian */
+  uint8_t *pt;                 /**< pointer to user data, numbers stored little endian */
   void (*callBackCCCD)(void);  /**< action if SNP CCCD Updated Indication */
 }NotifyCharacteristic_t;
-#define NOTIFYMAXCHARACTERISTICS 4
+#define NOTIFYMAXCHARACTERISTICS APMAXNOTIFY
 uint32_t NotifyCharacteristicCount=0;
 NotifyCharacteristic_t NotifyCharacteristicList[NOTIFYMAXCHARACTERISTICS];
 
+// Handle table built by AP_RegisterService, so AP_BackgroundProcess finds the
+// characteristic of an indication with one lookup. The SNP hands out the
+// handles of a service in sequence, so they fit in a small window.
+#define APHANDLES 128           // handles covered by the table
+#define APHANDLECCCD 0x80       // entry is the CCCD of notify characteristic (entry&0x7F)
+uint16_t APHandleBase;          // smallest handle in the table
+uint8_t APHandleTable[APHANDLES]; // 0 for none, index+1 of a characteristic, or APHANDLECCCD+index
+
+//------------AP_IsNumber------------
+// Copy plan of user data: numbers are stored little endian and sent big
+// endian, other sizes are byte arrays sent in order
+// Input: size number of bytes in user data
+// Output: 1 if the bytes are swapped, 0 if not
+static uint8_t AP_IsNumber(uint32_t size){
+  return (size==2)||(size==4)||(size==8);
+}
+
+//------------AP_CopyIn------------
+// Copy data from the SNP into user data, filling missing bytes with 0
+// Input: pt user data, size number of bytes, swap from AP_IsNumber
+//        src data in the frame, count number of bytes received
+// Output: none
+static void AP_CopyIn(uint8_t *pt, uint32_t size, uint8_t swap, const uint8_t *src, uint32_t count){ uint32_t j;
+  if(count>size) count = size;     // truncate to size
+  for(j=count; j<size; j++){       // if message is smaller than size
+    pt[j] = 0;                     // fill MSbytes (numbers) or the end (arrays) with 0
+  }
+  if(swap){
+    for(j=0; j<count; j++) pt[count-j-1] = src[j];  // big endian to little endian
+  }else{
+    for(j=0; j<count; j++) pt[j] = src[j];
+  }
+}
+
+//------------AP_LookupHandle------------
+// Find the characteristic of a handle
+// Input: h handle from the SNP
+// Output: entry of APHandleTable, 0 if the handle is unknown
+static uint8_t AP_LookupHandle(uint16_t h){ uint16_t i;
+  i = h-APHandleBase;
+  if(i >= APHANDLES) return 0;
+  return APHandleTable[i];
+}
+
 
 //*********AP_GetNotifyCCCD*******
 // Return notification CCCD from the communication interface
@@ -572,14 +918,44 @@ int AP_AddService(uint16_t uuid){ int r;
   return r;
 }
 
+//------------AP_BuildHandleTable------------
+// Fill APHandleTable from the characteristic lists
+// Input: none
+// Output: APOK if successful, APFAIL if a handle is outside the table
+static int AP_BuildHandleTable(void){ uint32_t i; uint16_t h;
+  APHandleBase = 0xFFFF;
+  for(i=0; i<CharacteristicCount; i++){
+    if(CharacteristicList[i].theHandle < APHandleBase) APHandleBase = CharacteristicList[i].theHandle;
+  }
+  for(i=0; i<NotifyCharacteristicCount; i++){
+    if(NotifyCharacteristicList[i].CCCDhandle < APHandleBase) APHandleBase = NotifyCharacteristicList[i].CCCDhandle;
+  }
+  for(i=0; i<APHANDLES; i++){
+    APHandleTable[i] = 0;
+  }
+  for(i=0; i<CharacteristicCount; i++){
+    h = CharacteristicList[i].theHandle-APHandleBase;
+    if(h >= APHANDLES) return APFAIL;
+    APHandleTable[h] = i+1;
+  }
+  for(i=0; i<NotifyCharacteristicCount; i++){
+    h = NotifyCharacteristicList[i].CCCDhandle-APHandleBase;
+    if(h >= APHANDLES) return APFAIL;
+    APHandleTable[h] = APHANDLECCCD+i;
+  }
+  return APOK;
+}
+
 //*************AP_RegisterService**************
 // Register a service
+// builds the handle table, so call it after adding all characteristics
 // Inputs none
 // Output APOK if successful,
-//        APFAIL if SNP failure
+//        APFAIL if SNP failure or if the handles are too far apart
 int AP_RegisterService(void){ int r;
   OutString("\n\rRegister service");
   r = AP_SendMessageResponse((uint8_t*)NPI_Register,RecvBuf,RECVSIZE);
+  if(AP_BuildHandleTable() == APFAIL) return APFAIL;
   return r;
 }
 
@@ -587,19 +963,20 @@ int AP_RegisterService(void){ int r;
 // Add a read, write, or read/write characteristic
 //        for notify properties, call AP_AddNotifyCharacteristic 
 // Inputs uuid is 0xFFF0, 0xFFF1, ...
-//        thesize is the number of bytes in the user data 1,2,4, or 8 
-//        pt is a pointer to the user data, stored little endian
+//        thesize is the number of bytes in the user data 1 to APMAXDATA
+//        pt is a pointer to the user data, numbers (1,2,4, or 8 bytes) stored little endian,
+//           other sizes are byte arrays
 //        permission is GATT Permission, 0=none,1=read,2=write, 3=Read+write 
 //        properties is GATT Properties, 2=read,8=write,0x0A=read+write
 //        name is a null-terminated string, maximum length of name is 20 bytes
-//        (*ReadFunc) called before it responses with data from internal structure
-//        (*WriteFunc) called after it accepts data into internal structure
+//        (*ReadFunc) called before it responses with data from internal structure, 0 for none
+//        (*WriteFunc) called after it accepts data into internal structure, 0 for none
 // Output APOK if successful,
-//        APFAIL if name is empty, more than 8 characteristics, or if SNP failure
+//        APFAIL if name is empty, more than APMAXCHARACTERISTICS characteristics, or if SNP failure
 int AP_AddCharacteristic(uint16_t uuid, uint16_t thesize, void *pt, uint8_t permission,
   uint8_t properties, char name[], void(*ReadFunc)(void), void(*WriteFunc)(void)){
   int r; uint16_t handle; int i;
-  if(thesize>8) return APFAIL;
+  if((thesize==0)||(thesize>APMAXDATA)) return APFAIL;
   if(CharacteristicCount>=MAXCHARACTERISTICS) return APFAIL; // error
   NPI_AddCharValue[3] = 0x35;   // SNP Add Characteristic Value Declaration
   NPI_AddCharValue[4] = 0x82;  
@@ -629,6 +1006,7 @@ int AP_AddCharacteristic(uint16_t uuid, uint16_t thesize, void *pt, uint8_t perm
   if(r == APFAIL) return APFAIL;
   CharacteristicList[CharacteristicCount].theHandle = handle;
   CharacteristicList[CharacteristicCount].size = thesize;
+  CharacteristicList[CharacteristicCount].swap = AP_IsNumber(thesize);
   CharacteristicList[CharacteristicCount].pt = (uint8_t *) pt;
   CharacteristicList[CharacteristicCount].callBackRead = ReadFunc;
   CharacteristicList[CharacteristicCount].callBackWrite = WriteFunc;
@@ -640,16 +1018,17 @@ int AP_AddCharacteristic(uint16_t uuid, uint16_t thesize, void *pt, uint8_t perm
 // Add a notify characteristic
 //        for read, write, or read/write characteristic, call AP_AddCharacteristic 
 // Inputs uuid is 0xFFF0, 0xFFF1, ...
-//        thesize is the number of bytes in the user data 1,2,4, or 8 
-//        pt is a pointer to the user data, stored little endian
+//        thesize is the number of bytes in the user data 1 to APMAXDATA
+//        pt is a pointer to the user data, numbers (1,2,4, or 8 bytes) stored little endian,
+//           other sizes are byte arrays
 //        name is a null-terminated string, maximum length of name is 20 bytes
-//        (*CCCDfunc) called after it accepts , changing CCCDvalue
+//        (*CCCDfunc) called after it accepts , changing CCCDvalue, 0 for none
 // Output APOK if successful,
-//        APFAIL if name is empty, more than 4 notify characteristics, or if SNP failure
+//        APFAIL if name is empty, more than APMAXNOTIFY notify characteristics, or if SNP failure
 int AP_AddNotifyCharacteristic(uint16_t uuid, uint16_t thesize, void *pt,   
   char name[], void(*CCCDfunc)(void)){
   int r; uint16_t handle; int i;
-  if(thesize>8) return APFAIL;
+  if((thesize==0)||(thesize>APMAXDATA)) return APFAIL;
   if(NotifyCharacteristicCount>=NOTIFYMAXCHARACTERISTICS) return APFAIL; // error
   NPI_AddCharValue[3] = 0x35;   // SNP Add Characteristic Value Declaration
   NPI_AddCharValue[4] = 0x82;  
@@ -682,38 +1061,69 @@ int AP_AddNotifyCharacteristic(uint16_t uuid, uint16_t thesize, void *pt,
   NotifyCharacteristicList[NotifyCharacteristicCount].CCCDhandle = (RecvBuf[8]<<8)+RecvBuf[7]; // handle for this CCCD
   NotifyCharacteristicList[NotifyCharacteristicCount].CCCDvalue = 0; // notify initially off
   NotifyCharacteristicList[NotifyCharacteristicCount].size = thesize;
+  NotifyCharacteristicList[NotifyCharacteristicCount].maxSize = thesize;
+  NotifyCharacteristicList[NotifyCharacteristicCount].swap = AP_IsNumber(thesize);
   NotifyCharacteristicList[NotifyCharacteristicCount].pt = (uint8_t *) pt;
   NotifyCharacteristicList[NotifyCharacteristicCount].callBackCCCD = CCCDfunc;
   NotifyCharacteristicCount++;
   return APOK; // OK
 }
   
+//*************AP_SetNotifySize**************
+// Change the number of bytes a notify characteristic sends
+// the copy plan stays the one chosen by AP_AddNotifyCharacteristic, so
+// register a variable length characteristic with its largest size
+// Inputs: i index into notify characteristic
+//         thesize new number of bytes, 1 to the registered size
+// Output: APOK if successful, APFAIL if not valid
+int AP_SetNotifySize(uint32_t i, uint16_t thesize){
+  if(i>= NotifyCharacteristicCount) return APFAIL;   // not valid
+  if((thesize==0)||(thesize>NotifyCharacteristicList[i].maxSize)) return APFAIL;
+  NotifyCharacteristicList[i].size = thesize;
+  return APOK;
+}
+
+#ifdef APTRACE
+//------------AP_TraceNotification------------
+// For debugging, sends the data of a notification to UART0
+// Input: n notify characteristic
+// Output: none
+static void AP_TraceNotification(NotifyCharacteristic_t *n){ uint32_t j; uint32_t s=n->size;
+  TraceString("\n\rSend data=");
+  for(j=0; j<s; j++){
+    TraceUHex(n->swap? n->pt[s-j-1] : n->pt[j]); TraceString(", ");  // in the order sent
+  }
+}
+#else
+#define AP_TraceNotification(N)
+#endif
+
 //*************AP_SendNotification**************
 // Send a notification (will skip if CCCD is 0) 
+// non-blocking, the frame is built in the UART1 TX FIFO and
+// AP_BackgroundProcess sends it and times the response, can be called from an ISR
+// (unless APTRACE is defined)
 // Input:  index into notify characteristic to send
 // Output: APOK if successful,
-//         APFAIL if notification not configured, or if SNP failure
-int AP_SendNotification(uint32_t i){ uint16_t handle; uint32_t j;uint8_t thedata;
-  int r1; uint32_t s;
+//         APFAIL if notification not configured, or if two notifications
+//         are still waiting to be sent
+int AP_SendNotification(uint32_t i){ uint16_t handle;
+  uint32_t s; NotifyCharacteristic_t *n;
   if(i>= NotifyCharacteristicCount) return APFAIL;   // not valid
-  if(NotifyCharacteristicList[i].CCCDvalue){         // send only if active
-    handle = NotifyCharacteristicList[i].theHandle;
-    if(handle == 0) return APFAIL; // not open   
-    NPI_SendNotificationIndication[1] = 6+NotifyCharacteristicList[i].size;      // 1 to 8 bytes 
-    OutString("\n\rSend data=");
-    s = NotifyCharacteristicList[i].size;
-    for(j=0; j<s; j++){
-      thedata = NotifyCharacteristicList[i].pt[s-j-1]; // fetch data from user little endian to SNP big endian
-      OutUHex(thedata); OutString(", ");      
-      NPI_SendNotificationIndication[11+j] = thedata;    // copy into message, big endian
-    }
-    NPI_SendNotificationIndication[7] = handle&0x0FF; // handle
-    NPI_SendNotificationIndication[8] = handle>>8; 
-    r1=AP_SendMessageResponse(NPI_SendNotificationIndication,RecvBuf,RECVSIZE);
-  }else{
-    r1 = APOK; // no need to notify
-  }
-  return r1; // OK or fail depending on SendNotificationIndication
+  n = &NotifyCharacteristicList[i];
+  if(n->CCCDvalue == 0) return APOK;                 // no need to notify
+  handle = n->theHandle;
+  if(handle == 0) return APFAIL; // not open   
+  s = n->size;
+  AP_TraceNotification(n);
+  if(AP_FrameBegin(0x55,0x89,6+s) == APFAIL) return APFAIL; // SNP Send Notification Indication (0x89)
+  AP_FrameAdd16(0x0000);        // handle of connection always 0
+  AP_FrameAdd16(handle);        // handle of the characteristic value attribute to notify
+  AP_FrameAdd8(0x00);           // RFU
+  AP_FrameAdd8(0x01);           // Indication Request type
+  AP_FrameAddData(n->pt,s,n->swap); // 1 to APMAXDATA bytes, numbers big endian
+  AP_FrameEnd(0x55,0x89,6+s,1,AP_LatencyType(0x55,0x89),AP_Now());
+  return APOK;
 }
 //*************AP_StartAdvertisement**************
 // Start advertisement
@@ -765,83 +1175,336 @@ uint32_t AP_GetVersion(void){volatile int r;
   r = AP_SendMessageResponse((uint8_t*)NPI_GetVersion,RecvBuf,RECVSIZE); 
   return (RecvBuf[5]<<8)+(RecvBuf[6]);
 }
+//------------AP_SetState------------
+static void AP_SetState(uint32_t state, uint32_t now){
+  APState = state;
+  APStateTime = now;
+}
+
+//------------AP_CommitFrame------------
+// Send the frame at the head of the queue, staged in UART1 by AP_FrameBegin
+// Input: none
+// Output: none
+static void AP_CommitFrame(void){ uint32_t primask;
+  queuedFrame_t *frame = &APQueue[APQueueGetI];
+  if((frame->cmd0 == 0x55)&&(frame->cmd1 == 0x89)){
+    primask = __get_PRIMASK();
+    __disable_irq();
+    NotifyQueued--;             // room for another notification
+    __set_PRIMASK(primask);
+  }
+  UART1_Commit(frame->size);
+  TraceString("\n\rLP->SNP ");  // frame is in UART1, show its header
+  TraceUHex2(frame->cmd0); TraceChar(','); TraceUHex2(frame->cmd1); TraceChar(',');
+  TraceUHex2(frame->size);
+}
+
+//------------AP_SendDone------------
+// The frame at the head of the queue has left the UART
+// Input: now time from AP_Now
+// Output: none
+static void AP_SendDone(uint32_t now){ uint32_t i,primask;
+  queuedFrame_t *frame = &APQueue[APQueueGetI];
+  if(frame->response){
+    for(i=0; i<APOUTSTANDING; i++){
+      if(APOutstanding[i].active == 0){
+        APOutstanding[i].active = 1;
+        APOutstanding[i].cmd0 = (frame->cmd0==0x35)? 0x75 : frame->cmd0; // SREQ answered by SRSP
+        APOutstanding[i].cmd1 = frame->cmd1;
+        APOutstanding[i].type = frame->type;
+        APOutstanding[i].start = frame->start;
+        APOutstandingCount++;
+        break;
+      }
+    }
+  }else{
+    AP_RecordLatency(frame->type, frame->start, now); // indication confirmed
+  }
+  primask = __get_PRIMASK();
+  __disable_irq();              // AP_SendNotification may queue from an ISR
+  APQueueGetI = (APQueueGetI+1)&(APQUEUESIZE-1);
+  APQueueCount--;
+  __set_PRIMASK(primask);
+}
+
+//------------AP_CheckTimeouts------------
+// Give up on requests the SNP has not answered
+// Input: now time from AP_Now
+// Output: none
+static void AP_CheckTimeouts(uint32_t now){ uint32_t i;
+  for(i=0; i<APOUTSTANDING; i++){
+    if(APOutstanding[i].active && ((now-APOutstanding[i].start) > APRESPONSETIMEOUT)){
+      APOutstanding[i].active = 0;
+      APOutstandingCount--;
+      if(APOutstanding[i].type != APNOTYPE){
+        APLatency[APOutstanding[i].type].timeouts++;
+      }
+      TimeOutErr++;
+    }
+  }
+}
+
+//------------AP_ReceiveBytes------------
+// Move the bytes UART1 has received into RecvBuf, non-blocking
+// Input: none
+// Output: APOK when a whole frame has arrived, APFAIL on FCS or no SOF error,
+//         APBUSY if more bytes are needed
+static int AP_ReceiveBytes(void){ uint8_t data;
+  while(UART1_InStatus()){
+    data = UART1_InChar();     // does not wait, the FIFO has data
+    if(RecvCount == 0){        // wait for SOF
+      if(data != SOF){
+        RecvSOFCount--;
+        if(RecvSOFCount == 0){
+          NoSOFErr++;          // no SOF error
+          return APFAIL;
+        }
+        continue;
+      }
+      RecvBuf[0] = data;
+      RecvCount = 1;
+      RecvFCS = 0;
+      continue;
+    }
+    if(RecvCount < RECVSIZE){
+      RecvBuf[RecvCount] = data; // discard data beyond RECVSIZE
+    }
+    RecvCount++;
+    if(RecvCount == 3){
+      RecvSize = (RecvBuf[2]<<8)+RecvBuf[1];
+    }else if((RecvCount > 3)&&(RecvCount == RecvSize+6)){ // FCS
+      if(data != RecvFCS){
+        fcserr++;
+        return APFAIL;
+      }
+      return APOK;
+    }
+    RecvFCS = RecvFCS^data;
+  }
+  return APBUSY;
+}
+
+//------------AP_HandleFrame------------
+// Process the frame in RecvBuf: match it to an outstanding request and
+// handle SNP indications, queueing their confirmations
+// Input: now time from AP_Now
+// Output: none
+static void AP_HandleFrame(uint32_t now){
+  int count; int i; uint8_t entry;
+  characteristic_t *c;
+  NotifyCharacteristic_t *n;
+  uint8_t responseNeeded;
+  uint16_t event;
+
+  TraceString("\n\rRecvMessage");
+  TraceReceived(APOK);
+  for(i=0; i<APOUTSTANDING; i++){
+    if(APOutstanding[i].active && (APOutstanding[i].cmd0 == RecvBuf[3]) && (APOutstanding[i].cmd1 == RecvBuf[4])){
+      APOutstanding[i].active = 0;
+      APOutstandingCount--;
+      AP_RecordLatency(APOutstanding[i].type, APOutstanding[i].start, now);
+      break;
+    }
+  }
+  if((RecvBuf[3]==0x55)&&(RecvBuf[4]==0x88)){// SNP Characteristic Write Indication (0x88)
+    entry = AP_LookupHandle((RecvBuf[8]<<8)+RecvBuf[7]); // handle for this characteristic
+    responseNeeded = RecvBuf[9];
+    if((entry > 0)&&(entry < APHANDLECCCD)){
+      c = &CharacteristicList[entry-1];
+      count = RecvBuf[1]-7;   // number of bytes in message
+      if(count>0){
+        AP_CopyIn(c->pt,c->size,c->swap,&RecvBuf[12],count);
+      }
+      if(c->callBackWrite) (*c->callBackWrite)(); // process Characteristic Write Indication
+    }
+    if(responseNeeded){
+      AP_QueueConfirmation(0x88,RecvStart); // SNP Characteristic Write Confirmation
+    }else{
+      AP_RecordLatency(AP_LatencyType(0x55,0x88),RecvStart,AP_Now());
+    }
+  }
+  if((RecvBuf[3]==0x55)&&(RecvBuf[4]==0x87)){// SNP Characteristic Read Indication (0x87)
+    entry = AP_LookupHandle((RecvBuf[8]<<8)+RecvBuf[7]); // handle for this characteristic
+    c = 0;
+    count = 0;                // unknown handle, confirm with no data
+    if((entry > 0)&&(entry < APHANDLECCCD)){
+      c = &CharacteristicList[entry-1];
+      if(c->callBackRead) (*c->callBackRead)(); // process Characteristic Read Indication
+      count = c->size;
+    }
+    if(AP_FrameBegin(0x55,0x87,7+count) == APOK){ // SNP Characteristic Read Confirmation (0x87)
+      AP_FrameAdd8(0x00);     // Success
+      AP_FrameAdd16(0x0000);  // handle of connection always 0
+      AP_FrameAdd8(RecvBuf[7]); // handle of the characteristic value attribute being read
+      AP_FrameAdd8(RecvBuf[8]);
+      AP_FrameAdd16(0x0000);  // offset, ignored, assumes small chucks of data
+      if(c) AP_FrameAddData(c->pt,c->size,c->swap);
+      AP_FrameEnd(0x55,0x87,7+count,0,AP_LatencyType(0x55,0x87),RecvStart);
+    }
+  }
+  if((RecvBuf[3]==0x55)&&(RecvBuf[4]==0x05)){// SNP Event Indication (0x05), no confirmation
+    event = (RecvBuf[6]<<8)+RecvBuf[5];
+    if(event&APEVENT_CONNECTED) APConnected = 1;
+    if(event&APEVENT_TERMINATED) APConnected = 0;
+  }
+  if((RecvBuf[3]==0x55)&&(RecvBuf[4]==0x8B)){// SNP CCCD Updated Indication (0x8B)
+    entry = AP_LookupHandle((RecvBuf[8]<<8)+RecvBuf[7]); // handle for this CCCD
+    responseNeeded = RecvBuf[9];
+    if(entry >= APHANDLECCCD){
+      n = &NotifyCharacteristicList[entry-APHANDLECCCD];
+      n->CCCDvalue = (RecvBuf[11]<<8)+RecvBuf[10];
+      if(n->callBackCCCD) n->callBackCCCD();
+    }
+    if(responseNeeded){
+      AP_QueueConfirmation(0x8B,RecvStart); // SNP CCCD Updated Confirmation
+    }else{
+      AP_RecordLatency(AP_LatencyType(0x55,0x8B),RecvStart,AP_Now());
+    }
+  }
+}
+
 // ****AP_BackgroundProcess****
-// handle incoming SNP frames
+// handle incoming SNP frames and send queued frames
+// advances the MRDY/SRDY handshake without waiting, so it can be called
+// from a control loop as often as needed
+// the states change on the SRDY level read with ReadSRDY, polled on every
+// call; SRDYEvent only supplies the time of the falling edge (RecvStart)
 // Inputs:  none
 // Outputs: none
 void AP_BackgroundProcess(void){
-  int count; uint16_t h; int i,j;
-  uint32_t s; // size of user data 1,2,4,8
-  uint32_t d; // difference between packet size and user data size
-  uint8_t responseNeeded;
+  uint32_t now,state,steps; int result;
 
-  if(AP_RecvStatus()){
-    if(AP_RecvMessage(RecvBuf,RECVSIZE)==APOK){
-      OutString("\n\rRecvMessage");
-      AP_EchoReceived(APOK);        
-      if((RecvBuf[3]==0x55)&&(RecvBuf[4]==0x88)){// SNP Characteristic Write Indication (0x88)
-        h = (RecvBuf[8]<<8)+RecvBuf[7]; // handle for this characteristic
-        responseNeeded = RecvBuf[9];
-        i = 0;
-        while(i<MAXCHARACTERISTICS){
-          if(CharacteristicList[i].theHandle == h){
-            count = RecvBuf[1]-7;   // number of bytes in message
-            s = CharacteristicList[i].size;
-            if(count>s)count=s;   // truncate to size
-            d = s-count;
-            for(j=0;j<s;j++){     // if message is smaller than size
-              CharacteristicList[i].pt[j] = 0; // fill MSbytes with 0
-            }
-            for(j=0;j<count;j++){ // write data
-              CharacteristicList[i].pt[s-j-1-d] = RecvBuf[12+j];
-            }
-            (*CharacteristicList[i].callBackWrite)(); // process Characteristic Write Indication
-            i = MAXCHARACTERISTICS;
-          }else{
-            i++;
-          }
-        }
-        if(responseNeeded){
-          AP_SendMessage(NPI_WriteConfirmation);
-          AP_EchoSendMessage(NPI_WriteConfirmation);
-        }
+  if((APState == AP_IDLE)&&(SRDYEvent == 0)&&(APQueueCount == 0)&&(APOutstandingCount == 0)&&ReadSRDY()){
+    return; // nothing to do
+  }
+  now = AP_Now();
+  AP_CheckTimeouts(now);
+  steps = 0;
+  do{ // keep going while the transfer moves on without waiting
+  state = APState;
+  switch(APState){
+    case AP_IDLE:
+      if(ReadSRDY() == 0){         // SNP has a frame for us
+        RecvStart = SRDYEvent? SRDYTime : now;
+        SRDYEvent = 0;
+        RecvCount = 0;
+        RecvSOFCount = 10;
+        ClearMRDY();               // MRDY=0
+        AP_SetState(AP_RECEIVING, now);
+      }else if(APQueueCount){
+        SRDYEvent = 0;             // the SNP answers MRDY with SRDY low
+        ClearMRDY();               // MRDY=0
+        AP_SetState(AP_WAITSEND, now);
+      }else{
+        SRDYEvent = 0;             // SRDY already back high
       }
-      if((RecvBuf[3]==0x55)&&(RecvBuf[4]==0x87)){// SNP Characteristic Read Indication (0x87)
-        h = (RecvBuf[8]<<8)+RecvBuf[7]; // handle for this characteristic
-        i = 0;
-        while(i<MAXCHARACTERISTICS){
-          if(CharacteristicList[i].theHandle == h){
-            (*CharacteristicList[i].callBackRead)(); // process Characteristic Read Indication
-            NPI_ReadConfirmation[1] = 7+CharacteristicList[i].size;
-            s = CharacteristicList[i].size;
-            for(j=0;j<s;j++){ // write data
-              NPI_ReadConfirmation[j+12]=CharacteristicList[i].pt[s-j-1];
-            }
-            i = MAXCHARACTERISTICS;
-          }else{
-            i++;
-          }
-        }
-        NPI_ReadConfirmation[8] = RecvBuf[7]; // handle
-        NPI_ReadConfirmation[9] = RecvBuf[8]; 
-        AP_SendMessage(NPI_ReadConfirmation);
-        AP_EchoSendMessage(NPI_ReadConfirmation);
+      break;
+    case AP_WAITSEND:
+      if(ReadSRDY() == 0){
+        AP_CommitFrame();
+        AP_SetState(AP_SENDING, now);
+      }else if((now-APStateTime) > APHANDSHAKETIMEOUT){
+        TimeOutErr++;              // no response error, try again later
+        SetMRDY();                 // MRDY=1
+        AP_SetState(AP_IDLE, now);
       }
-      if((RecvBuf[3]==0x55)&&(RecvBuf[4]==0x8B)){// SNP CCCD Updated Indication (0x8B)
-        h = (RecvBuf[8]<<8)+RecvBuf[7]; // handle for this characteristic
-        responseNeeded = RecvBuf[9];
-        for(i=0; i<NOTIFYMAXCHARACTERISTICS;i++){
-          if(NotifyCharacteristicList[i].CCCDhandle == h){  // to do
-            NotifyCharacteristicList[i].CCCDvalue = (RecvBuf[11]<<8)+RecvBuf[10];
-            NotifyCharacteristicList[i].callBackCCCD();
-          }
-        }
-        if(responseNeeded){
-          AP_SendMessage(NPI_CCCDUpdatedConfirmation);
-          AP_EchoSendMessage(NPI_CCCDUpdatedConfirmation);
+      break;
+    case AP_SENDING:
+      if(UART1_OutDone()){
+        SetMRDY();                 // MRDY=1
+        AP_SendDone(now);
+        AP_SetState(AP_WAITRELEASE, now);
+      }
+      break;
+    case AP_RECEIVING:
+      result = AP_ReceiveBytes();
+      if(result == APBUSY){
+        if((now-APStateTime) > APFRAMETIMEOUT){
+          TimeOutErr++;            // frame never finished
+          SetMRDY();               // MRDY=1
+          AP_SetState(AP_WAITRELEASE, now);
         }
-      }        
-    }
+        break;
+      }
+      SetMRDY();                   // MRDY=1
+      AP_SetState(AP_WAITRELEASE, now);
+      if(result == APOK){
+        AP_HandleFrame(now);
+      }
+      break;
+    case AP_WAITRELEASE:
+      if(ReadSRDY()){
+        AP_SetState(AP_IDLE, now);
+      }else if((now-APStateTime) > APHANDSHAKETIMEOUT){
+        TimeOutErr++;              // SRDY stuck low
+        AP_SetState(AP_IDLE, now);
+      }
+      break;
   }
+  steps++;
+  }while((APState != state)&&(steps < 5));
+}
+
+//*************AP_Idle**************
+// Check if AP_BackgroundProcess has nothing left to do
+// Input:  none
+// Output: 1 if no transfer is in progress, queued or waiting for a response
+uint32_t AP_Idle(void){
+  return ((APState == AP_IDLE)&&(APQueueCount == 0)&&(APOutstandingCount == 0));
+}
+
+//*************AP_Connected**************
+// Check if a phone is connected, from the SNP's connection events
+// handled by AP_BackgroundProcess, does not perform BLE communication
+// Input:  none
+// Output: 1 if connected, 0 if not
+uint32_t AP_Connected(void){
+  return APConnected;
+}
+
+//*************AP_ClearLatency**************
+// Start the latency statistics over, e.g. before a measurement
+// call while AP_Idle, so no queued frame refers to an old entry
+// Input:  none
+// Output: none
+void AP_ClearLatency(void){ uint32_t primask;
+  primask = __get_PRIMASK();
+  __disable_irq();
+  APLatencyCount = 0;
+  __set_PRIMASK(primask);
+}
+
+//*************AP_GetLatency**************
+// Get the latency statistics of one message type. Requests are timed from
+// when they are queued until the response is received, and SNP indications
+// from the SRDY falling edge until the confirmation is sent.
+// Input:  i index of the message type, 0 to (number of types)-1
+//         stats points to where the statistics are copied
+// Output: APOK if successful, APFAIL if there is no type i
+int AP_GetLatency(uint32_t i, APLatency_t *stats){
+  if(i >= APLatencyCount) return APFAIL;
+  *stats = APLatency[i];
+  return APOK;
 }
 
+#ifdef APDEBUG
+//*************AP_OutLatency**************
+// Send the latency statistics of every message type to UART0
+// Input:  none
+// Output: none
+void AP_OutLatency(void){ uint32_t i;
+  for(i=0; i<APLatencyCount; i++){
+    OutString("\n\rLatency "); OutUHex2(APLatency[i].cmd0); OutUHex2(APLatency[i].cmd1);
+    OutString(" n="); UART0_OutUDec(APLatency[i].count);
+    OutString(" timeouts="); UART0_OutUDec(APLatency[i].timeouts);
+    if(APLatency[i].count){
+      OutString(" min="); UART0_OutUDec(APLatency[i].minUs);
+      OutString(" mean="); UART0_OutUDec(APLatency[i].totalUs/APLatency[i].count);
+      OutString(" max="); UART0_OutUDec(APLatency[i].maxUs);
+      OutString(" us");
+    }
+  }
+}
+#else
+void AP_OutLatency(void){}
+#endif
@@ -166,14 +166,29 @@ policies, either expressed or implied, of the FreeBSD Project.
  * return parameters for success
  */
 #define APOK   1
+/**
+ * maximum number of bytes of user data in one characteristic,
+ * 20 bytes fill one 23-byte ATT packet
+ */
+#define APMAXDATA 20
+/**
+ * maximum number of read, write, or read/write characteristics
+ */
+#define APMAXCHARACTERISTICS 16
+/**
+ * maximum number of notify characteristics
+ */
+#define APMAXNOTIFY 8
 
 
 /**
  * Initialize serial link and GPIO to Bluetooth module.
  * See GPIO.h file for hardware connections.
  * Resets the Bluetooth module and initialize connection.
+ * Finds the baud rate the SNP image was built with, trying 921600,
+ * 460800, 230400 and 115200 bits/sec in turn.
  * @param  none
- * @return APOK on success, APFAIL on timeout
+ * @return APOK on success, APFAIL on timeout or if the SNP answers at none of these rates
  * @brief  Initialize serial link and GPIO to Bluetooth module
  */
 int AP_Init(void);
@@ -222,7 +237,7 @@ void AP_EchoSendMessage(uint8_t *sendMsg);
 /**
  * Receive a message from the Bluetooth module
  * 1) Receive NPI package<br>
- * 2) Wait for entire message to be received
+ * 2) Wait for entire message to be received, at most 1 ms for each byte
  * @param  pt pointer to empty buffer into which data is returned
  * @param  max maximum size (discard data beyond this limit)
  * @return APOK on success, APFAIL on timeout or fcs error
@@ -297,9 +312,11 @@ void AP_OutValue(char *label,uint32_t value);
 int AP_AddService(uint16_t uuid);
 
 /**
- * Register a service
+ * Register a service<br>
+ * Builds the handle table AP_BackgroundProcess uses to find a characteristic,
+ * so call it after adding all characteristics
  * @param none
- * @return APOK if successful, APFAIL if SNP failure
+ * @return APOK if successful, APFAIL if SNP failure or if the handles are too far apart
  * @brief Register Service
  */
 int AP_RegisterService(void);
@@ -308,14 +325,14 @@ int AP_RegisterService(void);
  * Add a read, write, or read/write characteristic
  * for notify properties, call AP_AddNotifyCharacteristic
  * @param uuid is 0xFFF0, 0xFFF1, ...
- * @param thesize is the number of bytes in the user data 1,2,4, or 8
- * @param pt is a pointer to the user data, stored little endian
+ * @param thesize is the number of bytes in the user data 1 to APMAXDATA
+ * @param pt is a pointer to the user data, numbers of 1,2,4, or 8 bytes stored little endian, other sizes are byte arrays
  * @param permission is GATT Permission, 0=none,1=read,2=write, 3=Read+write
  * @param properties is GATT Properties, 2=read,8=write,0x0A=read+write
  * @param name is a null-terminated string, maximum length of name is 20 bytes
- * @param ReadFunc is a function pointer, called before it responses with data from internal structure
- * @param WriteFunc is a function pointer, called after it accepts data into internal structure
- * @return APOK if successful, APFAIL if name is empty, more than 8 characteristics, or if SNP failure
+ * @param ReadFunc is a function pointer, called before it responses with data from internal structure (0 for none)
+ * @param WriteFunc is a function pointer, called after it accepts data into internal structure (0 for none)
+ * @return APOK if successful, APFAIL if name is empty, more than APMAXCHARACTERISTICS characteristics, or if SNP failure
  * @brief Add Characteristic
  */
 int AP_AddCharacteristic(uint16_t uuid, uint16_t thesize, void *pt, uint8_t permission,
@@ -325,20 +342,33 @@ int AP_AddCharacteristic(uint16_t uuid, uint16_t thesize, void *pt, uint8_t perm
  * Add a notify characteristic
  * for read, write, or read/write characteristic, call AP_AddCharacteristic
  * @param uuid is 0xFFF0, 0xFFF1, ...
- * @param thesize is the number of bytes in the user data 1,2,4, or 8
- * @param pt is a pointer to the user data, stored little endian
+ * @param thesize is the number of bytes in the user data 1 to APMAXDATA
+ * @param pt is a pointer to the user data, numbers of 1,2,4, or 8 bytes stored little endian, other sizes are byte arrays
  * @param name is a null-terminated string, maximum length of name is 20 bytes
- * @param CCCDfunc is a function pointer, called after it accepts , changing CCCDvalue
- * @return APOK if successful, APFAIL if name is empty, more than 4 notify characteristics, or if SNP failure
+ * @param CCCDfunc is a function pointer, called after it accepts , changing CCCDvalue (0 for none)
+ * @return APOK if successful, APFAIL if name is empty, more than APMAXNOTIFY notify characteristics, or if SNP failure
  * @brief Add Notify Characteristic
  */
 int AP_AddNotifyCharacteristic(uint16_t uuid, uint16_t thesize,  void *pt, 
   char name[], void(*CCCDfunc)(void));
   
 /**
- * Send a notification (will skip if CCCD is 0)
+ * Change the number of bytes a notify characteristic sends<br>
+ * The byte order stays the one chosen when it was added, so add a
+ * variable length characteristic with its largest size
+ * @param i index into notify characteristic
+ * @param thesize new number of bytes, 1 to the size it was added with
+ * @return APOK if successful, APFAIL if not valid
+ * @brief Set Notify Size
+ */
+int AP_SetNotifySize(uint32_t i, uint16_t thesize);
+
+/**
+ * Send a notification (will skip if CCCD is 0)<br>
+ * Non-blocking, the frame is built in the UART1 transmit FIFO and sent by AP_BackgroundProcess<br>
+ * Safe to call from an interrupt service routine, unless APTRACE is defined in AP.c
  * @param i index into notify characteristic to send
- * @return APOK if successful, APFAIL if notification not configured, or if SNP failure
+ * @return APOK if successful, APFAIL if notification not configured, or if two notifications are still waiting to be sent
  * @brief Send Notification
  */
 int AP_SendNotification(uint32_t i);
@@ -380,14 +410,94 @@ uint32_t AP_GetStatus(void);
 uint32_t AP_GetVersion(void);
 
 /**
- * handle incoming SNP frames
+ * handle incoming SNP frames and send queued frames<br>
+ * Runs the MRDY/SRDY handshake as a state machine and never waits for
+ * the SNP, each call does as much of the transfer as it can. The machine
+ * is polled: it reads the SRDY level on each call, and the SRDY interrupt
+ * only timestamps the falling edge, so nothing moves between calls
  * @param none
  * @return none
- * @note must run periodically
- * @brief handles receive communication
+ * @note must run periodically, after AP_Init
+ * @brief handles receive and transmit communication
  */
 void AP_BackgroundProcess(void);
 
+/**
+ * Check if AP_BackgroundProcess has nothing left to do
+ * @param none
+ * @return 1 if no transfer is in progress, queued or waiting for a response
+ * @brief Check if SNP communication is idle
+ */
+uint32_t AP_Idle(void);
+
+/**
+ * Check if a phone is connected<br>
+ * Follows the connection established and terminated events of the SNP,
+ * handled by AP_BackgroundProcess. Does not perform BLE communication
+ * @param none
+ * @return 1 if connected, 0 if not
+ * @brief Check if connected
+ */
+uint32_t AP_Connected(void);
+
+/**
+ * \brief latency statistics of one SNP message type
+ */
+typedef struct APLatency{
+  uint8_t cmd0;                /**< CMD0 of the request or indication */
+  uint8_t cmd1;                /**< CMD1 of the request or indication */
+  uint32_t count;              /**< completed exchanges */
+  uint32_t timeouts;           /**< requests the SNP never answered */
+  uint32_t minUs;              /**< shortest exchange (us) */
+  uint32_t maxUs;              /**< longest exchange (us) */
+  uint32_t totalUs;            /**< sum of all exchanges, for the mean (us) */
+}APLatency_t;
+
+/**
+ * Get the latency statistics of one message type. Requests are timed
+ * from when they are queued until the response arrives, SNP indications
+ * from the SRDY falling edge until the confirmation has been sent.
+ * @param i index of the message type, starting at 0
+ * @param stats points to where the statistics are copied
+ * @return APOK if successful, APFAIL if there is no type i
+ * @brief Get SNP message latency
+ */
+int AP_GetLatency(uint32_t i, APLatency_t *stats);
+
+/**
+ * Start the latency statistics over, e.g. before a measurement<br>
+ * Call while AP_Idle, so no queued frame refers to an old entry
+ * @param none
+ * @return none
+ * @brief Clear SNP message latency
+ */
+void AP_ClearLatency(void);
+
+/**
+ * Send the latency statistics of every message type to UART0
+ * (only if APDEBUG is defined in AP.c)
+ * @param none
+ * @return none
+ * @brief Print SNP message latency
+ */
+void AP_OutLatency(void);
+
+/**
+ * Time base of the SNP state machine, Timer32 1 started by AP_Init
+ * @param none
+ * @return time in ticks of 1/3 us
+ * @brief SNP time base
+ */
+uint32_t AP_Now(void);
+
+/**
+ * Baud rate of the link to the SNP found by AP_Init
+ * @param none
+ * @return baud rate in bits/sec, 0 if AP_Init found none
+ * @brief SNP baud rate
+ */
+uint32_t AP_GetBaud(void);
+
 /**
  * returns the size of an NPI message
  * @param pt pointer to NPI message
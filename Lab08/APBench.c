@@ -0,0 +1,81 @@
+#include <stdint.h>
+#include "AP.h"
+#include "UART0.h"
+#include "APBench.h"
+
+
+#define APBENCH_TICKS_PER_US 3          /* AP_Now ticks per us                  */
+
+// Rates printed in the wire time table
+static const uint32_t APBenchRates[] = {115200, 230400, 460800, 921600};
+#define APBENCH_RATES (sizeof(APBenchRates) / sizeof(APBenchRates[0]))
+
+
+// ---------- APBench_OutNumber ----------
+// Sends a comma and then n in decimal
+static void APBench_OutNumber(uint32_t n){
+    UART0_OutChar(',');
+    UART0_OutUDec(n);
+}
+
+
+// ---------- APBench_Run ----------
+// Sends count notifications as fast as the SNP takes them and prints the results
+// Inputs: uint32_t index - notify characteristic to send
+//         uint32_t size - bytes of user data in the notification
+//         uint32_t count - notifications to send (APBENCH_COUNT)
+// Output: none
+void APBench_Run(uint32_t index, uint32_t size, uint32_t count){
+    uint32_t r, bytes, sent, start, us, i;
+    APLatency_t stats;
+
+    // Wire time of one notification and its response at each rate, computed not measured
+    bytes = 12 + size + APBENCH_RESPONSE;   // SOF, length, command, FCS, handles, data
+    UART0_Init();                           // AP_Init only starts UART0 with APDEBUG
+    UART0_OutString("\n\r# apbench ");
+    UART0_OutUDec(AP_GetBaud());
+    UART0_OutString("\n\rcomputed,baud,bytes,us,per_second");
+    for(r = 0; r < APBENCH_RATES; r++){
+        us = (bytes * 10 * 1000000) / APBenchRates[r];   // 10 bits per byte
+        UART0_OutString("\n\rcomputed");
+        APBench_OutNumber(APBenchRates[r]);
+        APBench_OutNumber(bytes);
+        APBench_OutNumber(us);
+        APBench_OutNumber(1000000 / us);
+    }
+
+    // Wait for the phone to enable notifications and the link to settle
+    while((AP_GetNotifyCCCD(index) == 0) || !AP_Idle()){
+        AP_BackgroundProcess();
+    }
+    AP_ClearLatency();
+
+    sent = 0;
+    start = AP_Now();
+    while(sent < count){
+        if(AP_SendNotification(index) == APOK){
+            sent++;
+        }
+        AP_BackgroundProcess();
+    }
+    while(!AP_Idle()){
+        AP_BackgroundProcess();
+    }
+    us = (AP_Now() - start) / APBENCH_TICKS_PER_US;
+
+    UART0_OutString("\n\rmeasured,baud,bytes,count,ms,per_second,min_us,mean_us,max_us,timeouts");
+    UART0_OutString("\n\rmeasured");
+    APBench_OutNumber(AP_GetBaud());
+    APBench_OutNumber(bytes);
+    APBench_OutNumber(count);
+    APBench_OutNumber(us / 1000);
+    APBench_OutNumber((uint32_t)((uint64_t)count * 1000000 / us));
+    for(i = 0; AP_GetLatency(i, &stats) == APOK; i++){
+        if((stats.cmd0 == 0x55) && (stats.cmd1 == 0x89) && stats.count){
+            APBench_OutNumber(stats.minUs);
+            APBench_OutNumber(stats.totalUs / stats.count);
+            APBench_OutNumber(stats.maxUs);
+            APBench_OutNumber(stats.timeouts);
+        }
+    }
+}
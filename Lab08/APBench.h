@@ -0,0 +1,32 @@
+#ifndef APBENCH_H
+#define APBENCH_H
+
+#include <stdint.h>
+
+/*
+ * Throughput and latency of BLE notifications over the SNP link, sent to the PC
+ * over UART0 as CSV lines.
+ *
+ * The SNP runs at the baud rate its image was built with (AP_Init finds it), so
+ * each run measures one rate; flash SNP images built for other rates to compare
+ * them. Every run also prints the time the frames of one notification take on the
+ * wire at each rate, computed from the frame size rather than measured, the upper
+ * bound the handshake and the BLE connection interval eat into:
+ *     # apbench <baud>
+ *     computed,baud,bytes,us,per_second
+ *     measured,baud,bytes,count,ms,per_second,min_us,mean_us,max_us,timeouts
+ * A phone must be connected with notifications of the characteristic enabled.
+ * Build with AP_BENCHMARK predefined, so AP.c has no APDEBUG output on UART0.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#define APBENCH_COUNT     200   /* Notifications per measurement                  */
+#define APBENCH_RESPONSE  7     /* Bytes of the SNP response to a notification    */
+
+
+// --------------------- Function Prototypes ---------------------
+void APBench_Run(uint32_t index, uint32_t size, uint32_t count);
+
+#endif
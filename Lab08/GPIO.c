@@ -86,6 +86,18 @@ void GPIO_Init(void){
   P6->DS |= 0x80;     // 3) activate increased drive strength
   ClearReset();     // RESET=0    
 }
+
+//------------GPIO_InitSRDYInterrupt------------
+// Arm interrupts on the falling edge of SRDY, P2.5
+// Input: none
+// Output: none
+void GPIO_InitSRDYInterrupt(void){
+  P2->IES |= 0x20;    // falling edge event on P2.5
+  AckSRDY();          // clear flag5
+  P2->IE |= 0x20;     // arm interrupt on P2.5
+  NVIC->IP[9] = (NVIC->IP[9]&0xFFFFFF00)|0x00000040; // priority 2
+  NVIC->ISER[1] = 0x00000010; // enable interrupt 36 in NVIC
+}
 #else
 // These three options require either reprogramming the CC2650LP/CC2650BP or using a 7-wire tether
 // These three options allow the use of the MKII I/O boosterpack
@@ -150,4 +162,16 @@ void GPIO_Init(void){
   P6->DS |= 0x80;     // 3) activate increased drive strength
   ClearReset();     // RESET=0    
 }
+
+//------------GPIO_InitSRDYInterrupt------------
+// Arm interrupts on the falling edge of SRDY, P5.2
+// Input: none
+// Output: none
+void GPIO_InitSRDYInterrupt(void){
+  P5->IES |= 0x04;    // falling edge event on P5.2
+  AckSRDY();          // clear flag2
+  P5->IE |= 0x04;     // arm interrupt on P5.2
+  NVIC->IP[9] = (NVIC->IP[9]&0x00FFFFFF)|0x40000000; // priority 2
+  NVIC->ISER[1] = 0x00000080; // enable interrupt 39 in NVIC
+}
 #endif
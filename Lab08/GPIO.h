@@ -149,6 +149,8 @@ policies, either expressed or implied, of the FreeBSD Project.
 #define SetReset() (P6->OUT |= 0x80)      /**< Set Reset pin high */
 #define ClearReset() (P6->OUT &= ~0x80)   /**< Clear Reset pin low */
 #define ReadSRDY() (P2->IN&0x20)          /**< Read SRDY pin */
+#define AckSRDY() (P2->IFG &= ~0x20)      /**< Acknowledge SRDY falling edge */
+#define SRDY_IRQHandler PORT2_IRQHandler  /**< Interrupt on SRDY edges */
 #else
 // Options 1,2,3
 #define SetMRDY() (P1->OUT |= 0x80)       /**< Set MRDY pin high */
@@ -156,6 +158,8 @@ policies, either expressed or implied, of the FreeBSD Project.
 #define SetReset() (P6->OUT |= 0x80)      /**< Set Reset pin high */
 #define ClearReset() (P6->OUT &= ~0x80)   /**< Clear Reset pin low */
 #define ReadSRDY() (P5->IN&0x04)          /**< Read SRDY pin */
+#define AckSRDY() (P5->IFG &= ~0x04)      /**< Acknowledge SRDY falling edge */
+#define SRDY_IRQHandler PORT5_IRQHandler  /**< Interrupt on SRDY edges */
 #endif
 
 /**
@@ -165,3 +169,13 @@ policies, either expressed or implied, of the FreeBSD Project.
  * @brief  Initialize MRDY (out), SRDY (in), RESET (out) GPIO pins
  */
 void GPIO_Init(void);
+
+/**
+ * Arm interrupts on the falling edge of SRDY (the SNP lowers SRDY when
+ * it is ready for a transfer). The handler is SRDY_IRQHandler, which only
+ * timestamps the edge for AP's latency statistics.
+ * @param  none
+ * @return none
+ * @brief  Arm SRDY falling edge interrupt
+ */
+void GPIO_InitSRDYInterrupt(void);
@@ -0,0 +1,184 @@
+#include <stdint.h>
+#include "AP.h"
+#include "Telemetry.h"
+
+
+#define TELEMETRY_TICKS_PER_MS 3000       /* AP_Now ticks per ms                  */
+
+// Bytes of each field, in frame order
+static const uint8_t TelemetryFieldBytes[5] = {6, 6, 4, 4, 4};
+
+static uint8_t TelemetryFrame[APMAXDATA];  // User data of the notify characteristic
+static uint8_t TelemetryLast[APMAXDATA];   // Last frame sent, for change-only suppression
+static uint32_t TelemetryIndex;            // Notify characteristic index in AP
+static uint32_t TelemetryFields;
+static uint32_t TelemetryPeriod;           // AP_Now ticks between frames
+static uint32_t TelemetryChangeOnly;
+static uint32_t TelemetrySize;             // Bytes in a frame with TelemetryFields
+static uint32_t TelemetryTimingOffset;     // Offset of the timing field, 0 if not selected
+static uint8_t TelemetrySequence;
+static uint8_t TelemetryActive;            // 1 once Telemetry_Add succeeded
+
+static uint32_t TelemetryLastSent;         // AP_Now of the last frame
+static uint32_t TelemetryLastCall;         // AP_Now of the last Telemetry_Process
+static uint32_t TelemetryLoopPeriod, TelemetryLoopMax;  // us
+
+
+// ---------- Telemetry_Put16 ----------
+static uint8_t* Telemetry_Put16(uint8_t* dest, uint32_t value){
+    dest[0] = value & 0xFF;
+    dest[1] = (value >> 8) & 0xFF;
+    return dest + 2;
+}
+
+
+// ---------- Telemetry_Add ----------
+// Adds the telemetry notify characteristic to the service and sets its fields
+// Inputs: uint16_t uuid - UUID of the characteristic
+//         uint32_t index - index AP gives the characteristic (number of notify
+//                          characteristics added before it)
+//         uint32_t fields, periodMs, changeOnly - see Telemetry_Configure
+// Output: int - APOK if successful, APFAIL if the fields do not fit or the SNP fails
+int Telemetry_Add(uint16_t uuid, uint32_t index, uint32_t fields, uint32_t periodMs, uint32_t changeOnly){
+    TelemetryIndex = index;
+    TelemetryActive = 0;
+    if(Telemetry_Configure(fields, periodMs, changeOnly) == APFAIL){
+        return APFAIL;
+    }
+    if(AP_AddNotifyCharacteristic(uuid, APMAXDATA, TelemetryFrame, "Telemetry", 0) == APFAIL){
+        return APFAIL;
+    }
+    TelemetryActive = 1;
+    AP_SetNotifySize(TelemetryIndex, TelemetrySize);
+    TelemetryLastCall = TelemetryLastSent = AP_Now();
+    return APOK;
+}
+
+
+// ---------- Telemetry_Configure ----------
+// Selects the fields, send rate and suppression of the telemetry frames
+// Inputs: uint32_t fields - TELEMETRY_DISTANCES | TELEMETRY_POSE | ...
+//         uint32_t periodMs - shortest time between frames (0 for every call)
+//         uint32_t changeOnly - 1 to skip frames where nothing changed
+// Output: int - APOK if successful, APFAIL if the fields do not fit in one frame
+//               (the previous configuration is kept)
+int Telemetry_Configure(uint32_t fields, uint32_t periodMs, uint32_t changeOnly){
+    uint32_t i, size = TELEMETRY_HEADER_BYTES, timing = 0;
+
+    if((fields == 0) || (fields & ~TELEMETRY_ALL_FIELDS)){
+        return APFAIL;
+    }
+    for(i = 0; i < 5; i++){
+        if(fields & (1 << i)){
+            if((1 << i) == TELEMETRY_TIMING){
+                timing = size;
+            }
+            size += TelemetryFieldBytes[i];
+        }
+    }
+    if(size > APMAXDATA){
+        return APFAIL;
+    }
+
+    TelemetryFields = fields;
+    TelemetryPeriod = periodMs * TELEMETRY_TICKS_PER_MS;
+    TelemetryChangeOnly = changeOnly;
+    TelemetrySize = size;
+    TelemetryTimingOffset = timing;
+    TelemetryLast[0] = 0;               // Fields never 0, so the next frame counts as changed
+    if(TelemetryActive){
+        AP_SetNotifySize(TelemetryIndex, TelemetrySize);
+    }
+    return APOK;
+}
+
+
+// ---------- Telemetry_Changed ----------
+// Output: uint32_t - 1 if the frame differs from the last frame sent, leaving out
+//         the sequence number and timing
+static uint32_t Telemetry_Changed(void){
+    uint32_t i;
+
+    if(TelemetryFrame[0] != TelemetryLast[0]){
+        return 1;
+    }
+    for(i = TELEMETRY_HEADER_BYTES; i < TelemetrySize; i++){
+        if(TelemetryTimingOffset && (i >= TelemetryTimingOffset) && (i < TelemetryTimingOffset + 4)){
+            continue;
+        }
+        if(TelemetryFrame[i] != TelemetryLast[i]){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+// ---------- Telemetry_Process ----------
+// Call once per main loop: times the loop and sends a frame when one is due
+// Inputs: const TelemetrySample* sample - current values
+// Output: none
+void Telemetry_Process(const TelemetrySample* sample){
+    uint32_t now, elapsed, i;
+    uint8_t* pt;
+
+    if(!TelemetryActive){
+        return;
+    }
+
+    // Time between calls, the main loop period
+    now = AP_Now();
+    TelemetryLoopPeriod = (now - TelemetryLastCall) / (TELEMETRY_TICKS_PER_MS / 1000);
+    TelemetryLastCall = now;
+    if(TelemetryLoopPeriod > TelemetryLoopMax){
+        TelemetryLoopMax = TelemetryLoopPeriod;
+    }
+
+    elapsed = now - TelemetryLastSent;
+    if(elapsed < TelemetryPeriod){
+        return;
+    }
+
+    // Pack the frame
+    TelemetryFrame[0] = TelemetryFields;
+    TelemetryFrame[1] = TelemetrySequence;
+    pt = &TelemetryFrame[TELEMETRY_HEADER_BYTES];
+    if(TelemetryFields & TELEMETRY_DISTANCES){
+        for(i = 0; i < 3; i++){
+            pt = Telemetry_Put16(pt, sample->distance[i]);
+        }
+    }
+    if(TelemetryFields & TELEMETRY_POSE){
+        pt = Telemetry_Put16(pt, (uint16_t)sample->x);
+        pt = Telemetry_Put16(pt, (uint16_t)sample->y);
+        pt = Telemetry_Put16(pt, sample->heading);
+    }
+    if(TelemetryFields & TELEMETRY_RPM){
+        pt = Telemetry_Put16(pt, (uint16_t)sample->rpm[0]);
+        pt = Telemetry_Put16(pt, (uint16_t)sample->rpm[1]);
+    }
+    if(TelemetryFields & TELEMETRY_DUTY){
+        pt = Telemetry_Put16(pt, sample->duty[0]);
+        pt = Telemetry_Put16(pt, sample->duty[1]);
+    }
+    if(TelemetryFields & TELEMETRY_TIMING){
+        pt = Telemetry_Put16(pt, TelemetryLoopPeriod > 0xFFFF ? 0xFFFF : TelemetryLoopPeriod);
+        pt = Telemetry_Put16(pt, TelemetryLoopMax > 0xFFFF ? 0xFFFF : TelemetryLoopMax);
+    }
+
+    if(TelemetryChangeOnly && !Telemetry_Changed()
+       && (elapsed < TELEMETRY_KEEPALIVE_MS * TELEMETRY_TICKS_PER_MS)){
+        return;
+    }
+
+    // Try again on the next call if the notification buffer is busy
+    if(AP_SendNotification(TelemetryIndex) == APFAIL){
+        return;
+    }
+    for(i = 0; i < TelemetrySize; i++){
+        TelemetryLast[i] = TelemetryFrame[i];
+    }
+    TelemetrySequence++;
+    TelemetryLastSent = now;
+    TelemetryLoopMax = 0;
+}
@@ -0,0 +1,64 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+/*
+ * Telemetry notification: packs a configurable set of fields into one BLE
+ * notification, so the dashboard gets every value of an update in one frame
+ * instead of one read per value.
+ *
+ * Frame (little endian, at most APMAXDATA bytes):
+ *   fields(1) sequence(1) then, in this order, the fields that are selected
+ *   TELEMETRY_DISTANCES  left(2) center(2) right(2)   mm
+ *   TELEMETRY_POSE       x(2) y(2) heading(2)         mm, mm, degrees*100
+ *   TELEMETRY_RPM        left(2) right(2)             signed RPM
+ *   TELEMETRY_DUTY       left(2) right(2)             PWM duty cycle
+ *   TELEMETRY_TIMING     period(2) maximum(2)         us between Telemetry_Process
+ *                                                     calls since the last frame
+ * The sequence number counts every frame sent, so the dashboard can see drops.
+ *
+ * A frame is sent at most once per period. With change-only suppression a
+ * frame is only sent when a field other than the timing changed, or after
+ * TELEMETRY_KEEPALIVE_MS without a frame.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#define TELEMETRY_DISTANCES   0x01
+#define TELEMETRY_POSE        0x02
+#define TELEMETRY_RPM         0x04
+#define TELEMETRY_DUTY        0x08
+#define TELEMETRY_TIMING      0x10
+#define TELEMETRY_ALL_FIELDS  0x1F
+
+#define TELEMETRY_HEADER_BYTES 2          /* Fields and sequence bytes            */
+#define TELEMETRY_PERIOD_MS    100        /* Default time between frames          */
+#define TELEMETRY_KEEPALIVE_MS 1000       /* Longest time without a frame         */
+
+// Telemetry configuration characteristic: written by the dashboard as one
+// 32-bit number. A configuration Telemetry_Configure rejects reads back as the
+// one still in use, with TELEMETRY_CONFIG_REJECTED set
+#define TELEMETRY_CONFIG_FIELDS(CFG)      ((CFG) & 0xFF)
+#define TELEMETRY_CONFIG_CHANGE_ONLY(CFG) (((CFG) >> 8) & 0x01)
+#define TELEMETRY_CONFIG_PERIOD_MS(CFG)   ((CFG) >> 16)
+#define TELEMETRY_CONFIG_REJECTED         0x00008000  /* Status: the last write was rejected */
+
+
+// Values of one update, filled in by the main loop
+typedef struct TelemetrySample{
+    uint16_t distance[3];   // Left, center, right (mm)
+    int16_t x, y;           // Position (mm)
+    uint16_t heading;       // Degrees*100
+    int16_t rpm[2];         // Left, right
+    uint16_t duty[2];       // Left, right
+} TelemetrySample;
+
+
+// --------------------- Function Prototypes ---------------------
+int Telemetry_Add(uint16_t uuid, uint32_t index, uint32_t fields, uint32_t periodMs, uint32_t changeOnly);
+int Telemetry_Configure(uint32_t fields, uint32_t periodMs, uint32_t changeOnly);
+void Telemetry_Process(const TelemetrySample* sample);
+
+#endif
@@ -1,7 +1,7 @@
 // UART1.c
 // Runs on MSP432
 // Use UCA2 to implement bidirectional data transfer to and from a
-// CC2650 BLE module, uses interrupts for receive and busy-wait for transmit
+// CC2650 BLE module, uses interrupts for receive and transmit
 
 // Daniel Valvano
 // May 24, 2016
@@ -48,33 +48,50 @@ policies, either expressed or implied, of the FreeBSD Project.
 
 #include <stdint.h>
 #include "UART1.h"
+#include "Ring.h"
 #include "msp.h"
+#include "RamFunc.h"
 
 #define FIFOSIZE   256       // size of the FIFOs (must be power of 2)
 #define FIFOSUCCESS 1        // return value on success
 #define FIFOFAIL    0        // return value on failure
-uint32_t RxPutI;      // should be 0 to SIZE-1
-uint32_t RxGetI;      // should be 0 to SIZE-1 
-uint32_t RxFifoLost;  // should be 0 
-uint8_t RxFIFO[FIFOSIZE];
+// Receive FIFO: EUSCIA2 interrupt puts, main program gets (Ring.h)
+RING_DEFINE(RxRing, uint8_t, FIFOSIZE)
+RxRing RxFIFO;        // RxFIFO.dropped should be 0, counts overflows
 void RxFifo_Init(void){
-  RxPutI = RxGetI = 0;                      // empty
-  RxFifoLost = 0; // occurs on overflow
-}
-int RxFifo_Put(uint8_t data){
-  if(((RxPutI+1)&(FIFOSIZE-1)) == RxGetI){
-    RxFifoLost++;
-    return FIFOFAIL; // fail if full  
-  }    
-  RxFIFO[RxPutI] = data;                    // save in FIFO
-  RxPutI = (RxPutI+1)&(FIFOSIZE-1);         // next place to put
+  RxRing_Init(&RxFIFO);                     // empty
+}
+RAMFUNC int RxFifo_Put(uint8_t data){
+  return RxRing_Put(&RxFIFO, &data) ? FIFOSUCCESS : FIFOFAIL; // fail if full
+}
+int RxFifo_Get(uint8_t *datapt){
+  return RxRing_Get(&RxFIFO, datapt) ? FIFOSUCCESS : FIFOFAIL; // fail if empty
+}
+volatile uint32_t TxPutI;      // should be 0 to SIZE-1, written by main and AP, read by the ISR
+volatile uint32_t TxGetI;      // should be 0 to SIZE-1, written by the ISR
+volatile uint32_t TxStageI;    // bytes from TxPutI to TxStageI are staged, not sent yet
+volatile uint8_t TxFIFO[FIFOSIZE];
+void TxFifo_Init(void){
+  TxPutI = TxGetI = TxStageI = 0;           // empty
+}
+int TxFifo_Put(uint8_t data){
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();                          // an ISR may be staging a frame
+  if((TxStageI != TxPutI)||(((TxPutI+1)&(FIFOSIZE-1)) == TxGetI)){
+    __set_PRIMASK(primask);
+    return FIFOFAIL; // fail if a frame is staged or if full
+  }
+  TxFIFO[TxPutI] = data;                    // save in FIFO
+  TxPutI = (TxPutI+1)&(FIFOSIZE-1);         // next place to put
+  TxStageI = TxPutI;                        // still nothing staged
+  __set_PRIMASK(primask);
   return FIFOSUCCESS;
 }
-int RxFifo_Get(uint8_t *datapt){ 
-  if(RxPutI == RxGetI) return 0;            // fail if empty
-  *datapt = RxFIFO[RxGetI];                 // retrieve data
-  RxGetI = (RxGetI+1)&(FIFOSIZE-1);         // next place to get
-  return FIFOSUCCESS; 
+RAMFUNC int TxFifo_Get(uint8_t *datapt){
+  if(TxPutI == TxGetI) return 0;            // fail if empty
+  *datapt = TxFIFO[TxGetI];                 // retrieve data
+  TxGetI = (TxGetI+1)&(FIFOSIZE-1);         // next place to get
+  return FIFOSUCCESS;
 }
                     
 //------------UART1_InStatus------------
@@ -82,15 +99,57 @@ int RxFifo_Get(uint8_t *datapt){
 // Input: none
 // Output: number of bytes in receive FIFO
 uint32_t UART1_InStatus(void){  
- return ((RxPutI - RxGetI)&(FIFOSIZE-1));  
+ return RxRing_Count(&RxFIFO);
 }
+// Modulation pattern UCBRSx for the fractional part of N = clock/baud,
+// from the eUSCI UART chapter of the MSP432P4xx technical reference manual
+// use the last entry whose fraction (in 1/10000) is not larger than N's
+const uint16_t UART1_BRSFraction[] = {
+     0,  529,  715,  835, 1001, 1252, 1430, 1670, 2147, 2224, 2503, 3000,
+  3335, 3575, 3753, 4003, 4286, 4378, 5002, 5715, 6003, 6254, 6432, 6667,
+  7001, 7147, 7503, 7861, 8004, 8333, 8464, 8572, 8751, 9004, 9170, 9288};
+const uint8_t UART1_BRS[] = {
+  0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x11, 0x21, 0x22, 0x44, 0x25,
+  0x49, 0x4A, 0x52, 0x92, 0x53, 0x55, 0xAA, 0x6B, 0xAD, 0xB5, 0xB6, 0xD6,
+  0xB7, 0xBB, 0xDD, 0xED, 0xEE, 0xBF, 0xDF, 0xEF, 0xF7, 0xFB, 0xFD, 0xFE};
+
+//------------UART1_BaudRate------------
+// Calculate the baud rate registers
+// N = clock/baud, with oversampling (UCOS16=1) if N >= 16:
+//   UCBRx = int(N/16), UCBRFx = int(fraction(N/16)*16)
+// without oversampling: UCBRx = int(N)
+// UCBRSx comes from the fraction of N in both cases
+// Input: baud rate in bits/sec
+//        brw, mctlw pointers to the values for EUSCI_A2->BRW and MCTLW
+// Output: none
+static void UART1_BaudRate(uint32_t baud, uint16_t *brw, uint16_t *mctlw){
+  uint32_t n,fraction,i;
+  n = UART1_CLOCK/baud;                                              // int(N)
+  fraction = (uint32_t)(((uint64_t)(UART1_CLOCK%baud)*10000)/baud); // fraction of N in 1/10000
+  i = 0;
+  while((i < sizeof(UART1_BRS)-1)&&(UART1_BRSFraction[i+1] <= fraction)){
+    i++;
+  }
+  if(n >= 16){
+    *brw = n/16;
+    *mctlw = (UART1_BRS[i]<<8)|((n%16)<<4)|0x0001;  // UCBRSx, UCBRFx, UCOS16
+  }else{
+    *brw = n;
+    *mctlw = UART1_BRS[i]<<8;                       // UCBRSx
+  }
+}
+
 //------------UART1_Init------------
-// Initialize the UART for 115,200 baud rate (assuming 12 MHz SMCLK clock),
+// Initialize the UART (assuming 12 MHz SMCLK clock),
 // 8 bit word length, no parity bits, one stop bit
-// Input: none
+// Input: baud rate in bits/sec, UART1_DEFAULTBAUD is 115,200,
+//        up to UART1_CLOCK/3
 // Output: none
-void UART1_Init(void){
+void UART1_Init(uint32_t baud){
+  uint16_t brw,mctlw;
+  UART1_BaudRate(baud,&brw,&mctlw);
   RxFifo_Init();              // initialize FIFOs
+  TxFifo_Init();
   EUSCI_A2->CTLW0 = 0x0001;         // hold the USCI module in reset mode
   // bit15=0,      no parity bits
   // bit14=x,      not used when parity is disabled
@@ -107,11 +166,10 @@ void UART1_Init(void){
   // bit0=1,       hold logic in reset state while configuring
   EUSCI_A2->CTLW0 = 0x00C1;
                               // set the baud rate
-                              // N = clock/baud rate = 12,000,000/115,200 = 104.1667
-  EUSCI_A2->BRW = 104;        // UCBR = baud rate = int(N) = 104
-
-  EUSCI_A2->MCTLW = 0x0000;   // clear first and second modulation stage bit fields
-// since TxFifo is empty, we initially disarm interrupts on UCTXIFG, but arm it on OutChar
+                              // e.g. N = clock/baud rate = 12,000,000/115,200 = 104.1667
+  EUSCI_A2->BRW = brw;        // UCBR = 6 (104.1667/16 = 6.5104)
+  EUSCI_A2->MCTLW = mctlw;    // UCBRS = 0x20 (0.1667), UCBRF = 8 (0.5104*16), UCOS16 = 1
+// since TxFifo is empty, we initially disarm interrupts on UCTXIFG, but arm it on OutChar and Write
   P3->SEL0 |= 0x0C;
   P3->SEL1 &= ~0x0C;          // configure P3.3 and P3.2 as primary module function
   NVIC->IP[4] = (NVIC->IP[4]&0xFF00FFFF)|0x00400000; // priority 2
@@ -133,21 +191,94 @@ uint8_t UART1_InChar(void){
   return(letter);
 }
 
+//------------UART1_StartOutput------------
+// Arm interrupts on transmit empty, so the ISR sends what is in TxFifo
+// Input: none
+// Output: none
+static void UART1_StartOutput(void){
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();            // the ISR also changes IE
+  EUSCI_A2->IE |= 0x0002;     // arm interrupts on transmit empty
+  __set_PRIMASK(primask);
+}
+
 ///------------UART1_OutChar------------
-// Output 8-bit to serial port, busy-wait
+// Output 8-bit to serial port, interrupt synchronization
 // Input: letter is an 8-bit data to be transferred
 // Output: none
+// spin if TxFifo is full or a frame is staged
 void UART1_OutChar(uint8_t data){
-  while((EUSCI_A2->IFG&0x02) == 0);
-  EUSCI_A2->TXBUF = data;
+  while(TxFifo_Put(data) == FIFOFAIL){};
+  UART1_StartOutput();
+}
+
+//------------UART1_Write------------
+// Queue bytes for output, non-blocking
+// Input: buf points to the bytes to send
+//        len is the number of bytes
+// Output: number of bytes queued, less than len if TxFifo filled up,
+//         0 while a frame is staged
+uint32_t UART1_Write(const uint8_t *buf, uint32_t len){
+  uint32_t count = 0;
+  while((count < len) && (TxFifo_Put(buf[count]) == FIFOSUCCESS)){
+    count++;
+  }
+  if(count){
+    UART1_StartOutput();
+  }
+  return count;
+}
+
+//------------UART1_StageFree------------
+// Returns how many bytes can still be staged
+// Input: none
+// Output: free bytes in TxFifo after the staged bytes
+uint32_t UART1_StageFree(void){
+  return ((TxGetI - TxStageI - 1)&(FIFOSIZE-1));
 }
+
+//------------UART1_StagePut------------
+// Write a byte into TxFifo without sending it, UART1_Commit sends it
+// Input: data is the 8-bit byte
+// Output: none
+// the caller checks UART1_StageFree first
+void UART1_StagePut(uint8_t data){
+  TxFIFO[TxStageI] = data;
+  TxStageI = (TxStageI+1)&(FIFOSIZE-1);
+}
+
+//------------UART1_Commit------------
+// Send staged bytes, oldest first, non-blocking
+// Input: len is the number of staged bytes to send
+// Output: none
+void UART1_Commit(uint32_t len){
+  TxPutI = (TxPutI+len)&(FIFOSIZE-1);       // the ISR sees them now
+  UART1_StartOutput();
+}
+
 // interrupt 18 occurs on :
 // UCRXIFG RX data register is full
+// UCTXIFG TX data register is empty (armed while TxFifo has data)
+// UCTXCPTIFG last stop bit sent (armed after TxFifo empties)
 // vector at 0x00000088 in startup_msp432.s
-void EUSCIA2_IRQHandler(void){
+RAMFUNC void EUSCIA2_IRQHandler(void){
+  uint8_t data;
   if(EUSCI_A2->IFG&0x01){             // RX data register full
     RxFifo_Put((uint8_t)EUSCI_A2->RXBUF);// clears UCRXIFG
   } 
+  if((EUSCI_A2->IE&0x02)&&(EUSCI_A2->IFG&0x02)){ // TX data register empty
+    if(TxFifo_Get(&data)){
+      EUSCI_A2->TXBUF = data;         // clears UCTXIFG
+    }else{
+      // last byte just moved to the shift register, wait for its stop bit
+      EUSCI_A2->IFG &= ~0x08;         // clear UCTXCPTIFG left by earlier bytes
+      EUSCI_A2->IE = (EUSCI_A2->IE&~0x02)|0x08;
+    }
+  }
+  if((EUSCI_A2->IE&0x08)&&(EUSCI_A2->IFG&0x08)){ // transmission complete
+    EUSCI_A2->IFG &= ~0x08;
+    EUSCI_A2->IE &= ~0x08;            // UART1_OutDone now returns 1
+  }
 }
 
 //------------UART1_OutString------------
@@ -160,11 +291,25 @@ void UART1_OutString(uint8_t *pt){
     pt++;
   }
 }
+//------------UART1_OutStatus------------
+// Returns how much data is waiting to be sent
+// Input: none
+// Output: number of bytes in transmit FIFO
+uint32_t UART1_OutStatus(void){
+ return ((TxPutI - TxGetI)&(FIFOSIZE-1));
+}
+//------------UART1_OutDone------------
+// Check if all output has left the UART, non-blocking
+// Input: none
+// Output: 1 if TxFifo is empty and the last stop bit has been sent, 0 if not
+uint32_t UART1_OutDone(void){
+  return ((TxPutI == TxGetI)&&((EUSCI_A2->IE&0x0A) == 0));
+}
 //------------UART1_FinishOutput------------
 // Wait for all transmission to finish
 // Input: none
 // Output: none
 void UART1_FinishOutput(void){
   // Wait for entire tx message to be sent
-  while((EUSCI_A2->IFG&0x02) == 0);
+  while(UART1_OutDone() == 0);
 }
@@ -6,7 +6,7 @@
  * @remark    UCA2TXD (VCP transmit) connected to P3.3
  * @remark    J1.3  from Bluetooth (DIO3_TXD) to LaunchPad (UART RxD){MSP432 P3.2}
  * @remark    J1.4  from LaunchPad to Bluetooth (DIO2_RXD) (UART TxD){MSP432 P3.3}
- * @remark    Busy-wait device driver for the EUSCI A2 UART output
+ * @remark    Interrupting device driver for the EUSCI A2 UART output
  * @remark    Interrupting device driver for the EUSCI A2 UART input
  * @version   TI-RSLK MAX v1.1
  * @author    Daniel Valvano and Jonathan Valvano
@@ -82,15 +82,25 @@ policies, either expressed or implied, of the FreeBSD Project.
  */
 #define DEL  0x7F
 
+/**
+ * \brief SMCLK frequency the baud rate is derived from
+ */
+#define UART1_CLOCK 12000000
+/**
+ * \brief baud rate of the CC2650 SNP as shipped
+ */
+#define UART1_DEFAULTBAUD 115200
+
 /**
  * @details   Initialize EUSCI_A2 for UART operation
- * @details   115,200 baud rate (assuming 12 MHz SMCLK clock),
+ * @details   baud rate from BRW and MCTLW (UCOS16, UCBRF, UCBRS) calculated
+ * @details   for a 12 MHz SMCLK clock,
  * @details   8 bit word length, no parity bits, one stop bit
- * @param  none
+ * @param  baud is the baud rate in bits/sec, UART1_DEFAULTBAUD to UART1_CLOCK/3
  * @return none
  * @brief  Initialize EUSCI A2
  */
-void UART1_Init(void);
+void UART1_Init(uint32_t baud);
 
 /**
  * @details   Receive a character from EUSCI_A2 UART
@@ -105,8 +115,8 @@ uint8_t UART1_InChar(void);
 
 /**
  * @details   Transmit a character to EUSCI_A2 UART
- * @details   Busy-wait synchronization,
- * @details   blocking, wait for UART to be ready
+ * @details   Interrupt synchronization,
+ * @details   blocking, spin if TxFifo is full or a frame is staged
  * @param  data is the ASCII code for data to send
  * @return none
  * @note   UART1_Init must be called once prior
@@ -114,6 +124,46 @@ uint8_t UART1_InChar(void);
  */
 void UART1_OutChar(uint8_t data);
 
+/**
+ * @details   Queue bytes for transmission to EUSCI_A2 UART
+ * @details   Interrupt synchronization,
+ * @details   non-blocking, queues as many bytes as TxFifo has room for
+ * @param  buf points to the bytes to send
+ * @param  len is the number of bytes to send
+ * @return number of bytes queued, 0 while a frame is staged
+ * @note   UART1_Init must be called once prior
+ * @brief  Transmit bytes out of MSP432
+ */
+uint32_t UART1_Write(const uint8_t *buf, uint32_t len);
+
+/**
+ * @details   Free space for staging bytes in the transmit FIFO
+ * @param  none
+ * @return number of bytes UART1_StagePut can still write
+ * @brief  Check room for staged output
+ */
+uint32_t UART1_StageFree(void);
+
+/**
+ * @details   Write a byte into the transmit FIFO without sending it,
+ * @details   so a frame can be built in place and sent later by UART1_Commit
+ * @param  data is the byte to stage
+ * @return none
+ * @note   check UART1_StageFree first; UART1_OutChar spins and
+ *         UART1_Write queues nothing while bytes are staged
+ * @brief  Stage byte for output
+ */
+void UART1_StagePut(uint8_t data);
+
+/**
+ * @details   Send the oldest staged bytes
+ * @details   Interrupt synchronization, non-blocking
+ * @param  len is the number of staged bytes to send
+ * @return none
+ * @brief  Send staged bytes
+ */
+void UART1_Commit(uint32_t len);
+
 /**
  * @details   Transmit a string to EUSCI_A2 UART
  * @param  pt is pointer to null-terminated ASCII string to be transferred
@@ -124,6 +174,24 @@ void UART1_OutChar(uint8_t data);
 void UART1_OutString(uint8_t *pt);
 
 
+/**
+ * @details   Check the transmit FIFO of EUSCI_A2 UART
+ * @details   non-blocking
+ * @param  none
+ * @return number of characters in FIFO waiting to be sent
+ * @brief  Check status of transmit FIFO
+ */
+uint32_t UART1_OutStatus(void);
+
+/**
+ * @details   Check if all transmission has finished
+ * @details   non-blocking
+ * @param  none
+ * @return 1 if TxFifo is empty and the last stop bit has been sent, 0 otherwise
+ * @brief  Check if UART output is complete
+ */
+uint32_t UART1_OutDone(void);
+
 /**
  * @details   Wait for all transmission to finish
  * @details   Busy-wait synchronization,
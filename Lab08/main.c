@@ -5,10 +5,15 @@
 #include "RobotLights.h"
 #include "Motor.h"
 #include "ADC14.h"
+#include "Telemetry.h"
+#include "APBench.h"
 
 #include <stdint.h>
 #include <math.h>
 
+// Predefine AP_BENCHMARK (project settings) to measure notification throughput
+// over UART0 before the main loop; AP.c is then built without APDEBUG
+
 // Distances for Object Ahead notifications
 #define MIN_DISTANCE_MM 90
 #define HYSTERESIS_DISTANCE_MM 20
@@ -26,6 +31,7 @@ void getRightDist(void){};
 void getCenterDist(void){};
 void getLeftDist(void){};
 void objectAheadStatus(void){};
+void setTelemetry(void);
 void computeDistances(uint32_t leftADC, uint32_t *leftDist, uint32_t centerADC, uint32_t *centerDist, uint32_t rightADC, uint32_t *rightDist);
 uint32_t computeDistance(uint32_t adcReading, char side);
 
@@ -34,6 +40,9 @@ uint32_t computeDistance(uint32_t adcReading, char side);
 // Write
 uint8_t direction = 0x00;
 uint16_t dutyCycle = 0x0000;
+uint32_t telemetryConfig = (TELEMETRY_PERIOD_MS << 16) | (1 << 8)
+                         | TELEMETRY_DISTANCES | TELEMETRY_DUTY | TELEMETRY_TIMING;
+uint32_t telemetryActive;   // Configuration in use, telemetryConfig goes back to it on a rejected write
 
 // Read
 uint32_t rightDist = 0x00000000;
@@ -66,6 +75,7 @@ void main(void){
     // Variables for the distances sensors
     uint32_t leftADC, centerADC, rightADC;
     uint8_t prevObjectAhead = 0x00;
+    TelemetrySample sample = {0};
 
     // Creating a GATT Service
     AP_AddService(0xFFF0);
@@ -73,6 +83,7 @@ void main(void){
     // Write characteristics
     AP_AddCharacteristic(0xFFF1,1,&direction,0x02,0x08,"direction",0,&setDirection);
     AP_AddCharacteristic(0xFFF2,2,&dutyCycle,0x02,0x08,"dutyCycle",0,&setDutyCycle);
+    AP_AddCharacteristic(0xFFF8,4,&telemetryConfig,0x03,0x0A,"telemetryConfig",0,&setTelemetry);
 
     // Read characteristics
     AP_AddCharacteristic(0xFFF3,4,&rightDist,0x01,0x02,"rightDist",&getRightDist,0);
@@ -82,10 +93,22 @@ void main(void){
     // Notification for an object ahead
     AP_AddNotifyCharacteristic(0xFFF6, 1, &objectAhead, "Object Ahead", &objectAheadStatus); // CCCD = 0
 
+    // Notification with the distances, duty cycle and loop timing in one frame
+    telemetryActive = telemetryConfig;
+    Telemetry_Add(0xFFF7, 1, TELEMETRY_CONFIG_FIELDS(telemetryConfig),
+                  TELEMETRY_CONFIG_PERIOD_MS(telemetryConfig), TELEMETRY_CONFIG_CHANGE_ONLY(telemetryConfig));
+
     // Register the service start advertising
     AP_RegisterService();
     AP_StartAdvertisement();
 
+#ifdef AP_BENCHMARK
+    // Full size telemetry frames, as fast as the link takes them
+    AP_SetNotifySize(1, APMAXDATA);
+    APBench_Run(1, APMAXDATA, APBENCH_COUNT);
+    setTelemetry();
+#endif
+
     // Main loop
     while(1){
         // Get distances from each sensor
@@ -169,6 +192,13 @@ void main(void){
         // Set the previous object ahead to the current
         prevObjectAhead = objectAhead;
 
+        // Send the telemetry frame when it is due
+        sample.distance[0] = leftDist;
+        sample.distance[1] = centerDist;
+        sample.distance[2] = rightDist;
+        sample.duty[0] = sample.duty[1] = (direction == 0x00) ? 0 : dutyCycle;
+        Telemetry_Process(&sample);
+
         Clock_Delay1ms(10);
     }
 }
@@ -182,6 +212,23 @@ void setDutyCycle(void){
 }
 
 
+// Apply a configuration written by the dashboard
+// If the fields do not fit in one frame the previous configuration is kept, and
+// the characteristic reads back as that one with TELEMETRY_CONFIG_REJECTED set
+void setTelemetry(void){
+    uint32_t config = telemetryConfig & ~TELEMETRY_CONFIG_REJECTED;
+
+    if(Telemetry_Configure(TELEMETRY_CONFIG_FIELDS(config),
+                           TELEMETRY_CONFIG_PERIOD_MS(config),
+                           TELEMETRY_CONFIG_CHANGE_ONLY(config)) == APOK){
+        telemetryActive = config;
+        telemetryConfig = config;
+    } else {
+        telemetryConfig = telemetryActive | TELEMETRY_CONFIG_REJECTED;
+    }
+}
+
+
 // Compute all distances from the center
 // Inputs: ADC values and pointers to store distances
 void computeDistances(uint32_t leftADC, uint32_t *leftDist, uint32_t centerADC,
@@ -50,6 +50,7 @@ policies, either expressed or implied, of the FreeBSD Project.
 
 #include <stdint.h>
 #include "msp.h"
+#include "RamFunc.h"
 
 //void ta3dummy(uint16_t t){};       // dummy function
 void (*CaptureTask0)(uint16_t time);// = ta3dummy;// user function
@@ -90,14 +91,14 @@ void TimerA3Capture_Init01(void(*task0)(uint16_t time), void(*task1)(uint16_t ti
 
 }
 
-void TA3_0_IRQHandler(void){
+RAMFUNC void TA3_0_IRQHandler(void){
     // write this for Lab 16
     // A rising edge on TA3.0 - P10.4
     TIMER_A3 -> CCTL[0] &=~0x01; // clear bit 0 (CCIFG) to ACK interrupt.
     (*CaptureTask0)(TIMER_A3 -> CCR[0]);
 }
 
-void TA3_N_IRQHandler(void){
+RAMFUNC void TA3_N_IRQHandler(void){
     // write this for Lab 16
     // A rising edge on TA3.1 - P10.5
     TIMER_A3 -> CCTL[1] &=~0x01; // clear bit (CCIFG) to ACK interrupt
@@ -54,6 +54,7 @@ policies, either expressed or implied, of the FreeBSD Project.
 #include "TA3InputCapture.h"
 #include "msp.h"
 #include "Tachometer.h"
+#include "RamFunc.h"
 #include "Precision_Moves.h"
 
 
@@ -66,7 +67,7 @@ int Tachometer_RightSteps = 0;     // incremented with every step forward; decre
 int Tachometer_LeftSteps = 0;      // incremented with every step forward; decremented with every step backward
 
 
-void tachometerRightInt(uint16_t currenttime){
+RAMFUNC void tachometerRightInt(uint16_t currenttime){
     Tachometer_FirstRightTime = Tachometer_SecondRightTime;
     Tachometer_SecondRightTime = currenttime;
     uint16_t tDiff;
@@ -81,7 +82,7 @@ void tachometerRightInt(uint16_t currenttime){
     }
 }
 
-void tachometerLeftInt(uint16_t currenttime){
+RAMFUNC void tachometerLeftInt(uint16_t currenttime){
     Tachometer_FirstLeftTime = Tachometer_SecondLeftTime;
     Tachometer_SecondLeftTime = currenttime;
     uint16_t tDiff;
@@ -43,6 +43,7 @@ policies, either expressed or implied, of the FreeBSD Project.
 
 #include "msp.h"
 #include "ADC14.h"
+#include "Journal.h"
 
 
 
@@ -135,5 +136,8 @@ void ADC_In17_14_16(uint32_t *ch17, uint32_t *ch14, uint32_t *ch16){
     *ch17 = ADC14->MEM[0];            // 4) P9.0/A17 result 0 to 16383
     *ch14 = ADC14->MEM[1];            //    P6.1/A14 result 0 to 16383
     *ch16 = ADC14->MEM[2];            //    P9.1/A16 result 0 to 16383
+#ifdef JOURNAL_RECORD
+    Journal_ADC(*ch17, *ch14, *ch16);
+#endif
 
 }
@@ -0,0 +1,58 @@
+#include <math.h>
+#include "Arena.h"
+
+
+// Known walls of the course
+const ArenaWall ArenaWalls[ARENA_NUM_WALLS] = {
+    {ARENA_MIN_X_MM, ARENA_MIN_Y_MM, ARENA_MAX_X_MM, ARENA_MIN_Y_MM},
+    {ARENA_MAX_X_MM, ARENA_MIN_Y_MM, ARENA_MAX_X_MM, ARENA_MAX_Y_MM},
+    {ARENA_MAX_X_MM, ARENA_MAX_Y_MM, ARENA_MIN_X_MM, ARENA_MAX_Y_MM},
+    {ARENA_MIN_X_MM, ARENA_MAX_Y_MM, ARENA_MIN_X_MM, ARENA_MIN_Y_MM}
+};
+
+
+// ---------- Arena_Raycast ----------
+// Finds the first known wall along a ray
+// Inputs: float xPos, yPos - origin of the ray (mm)
+//         float angle - direction of the ray (radians)
+//         float maxRange - longest distance to search (mm)
+//         uint32_t* wall - pointer to store the index of the wall hit, or ARENA_NO_WALL
+// Output: float - distance to the wall, or maxRange if no wall is hit (mm)
+float Arena_Raycast(float xPos, float yPos, float angle, float maxRange, uint32_t* wall){
+    return Arena_RaycastDir(xPos, yPos, cosf(angle), sinf(angle), maxRange, wall);
+}
+
+
+// ---------- Arena_RaycastDir ----------
+// Finds the first known wall along a ray given by a unit direction vector, for
+// callers that already have the cosine and sine of the ray's angle
+// Inputs: float xPos, yPos - origin of the ray (mm)
+//         float dx, dy - unit vector along the ray
+//         float maxRange - longest distance to search (mm)
+//         uint32_t* wall - pointer to store the index of the wall hit, or ARENA_NO_WALL
+// Output: float - distance to the wall, or maxRange if no wall is hit (mm)
+float Arena_RaycastDir(float xPos, float yPos, float dx, float dy, float maxRange, uint32_t* wall){
+    float ex, ey, denom, t, u;
+    float best = maxRange;
+    uint32_t i;
+
+    *wall = ARENA_NO_WALL;
+    for(i = 0; i < ARENA_NUM_WALLS; i++){
+        ex = (float)(ArenaWalls[i].x1 - ArenaWalls[i].x0);
+        ey = (float)(ArenaWalls[i].y1 - ArenaWalls[i].y0);
+        denom = dx*ey - dy*ex;
+        if(denom == 0){
+            continue; // Parallel to the wall
+        }
+
+        // Distance along the ray (t) and fraction along the wall (u) of the intersection
+        t = ((ArenaWalls[i].x0 - xPos)*ey - (ArenaWalls[i].y0 - yPos)*ex) / denom;
+        u = ((ArenaWalls[i].x0 - xPos)*dy - (ArenaWalls[i].y0 - yPos)*dx) / denom;
+        if(t >= 0 && u >= 0 && u <= 1 && t < best){
+            best = t;
+            *wall = i;
+        }
+    }
+
+    return best;
+}
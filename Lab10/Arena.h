@@ -0,0 +1,39 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+
+/*
+ * Map of the walls whose positions are known before a run (the course boundary).
+ * Positions are in the same frame as the robot's Coordinates: the robot starts at
+ * (STARTING_X_POS, STARTING_Y_POS) facing +y. Obstacles placed on the course are
+ * not in the map; sensor readings that hit them are rejected by the estimators.
+ * Edit ArenaWalls in Arena.c to match the course being driven.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#define ARENA_MIN_X_MM  -1000  /* Left wall of the course (mm)   */
+#define ARENA_MAX_X_MM   1000  /* Right wall of the course (mm)  */
+#define ARENA_MIN_Y_MM  -300   /* Back wall of the course (mm)   */
+#define ARENA_MAX_Y_MM   2200  /* Front wall of the course (mm)  */
+
+#define ARENA_NUM_WALLS  4
+#define ARENA_NO_WALL    0xFF  /* Raycast did not hit a wall */
+
+
+// Straight wall from (x0, y0) to (x1, y1) in mm
+typedef struct ArenaWall{
+    int16_t x0, y0;
+    int16_t x1, y1;
+} ArenaWall;
+
+extern const ArenaWall ArenaWalls[ARENA_NUM_WALLS];
+
+
+// --------------------- Function Prototypes ---------------------
+float Arena_Raycast(float xPos, float yPos, float angle, float maxRange, uint32_t* wall);
+float Arena_RaycastDir(float xPos, float yPos, float dx, float dy, float maxRange, uint32_t* wall);
+
+#endif
@@ -0,0 +1,249 @@
+#include "Bug.h"
+
+
+// States of the navigator
+#define BUG_GO_TO_GOAL      0 /* Driving straight towards the destination */
+#define BUG_FOLLOW_BOUNDARY 1 /* Following an obstacle's boundary         */
+
+// Ways to turn
+#define BUG_NO_PIVOT        0 /* Drive forwards while steering */
+#define BUG_PIVOT_LEFT      1 /* Turn left in place            */
+#define BUG_PIVOT_RIGHT     2 /* Turn right in place           */
+
+// Dead reckoned pose (mm and radians) and the tachometer steps it was computed from
+typedef struct BugPose{
+    float xPos;
+    float yPos;
+    float heading;
+    int32_t leftSteps;
+    int32_t rightSteps;
+} BugPose;
+
+
+// ---------- Bug_WrapAngle ----------
+// Wraps an angle to the range -180 to 180 degrees
+// Inputs: float angle - angle (degrees)
+// Output: float - the same angle between -180 and 180 degrees
+static float Bug_WrapAngle(float angle){
+    while(angle > 180.0f){
+        angle -= 360.0f;
+    }
+    while(angle < -180.0f){
+        angle += 360.0f;
+    }
+    return angle;
+}
+
+
+// ---------- Bug_UpdatePose ----------
+// Dead reckons the pose from the steps each wheel moved since the last update
+// Inputs: BugPose* pose - pose to update
+// Output: float - distance the robot's center moved (mm)
+static float Bug_UpdatePose(BugPose* pose){
+    int32_t leftSteps, rightSteps, leftMoved, rightMoved;
+    float leftDist, rightDist, distance, turn;
+
+    Tachometer_Get_Steps(&leftSteps, &rightSteps);
+    leftMoved = leftSteps - pose->leftSteps;
+    rightMoved = rightSteps - pose->rightSteps;
+    leftDist = STEPS_TO_DISTANCE_FL(leftMoved);
+    rightDist = STEPS_TO_DISTANCE_FL(rightMoved);
+    pose->leftSteps = leftSteps;
+    pose->rightSteps = rightSteps;
+
+    // Move along the average heading of the arc
+    distance = (leftDist + rightDist) / 2.0f;
+    turn = (rightDist - leftDist) / (float)WIDTH_MM;
+    pose->xPos += distance * cosf(pose->heading + turn / 2.0f);
+    pose->yPos += distance * sinf(pose->heading + turn / 2.0f);
+    pose->heading += turn;
+
+    return fabsf(distance);
+}
+
+
+// ---------- Bug_Drive ----------
+// Drives forwards while steering, or turns in place if the turn is too sharp
+// Inputs: int32_t steer - duty cycle difference between the wheels, positive turns left
+//         int32_t pivot - BUG_NO_PIVOT to drive forwards, BUG_PIVOT_LEFT or BUG_PIVOT_RIGHT to turn in place
+// Output: none
+static void Bug_Drive(int32_t steer, int32_t pivot){
+    int32_t left, right;
+
+    if(pivot == BUG_PIVOT_LEFT){
+        Motor_Left(SPIN_DUTY, SPIN_DUTY);
+        return;
+    }
+    if(pivot == BUG_PIVOT_RIGHT){
+        Motor_Right(SPIN_DUTY, SPIN_DUTY);
+        return;
+    }
+
+    // Limit the steering so that neither wheel reverses
+    if(steer > BUG_FORWARD_DUTY){steer = BUG_FORWARD_DUTY;}
+    if(steer < -BUG_FORWARD_DUTY){steer = -BUG_FORWARD_DUTY;}
+
+    left = BUG_FORWARD_DUTY - steer;
+    right = BUG_FORWARD_DUTY + steer;
+    if(left > MAX_DUTY_CYCLE){left = MAX_DUTY_CYCLE;}
+    if(right > MAX_DUTY_CYCLE){right = MAX_DUTY_CYCLE;}
+
+    Motor_Forward((uint16_t)left, (uint16_t)right);
+}
+
+
+// ---------- Bug_Navigate ----------
+// Drives to the destination, following the boundary of any obstacle in the way
+// Inputs: Coordinates* cur - robot's current coordinates, updated as the robot drives
+//         const Coordinates* dest - destination's coordinates
+// Output: ret_t - REACHED_DESTINATION, or DRIVING_INTERRUPTED if the destination cannot be reached
+ret_t Bug_Navigate(Coordinates* cur, const Coordinates* dest){
+    BugPose pose;
+    uint32_t leftDist, centerDist, rightDist, sideDist, freeDist;
+    uint32_t state = BUG_GO_TO_GOAL;
+    side_t wallSide = RIGHT_SIDE;
+    ret_t result = REACHED_DESTINATION;
+    int32_t steer, pivot, sensorAngle;
+    float dx, dy, goalDist, bearing, moved;
+    float hitX = 0, hitY = 0, hitDist = 0, minDist = 0, followed = 0, reach;
+
+    // m-line from the starting position to the destination
+    const float startX = (float)cur->xPos;
+    const float startY = (float)cur->yPos;
+    const float mLineX = (float)(dest->xPos - cur->xPos);
+    const float mLineY = (float)(dest->yPos - cur->yPos);
+    const float mLineLength = sqrtf(mLineX*mLineX + mLineY*mLineY);
+
+    pose.xPos = startX;
+    pose.yPos = startY;
+    minDist = mLineLength;
+    pose.heading = (float)cur->heading * PI / 180.0f;
+    Tachometer_Get_Steps(&pose.leftSteps, &pose.rightSteps);
+
+    Lights_SetPattern(LIGHTS_ON);
+
+    while(TRUE){
+        moved = Bug_UpdatePose(&pose);
+
+        // Distance and bearing (relative to the heading) of the destination
+        dx = (float)dest->xPos - pose.xPos;
+        dy = (float)dest->yPos - pose.yPos;
+        goalDist = sqrtf(dx*dx + dy*dy);
+        bearing = Bug_WrapAngle(RAD_TO_DEG((atan2f(dy, dx) - pose.heading)));
+
+        if(goalDist < BUG_GOAL_TOLERANCE_MM){
+            break;
+        }
+
+        // Closest the robot has been to the destination (d_followed). Not reset at a
+        // hit point, so leaving and hitting the same obstacle again cannot undo progress
+        if(goalDist < minDist){
+            minDist = goalDist;
+        }
+
+        Distance_GetDistances(&leftDist, &centerDist, &rightDist);
+        steer = 0;
+        pivot = BUG_NO_PIVOT;
+
+        if(state == BUG_GO_TO_GOAL){
+            if(centerDist < BUG_HIT_MM || leftDist < BUG_SIDE_HIT_MM || rightDist < BUG_SIDE_HIT_MM){
+                // Hit point: keep the obstacle on the side it is closest to, or if it is dead
+                // ahead, on the side away from the destination
+                state = BUG_FOLLOW_BOUNDARY;
+                hitX = pose.xPos;
+                hitY = pose.yPos;
+                hitDist = goalDist;
+                followed = 0;
+                if(leftDist + BUG_LEAVE_MARGIN_MM < rightDist){
+                    wallSide = LEFT_SIDE;
+                } else if(rightDist + BUG_LEAVE_MARGIN_MM < leftDist){
+                    wallSide = RIGHT_SIDE;
+                } else {
+                    wallSide = (bearing >= 0) ? RIGHT_SIDE : LEFT_SIDE;
+                }
+                Lights_SetPattern(LIGHTS_OBSTACLE);
+            } else if(bearing > BUG_PIVOT_DEGREES){
+                pivot = BUG_PIVOT_LEFT;
+            } else if(bearing < -BUG_PIVOT_DEGREES){
+                pivot = BUG_PIVOT_RIGHT;
+            } else {
+                steer = KP_HEADING(bearing);
+            }
+        }
+
+        if(state == BUG_FOLLOW_BOUNDARY){
+            followed += moved;
+
+            // Bug2 leaving criterion: back on the m-line and closer than the hit point
+            dx = pose.xPos - startX;
+            dy = pose.yPos - startY;
+            uint8_t onMLine = fabsf(mLineX*dy - mLineY*dx) / mLineLength < BUG_MLINE_MM;
+            uint8_t leave = onMLine && goalDist + BUG_LEAVE_MARGIN_MM < hitDist;
+
+            // Tangent-Bug leaving criterion: the free space seen towards the destination
+            // reaches closer to it than the robot has ever been. The side sensor facing
+            // the boundary sees past the obstacle's end before the body has cleared it,
+            // so only the center sensor and the other side sensor count
+            sensorAngle = (bearing > 0) ? SIDE_SENSOR_ANGLE : -SIDE_SENSOR_ANGLE;
+            if(fabsf(bearing) <= BUG_SENSOR_CONE){
+                freeDist = centerDist;
+            } else if(fabsf(bearing - sensorAngle) <= BUG_SENSOR_CONE &&
+                      (sensorAngle > 0) != (wallSide == LEFT_SIDE)){
+                freeDist = (sensorAngle > 0) ? leftDist : rightDist;
+            } else {
+                freeDist = 0;
+            }
+            if(freeDist > BUG_HIT_MM){
+                if(freeDist > BUG_FREE_RANGE_MM){freeDist = BUG_FREE_RANGE_MM;}
+                reach = goalDist - (float)freeDist;
+                if(reach < 0){reach = 0;}
+                if(reach + BUG_LEAVE_MARGIN_MM < minDist){
+                    leave = 1;
+                }
+            }
+
+            if(leave && followed > BUG_MIN_FOLLOW_MM){
+                // Head for the destination again from the next iteration
+                state = BUG_GO_TO_GOAL;
+                Lights_SetPattern(LIGHTS_ON);
+            } else {
+                // Circled back to the hit point without finding a way off the boundary
+                dx = pose.xPos - hitX;
+                dy = pose.yPos - hitY;
+                if(followed > 4*BUG_LOOP_MM && sqrtf(dx*dx + dy*dy) < BUG_LOOP_MM){
+                    result = DRIVING_INTERRUPTED;
+                    break;
+                }
+
+                // Hold the side sensor at the wall distance, turning away in place from corners
+                sideDist = (wallSide == LEFT_SIDE) ? leftDist : rightDist;
+                if(sideDist > BUG_SENSOR_RANGE_MM){sideDist = BUG_SENSOR_RANGE_MM;}
+                if(centerDist < BUG_HIT_MM){
+                    pivot = (wallSide == LEFT_SIDE) ? BUG_PIVOT_RIGHT : BUG_PIVOT_LEFT;
+                } else if(wallSide == LEFT_SIDE){
+                    steer = KP_WALL((int32_t)sideDist - BUG_WALL_MM);
+                } else {
+                    steer = -KP_WALL((int32_t)sideDist - BUG_WALL_MM);
+                }
+            }
+        }
+
+        Bug_Drive(steer, pivot);
+
+        // Keep the BLE link running, the bug mode drives on whatever it answers
+        if(Precision_Poll){
+            Precision_Poll();
+        }
+        Clock_Delay1ms(BUG_PERIOD_MS);
+    }
+
+    Motor_Stop();
+    Lights_SetPattern(LIGHTS_OFF);
+
+    // Hand the dead reckoned pose back to the rest of the program
+    cur->xPos = (int32_t)pose.xPos;
+    cur->yPos = (int32_t)pose.yPos;
+    cur->heading = (int32_t)RAD_TO_DEG(pose.heading) % DEGREES_PER_REVOLUTION;
+
+    return result;
+}
@@ -0,0 +1,55 @@
+#ifndef BUG_H
+#define BUG_H
+
+#include "Odometry.h"
+
+/*
+ * Tangent-Bug / Bug2 obstacle navigation.
+ *
+ * The robot drives continuously instead of stopping to spin and re-aim. It heads
+ * towards the destination until an obstacle is in the way (the hit point), then
+ * follows the obstacle's boundary with the side distance sensor facing it. The
+ * boundary is left as soon as either standard criterion holds:
+ *   Bug2:        the robot is back on the m-line (the straight line from the start
+ *                to the destination) and closer to the destination than the hit point
+ *   Tangent-Bug: the sensor pointing towards the destination sees free space that
+ *                reaches closer to the destination than the robot has ever been
+ *                (d_followed, kept when it hits the same obstacle again). The side
+ *                sensor facing the boundary does not count, as it sees past the
+ *                obstacle's end while the body would still clip it
+ * If the robot returns to the hit point without leaving, the destination cannot be
+ * reached and the robot stops.
+ *
+ * The pose is dead reckoned from the tachometers every controller iteration, so the
+ * robot's coordinates stay valid while both wheels are moving at different speeds.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#define BUG_PERIOD_MS          20   /* Delay between controller iterations (ms)                               */
+#define BUG_GOAL_TOLERANCE_MM  30   /* Distance from the destination that counts as reaching it (mm)          */
+
+#define BUG_HIT_MM             200  /* Center distance that counts as an obstacle in the way (mm)            */
+#define BUG_SIDE_HIT_MM        130  /* Side distance that counts as an obstacle in the way (mm)              */
+#define BUG_WALL_MM            250  /* Side sensor distance to hold while following a boundary (mm)          */
+#define BUG_SENSOR_RANGE_MM    300  /* Side distances are limited to this, so open corners are turned around */
+#define BUG_FREE_RANGE_MM      800  /* Longest distance the sensors can report as free space (mm)            */
+
+#define BUG_MLINE_MM           40   /* Distance from the m-line that counts as being on it (mm)               */
+#define BUG_LEAVE_MARGIN_MM    50   /* How much closer than before the robot has to be to leave (mm)          */
+#define BUG_LOOP_MM            100  /* Distance from the hit point that counts as having circled back (mm)    */
+#define BUG_MIN_FOLLOW_MM      100  /* Distance to follow a boundary before the robot may leave it (mm)        */
+#define BUG_SENSOR_CONE        22   /* Destination bearing from a sensor that the sensor can see (degrees)     */
+
+#define BUG_FORWARD_DUTY       RPM_TO_DUTY_EST(LEFT_RPM) /* Duty cycle of both wheels when driving straight */
+#define BUG_PIVOT_DEGREES      45   /* Heading error above which the robot turns in place (degrees)           */
+
+#define KP_HEADING(error)      (int32_t)((error)*40) /* Steering term for the heading error (degrees) */
+#define KP_WALL(error)         (int32_t)((error)*12) /* Steering term for the wall distance error (mm) */
+
+
+// --------------------- Function Prototypes ---------------------
+ret_t Bug_Navigate(Coordinates* cur, const Coordinates* dest);
+
+#endif
@@ -0,0 +1,202 @@
+#include "EKF.h"
+
+
+// State (x mm, y mm, heading rad) and covariance
+static float EkfState[3];
+static float EkfP[3][3];
+
+
+// ---------- EKF_Init ----------
+// Starts the filter at a known pose
+// Inputs: float xPos, yPos - position (mm)
+//         float heading - heading (degrees)
+// Output: none
+void EKF_Init(float xPos, float yPos, float heading){
+    uint32_t i, j;
+
+    EkfState[0] = xPos;
+    EkfState[1] = yPos;
+    EkfState[2] = heading * PI / 180.0f;
+
+    for(i = 0; i < 3; i++){
+        for(j = 0; j < 3; j++){
+            EkfP[i][j] = 0;
+        }
+    }
+    EkfP[0][0] = EKF_INIT_POS_VAR;
+    EkfP[1][1] = EKF_INIT_POS_VAR;
+    EkfP[2][2] = EKF_INIT_HEADING_VAR;
+}
+
+
+// ---------- EKF_Predict ----------
+// Moves the estimate by the distance each wheel drove and grows the covariance
+// Inputs: float leftDist - distance the left wheel moved since the last prediction (mm)
+//         float rightDist - distance the right wheel moved since the last prediction (mm)
+// Output: none
+void EKF_Predict(float leftDist, float rightDist){
+    float distance = (leftDist + rightDist) / 2.0f;
+    float turn = (rightDist - leftDist) / (float)WIDTH_MM;
+    float c = cosf(EkfState[2] + turn / 2.0f);
+    float s = sinf(EkfState[2] + turn / 2.0f);
+    float F[3][3], G[3][2], FP[3][3];
+    float leftVar = EKF_WHEEL_NOISE * fabsf(leftDist);
+    float rightVar = EKF_WHEEL_NOISE * fabsf(rightDist);
+    uint32_t i, j, k;
+
+    // Motion along the arc's average heading
+    EkfState[0] += distance * c;
+    EkfState[1] += distance * s;
+    EkfState[2] += turn;
+
+    // Jacobian of the motion with respect to the state
+    F[0][0] = 1; F[0][1] = 0; F[0][2] = -distance * s;
+    F[1][0] = 0; F[1][1] = 1; F[1][2] =  distance * c;
+    F[2][0] = 0; F[2][1] = 0; F[2][2] = 1;
+
+    // Jacobian of the motion with respect to the left and right wheel distances
+    G[0][0] = 0.5f*c + distance*s / (2.0f*WIDTH_MM);  G[0][1] = 0.5f*c - distance*s / (2.0f*WIDTH_MM);
+    G[1][0] = 0.5f*s - distance*c / (2.0f*WIDTH_MM);  G[1][1] = 0.5f*s + distance*c / (2.0f*WIDTH_MM);
+    G[2][0] = -1.0f / WIDTH_MM;                       G[2][1] = 1.0f / WIDTH_MM;
+
+    // P = F P F' + G Q G'
+    for(i = 0; i < 3; i++){
+        for(j = 0; j < 3; j++){
+            FP[i][j] = 0;
+            for(k = 0; k < 3; k++){
+                FP[i][j] += F[i][k] * EkfP[k][j];
+            }
+        }
+    }
+    for(i = 0; i < 3; i++){
+        for(j = 0; j < 3; j++){
+            EkfP[i][j] = G[i][0]*leftVar*G[j][0] + G[i][1]*rightVar*G[j][1];
+            for(k = 0; k < 3; k++){
+                EkfP[i][j] += FP[i][k] * F[j][k];
+            }
+        }
+    }
+}
+
+
+// ---------- EKF_UpdateBeam ----------
+// Scalar update with one distance sensor reading
+// Inputs: uint32_t reading - measured distance (mm)
+//         float angle - direction of the sensor relative to the heading (radians)
+// Output: uint32_t - 1 if the reading was used, 0 if it was rejected
+static uint32_t EKF_UpdateBeam(uint32_t reading, float angle){
+    float sensorX, sensorY, beam, expected, nx, ny, incidence, offset;
+    float H[3], PH[3], S, R, K[3], innovation, A[3][3], AP[3][3];
+    uint32_t wall, i, j, k;
+
+    if(reading > EKF_MAX_RANGE_MM){
+        return 0;
+    }
+
+    // Expected distance to the known walls along the beam
+    sensorX = EkfState[0] + SENSOR_OFFSET_MM * cosf(EkfState[2]);
+    sensorY = EkfState[1] + SENSOR_OFFSET_MM * sinf(EkfState[2]);
+    beam = EkfState[2] + angle;
+    expected = Arena_Raycast(sensorX, sensorY, beam, 2.0f * EKF_MAX_RANGE_MM, &wall);
+    if(wall == ARENA_NO_WALL){
+        return 0;
+    }
+
+    // Unit normal of the wall, facing the sensor
+    nx = (float)(ArenaWalls[wall].y0 - ArenaWalls[wall].y1);
+    ny = (float)(ArenaWalls[wall].x1 - ArenaWalls[wall].x0);
+    incidence = sqrtf(nx*nx + ny*ny);
+    nx /= incidence;
+    ny /= incidence;
+    incidence = nx*cosf(beam) + ny*sinf(beam);
+    if(incidence > 0){
+        nx = -nx;
+        ny = -ny;
+        incidence = -incidence;
+    }
+    if(-incidence < EKF_MIN_INCIDENCE){
+        return 0;
+    }
+
+    // Jacobian of the distance to the wall plane: expected = (c - n.sensor) / (n.beam)
+    offset = nx*(-SENSOR_OFFSET_MM * sinf(EkfState[2])) + ny*(SENSOR_OFFSET_MM * cosf(EkfState[2]));
+    H[0] = -nx / incidence;
+    H[1] = -ny / incidence;
+    H[2] = -offset / incidence - expected * (nx*(-sinf(beam)) + ny*cosf(beam)) / incidence;
+
+    // Innovation covariance, gated to reject unmapped obstacles
+    for(i = 0; i < 3; i++){
+        PH[i] = EkfP[i][0]*H[0] + EkfP[i][1]*H[1] + EkfP[i][2]*H[2];
+    }
+    R = EKF_RANGE_NOISE_MM + EKF_RANGE_NOISE_FRAC * (float)reading;
+    R *= R;
+    S = H[0]*PH[0] + H[1]*PH[1] + H[2]*PH[2] + R;
+    innovation = (float)reading - expected;
+    if(innovation * innovation > EKF_GATE * S){
+        return 0;
+    }
+
+    // State update
+    for(i = 0; i < 3; i++){
+        K[i] = PH[i] / S;
+        EkfState[i] += K[i] * innovation;
+    }
+
+    // Joseph form keeps P symmetric and positive: P = (I - KH) P (I - KH)' + K R K'
+    for(i = 0; i < 3; i++){
+        for(j = 0; j < 3; j++){
+            A[i][j] = ((i == j) ? 1.0f : 0.0f) - K[i]*H[j];
+        }
+    }
+    for(i = 0; i < 3; i++){
+        for(j = 0; j < 3; j++){
+            AP[i][j] = 0;
+            for(k = 0; k < 3; k++){
+                AP[i][j] += A[i][k] * EkfP[k][j];
+            }
+        }
+    }
+    for(i = 0; i < 3; i++){
+        for(j = 0; j < 3; j++){
+            EkfP[i][j] = K[i]*R*K[j];
+            for(k = 0; k < 3; k++){
+                EkfP[i][j] += AP[i][k] * A[j][k];
+            }
+        }
+    }
+
+    return 1;
+}
+
+
+// ---------- EKF_Update ----------
+// Corrects the estimate with the distance sensor readings
+// Inputs: uint32_t leftDist, centerDist, rightDist - readings from Distance_GetDistances (mm)
+// Output: uint32_t - number of readings that were used
+uint32_t EKF_Update(uint32_t leftDist, uint32_t centerDist, uint32_t rightDist){
+    uint32_t used = 0;
+
+    used += EKF_UpdateBeam(centerDist, 0);
+    used += EKF_UpdateBeam(leftDist, SIDE_SENSOR_ANGLE * PI / 180.0f);
+    used += EKF_UpdateBeam(rightDist, -SIDE_SENSOR_ANGLE * PI / 180.0f);
+
+    return used;
+}
+
+
+// ---------- EKF_GetEstimate ----------
+// Copies out the current pose estimate and covariance
+// Inputs: EKF_Estimate* estimate - pointer to store the estimate
+// Output: none
+void EKF_GetEstimate(EKF_Estimate* estimate){
+    uint32_t i, j;
+
+    estimate->xPos = EkfState[0];
+    estimate->yPos = EkfState[1];
+    estimate->heading = EkfState[2] * 180.0f / PI;
+    for(i = 0; i < 3; i++){
+        for(j = 0; j < 3; j++){
+            estimate->covariance[i][j] = EkfP[i][j];
+        }
+    }
+}
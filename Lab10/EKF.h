@@ -0,0 +1,50 @@
+#ifndef EKF_H
+#define EKF_H
+
+#include "Odometry.h"
+#include "Arena.h"
+
+/*
+ * Extended Kalman filter for the robot's pose (x, y, heading).
+ *
+ * Predict: differential drive model driven by the distance each wheel moved, with
+ *          wheel noise whose variance grows with the distance driven.
+ * Update:  each distance sensor reading is compared with the distance to the known
+ *          wall (Arena.h) along that sensor's beam. Readings that are out of range,
+ *          hit a wall too obliquely, or disagree with the map by more than
+ *          EKF_GATE standard deviations (an unmapped obstacle) are rejected.
+ *
+ * All matrices are fixed size single precision, so the filter uses no heap and
+ * about 60 bytes of state. Each update is a scalar Kalman update per sensor.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#define EKF_WHEEL_NOISE      0.5f   /* Wheel distance variance per mm driven (mm^2/mm)            */
+#define EKF_RANGE_NOISE_MM   10.0f  /* Constant part of the distance sensor noise (mm)            */
+#define EKF_RANGE_NOISE_FRAC 0.05f  /* Distance sensor noise that grows with the distance (1/mm) */
+#define EKF_MAX_RANGE_MM     600    /* Readings further than this are not used (mm)               */
+#define EKF_MIN_INCIDENCE    0.5f   /* Smallest cosine between a beam and the wall's normal       */
+#define EKF_GATE             9.0f   /* Largest squared normalized innovation that is accepted    */
+
+#define EKF_INIT_POS_VAR     25.0f  /* Initial position variance (mm^2)                           */
+#define EKF_INIT_HEADING_VAR 0.0003f /* Initial heading variance (rad^2, about 1 degree)          */
+
+
+// Pose estimate and its covariance, in mm and radians (heading in degrees for display)
+typedef struct EKF_Estimate{
+    float xPos;
+    float yPos;
+    float heading;       // Degrees
+    float covariance[3][3];
+} EKF_Estimate;
+
+
+// --------------------- Function Prototypes ---------------------
+void EKF_Init(float xPos, float yPos, float heading);
+void EKF_Predict(float leftDist, float rightDist);
+uint32_t EKF_Update(uint32_t leftDist, uint32_t centerDist, uint32_t rightDist);
+void EKF_GetEstimate(EKF_Estimate* estimate);
+
+#endif
@@ -0,0 +1,192 @@
+#include "msp.h"
+#include "Journal.h"
+
+
+JournalLog Journal;
+
+// Tachometer edges counted by the interrupts since the last read, for each wheel
+static volatile uint16_t JournalForward[2];
+static volatile uint16_t JournalBackward[2];
+static volatile uint32_t JournalTicks[2];
+
+static uint32_t JournalLastRead;  // Offset of the last JOURNAL_READ record
+static uint8_t JournalActive;     // 1 once Journal_Init has been called and until the journal is full
+
+
+// ---------- Journal_Reserve ----------
+// Makes room for a record
+// Inputs: uint32_t bytes - size of the record
+// Output: uint8_t* - where to write the record, or 0 if the journal is full
+static uint8_t* Journal_Reserve(uint32_t bytes){
+    uint8_t* record;
+
+    if(!JournalActive){
+        return 0;
+    }
+    if(Journal.length + bytes > JOURNAL_SIZE){
+        // Stop for good, so the journal stays a complete start of the run
+        Journal.full = 1;
+        JournalActive = 0;
+        return 0;
+    }
+
+    record = &Journal.data[Journal.length];
+    Journal.length += bytes;
+    return record;
+}
+
+
+// ---------- Journal_Put16 ----------
+static void Journal_Put16(uint8_t* dest, uint32_t value){
+    dest[0] = value & 0xFF;
+    dest[1] = (value >> 8) & 0xFF;
+}
+
+
+// ---------- Journal_Init ----------
+// Clears the journal and starts recording
+// Inputs: uint32_t mode - NAVIGATION_MODE of the program, so the replay runs the same code
+// Output: none
+void Journal_Init(uint32_t mode){
+    uint32_t side;
+
+    Journal.magic = JOURNAL_MAGIC;
+    Journal.version = JOURNAL_VERSION;
+    Journal.mode = mode;
+    Journal.full = 0;
+    Journal.length = 0;
+    for(side = 0; side < 2; side++){
+        JournalForward[side] = 0;
+        JournalBackward[side] = 0;
+        JournalTicks[side] = 0;
+    }
+    JournalLastRead = JOURNAL_SIZE;
+    JournalActive = 1;
+}
+
+
+// ---------- Journal_ADC ----------
+// Records the result of ADC_In17_14_16
+// Inputs: uint32_t ch17, ch14, ch16 - ADC results
+// Output: none
+void Journal_ADC(uint32_t ch17, uint32_t ch14, uint32_t ch16){
+    uint8_t* record = Journal_Reserve(JOURNAL_ADC_BYTES);
+
+    if(record){
+        record[0] = JOURNAL_ADC;
+        Journal_Put16(&record[1], TIMER_A3->R);
+        Journal_Put16(&record[3], ch17);
+        Journal_Put16(&record[5], ch14);
+        Journal_Put16(&record[7], ch16);
+    }
+}
+
+
+// ---------- Journal_TachEdge ----------
+// Counts a tachometer edge. Called from the tachometer interrupts.
+// Inputs: uint32_t side - JOURNAL_LEFT or JOURNAL_RIGHT
+//         uint16_t interval - capture time since the wheel's last edge
+//         uint32_t forward - 1 if the wheel stepped forward, 0 if backward
+// Output: none
+void Journal_TachEdge(uint32_t side, uint16_t interval, uint32_t forward){
+    if(forward){
+        JournalForward[side]++;
+    } else {
+        JournalBackward[side]++;
+    }
+    JournalTicks[side] += interval;
+}
+
+
+// ---------- Journal_TachFlush ----------
+// Writes out the edges one wheel counted since the last read, splitting them
+// into records of at most 255 edges in each direction
+// Inputs: uint32_t side - JOURNAL_LEFT or JOURNAL_RIGHT
+// Output: none
+static void Journal_TachFlush(uint32_t side){
+    uint32_t forward = JournalForward[side], backward = JournalBackward[side];
+    uint32_t ticks = JournalTicks[side], f, b, t;
+    uint8_t* record;
+
+    JournalForward[side] = 0;
+    JournalBackward[side] = 0;
+    JournalTicks[side] = 0;
+
+    while(forward + backward > 0){
+        f = (forward > 255) ? 255 : forward;
+        b = (backward > 255) ? 255 : backward;
+        // Share the time in proportion to the edges, the last record takes the rest
+        t = (f + b == forward + backward) ? ticks : (uint32_t)((uint64_t)ticks * (f + b) / (forward + backward));
+        record = Journal_Reserve(JOURNAL_TACH_BYTES);
+        if(record == 0){
+            return;
+        }
+        record[0] = JOURNAL_TACH | side;
+        record[1] = f;
+        record[2] = b;
+        record[3] = t & 0xFF;
+        record[4] = (t >> 8) & 0xFF;
+        record[5] = (t >> 16) & 0xFF;
+        forward -= f;
+        backward -= b;
+        ticks -= t;
+    }
+}
+
+
+// ---------- Journal_TachReadStart ----------
+// Records a tachometer read. Interrupts stay disabled until Journal_TachReadEnd,
+// so no edge can land between the record and the values the program reads.
+// Inputs: none
+// Output: uint32_t - interrupt state to pass to Journal_TachReadEnd
+uint32_t Journal_TachReadStart(void){
+    uint32_t primask = __get_PRIMASK();
+    uint8_t* record;
+
+    __disable_irq();
+    if(!JournalActive){
+        return primask;
+    }
+
+    Journal_TachFlush(JOURNAL_LEFT);
+    Journal_TachFlush(JOURNAL_RIGHT);
+
+    // Reads with no edges in between share one record
+    if(JournalLastRead + 1 == Journal.length && (Journal.data[JournalLastRead] & 0x0F) < JOURNAL_MAX_REPEATS - 1){
+        Journal.data[JournalLastRead]++;
+    } else {
+        record = Journal_Reserve(1);
+        if(record){
+            record[0] = JOURNAL_READ;
+            JournalLastRead = Journal.length - 1;
+        }
+    }
+
+    return primask;
+}
+
+
+// ---------- Journal_TachReadEnd ----------
+// Restores interrupts after a tachometer read
+// Inputs: uint32_t primask - value returned by Journal_TachReadStart
+// Output: none
+void Journal_TachReadEnd(uint32_t primask){
+    __set_PRIMASK(primask);
+}
+
+
+// ---------- Journal_Motor ----------
+// Records a motor command
+// Inputs: uint32_t command - JOURNAL_MOTOR_STOP, FORWARD, RIGHT, LEFT or BACKWARD
+//         uint16_t leftDuty, rightDuty - duty cycles of the command
+// Output: none
+void Journal_Motor(uint32_t command, uint16_t leftDuty, uint16_t rightDuty){
+    uint8_t* record = Journal_Reserve(JOURNAL_MOTOR_BYTES);
+
+    if(record){
+        record[0] = JOURNAL_MOTOR | command;
+        Journal_Put16(&record[1], TIMER_A3->R);
+        Journal_Put16(&record[3], leftDuty);
+        Journal_Put16(&record[5], rightDuty);
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+
+/*
+ * Journal of everything the navigation code reads from and writes to the robot,
+ * so that a run can be replayed on the host (Host/Replay.c) and reproduce the
+ * same motor commands.
+ *
+ * Records are packed bytes in the order they happened. The first byte holds the
+ * record type in the high nibble:
+ *   JOURNAL_ADC    time(2) ch17(2) ch14(2) ch16(2)   every ADC_In17_14_16 result
+ *   JOURNAL_TACH   forward(1) backward(1) ticks(3)   tachometer edges of one wheel
+ *                  since the last read (low nibble = JOURNAL_LEFT/RIGHT)
+ *   JOURNAL_READ                                     a tachometer read (low nibble =
+ *                                                    repeated reads - 1)
+ *   JOURNAL_MOTOR  time(2) left(2) right(2)          every motor command (low nibble =
+ *                                                    JOURNAL_MOTOR_STOP, ...)
+ * Times are Timer A3 counts, the same clock as the tachometer captures. Multi-byte
+ * fields are little endian.
+ *
+ * The tachometer interrupts only count edges and add up capture intervals; the
+ * counts are written out when the main program reads the tachometer. Steps and
+ * time totals are all the program can see, so this reproduces every read exactly
+ * at a few bytes per controller period instead of per edge.
+ *
+ * Recording is opt-in: predefine JOURNAL_RECORD (Lab10 project settings, as
+ * PARAMS_LIVE) to have the drivers and main.c record. Without it (the default, and
+ * Bench) the drivers record nothing and Journal.c is not needed.
+ *
+ * Recording stops when the journal is full, so the journal is always the start of
+ * the run. To save it, halt the program in CCS and save JOURNAL_HEADER_BYTES +
+ * Journal.length bytes of memory starting at &Journal to a binary file.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#ifndef JOURNAL_SIZE
+#define JOURNAL_SIZE         16384       /* Bytes of records (about 12 s of driving)   */
+#endif
+#define JOURNAL_MAGIC        0x4C4E524A  /* "JRNL" at the start of a saved journal     */
+#define JOURNAL_VERSION      1
+#define JOURNAL_HEADER_BYTES 12          /* Bytes in front of the records              */
+
+#define JOURNAL_ADC          0x10
+#define JOURNAL_TACH         0x20
+#define JOURNAL_READ         0x30
+#define JOURNAL_MOTOR        0x40
+#define JOURNAL_TYPE_MASK    0xF0
+
+#define JOURNAL_ADC_BYTES    9
+#define JOURNAL_TACH_BYTES   6
+#define JOURNAL_MOTOR_BYTES  7
+#define JOURNAL_MAX_REPEATS  16          /* Reads merged into one JOURNAL_READ record  */
+
+#define JOURNAL_LEFT         0
+#define JOURNAL_RIGHT        1
+
+#define JOURNAL_MOTOR_STOP     0
+#define JOURNAL_MOTOR_FORWARD  1
+#define JOURNAL_MOTOR_RIGHT    2
+#define JOURNAL_MOTOR_LEFT     3
+#define JOURNAL_MOTOR_BACKWARD 4
+
+
+// Journal as it is laid out in memory
+typedef struct JournalLog{
+    uint32_t magic;
+    uint16_t version;
+    uint8_t mode;        // NAVIGATION_MODE of the recorded program
+    uint8_t full;        // 1 if records were dropped because the journal filled up
+    uint32_t length;     // Bytes of records
+    uint8_t data[JOURNAL_SIZE];
+} JournalLog;
+
+extern JournalLog Journal;
+
+
+// --------------------- Function Prototypes ---------------------
+void Journal_Init(uint32_t mode);
+void Journal_ADC(uint32_t ch17, uint32_t ch14, uint32_t ch16);
+void Journal_TachEdge(uint32_t side, uint16_t interval, uint32_t forward);
+uint32_t Journal_TachReadStart(void);
+void Journal_TachReadEnd(uint32_t primask);
+void Journal_Motor(uint32_t command, uint16_t leftDuty, uint16_t rightDuty);
+
+#endif
@@ -0,0 +1,205 @@
+#include <stdint.h>
+#include "msp.h"
+#include "RobotLights.h"
+#include "Lights.h"
+
+
+// Steps of each pattern
+static const LightsStep LightsOff[] = {
+    {0, 0, 0, 0, 0}
+};
+static const LightsStep LightsOn[] = {
+    {LIGHTS_FULL, 0, LIGHTS_WHITE, LIGHTS_FULL, 0}
+};
+static const LightsStep LightsBlinkSlow[] = {
+    {LIGHTS_FULL, 0, LIGHTS_WHITE, LIGHTS_FULL, 500},
+    {0,           0, 0,            0,           500}
+};
+static const LightsStep LightsBlinkFast[] = {
+    {LIGHTS_FULL, 0, LIGHTS_WHITE, LIGHTS_FULL, 125},
+    {0,           0, 0,            0,           125}
+};
+static const LightsStep LightsBraking[] = {
+    {0, LIGHTS_FULL, LIGHTS_RED, LIGHTS_FULL/4, 0}
+};
+static const LightsStep LightsObstacle[] = {
+    {LIGHTS_FULL, 0,           LIGHTS_YELLOW, LIGHTS_FULL, 150},
+    {0,           LIGHTS_FULL, LIGHTS_YELLOW, 0,           150}
+};
+static const LightsStep LightsWaiting[] = {
+    {0, 0, LIGHTS_BLUE, 2,           100},
+    {0, 0, LIGHTS_BLUE, 4,           100},
+    {0, 0, LIGHTS_BLUE, 8,           100},
+    {0, 0, LIGHTS_BLUE, LIGHTS_FULL, 200},
+    {0, 0, LIGHTS_BLUE, 8,           100},
+    {0, 0, LIGHTS_BLUE, 4,           100},
+    {0, 0, LIGHTS_BLUE, 2,           100},
+    {0, 0, LIGHTS_BLUE, 0,           1200}
+};
+static const LightsStep LightsFault[] = {
+    {0, LIGHTS_FULL, LIGHTS_RED, LIGHTS_FULL, 150},
+    {0, 0,           LIGHTS_RED, 0,           150},
+    {0, LIGHTS_FULL, LIGHTS_RED, LIGHTS_FULL, 150},
+    {0, 0,           LIGHTS_RED, 0,           150},
+    {0, LIGHTS_FULL, LIGHTS_RED, LIGHTS_FULL, 150},
+    {0, 0,           LIGHTS_RED, 0,           1000}
+};
+static const LightsStep LightsChase[] = {
+    {LIGHTS_FULL, 0,           LIGHTS_WHITE, LIGHTS_FULL, 200},
+    {0,           LIGHTS_FULL, 0,            0,           200},
+    {0,           0,           0,            0,           200},
+    {LIGHTS_FULL, 0,           LIGHTS_WHITE, LIGHTS_FULL, 200},
+    {0,           LIGHTS_FULL, 0,            0,           200},
+    {0,           0,           0,            0,           200},
+    {LIGHTS_FULL, 0,           LIGHTS_WHITE, LIGHTS_FULL, 200},
+    {0,           LIGHTS_FULL, 0,            0,           200},
+    {0,           0,           0,            0,           200},
+    {LIGHTS_FULL, 0,           LIGHTS_WHITE, LIGHTS_FULL, 200},
+    {0,           LIGHTS_FULL, 0,            0,           200},
+    {0,           0,           0,            0,           200},
+    {LIGHTS_FULL, 0,           LIGHTS_WHITE, LIGHTS_FULL, 200},
+    {0,           LIGHTS_FULL, 0,            0,           200},
+    {0,           0,           0,            0,           200},
+    {LIGHTS_FULL, LIGHTS_FULL, LIGHTS_WHITE, LIGHTS_FULL, 1000},
+    {0,           0,           0,            0,           1000}
+};
+static const LightsStep LightsBleConnected[] = {
+    {0, 0, LIGHTS_BLUE, LIGHTS_FULL/2, 0}
+};
+
+// Steps and number of steps of a pattern
+typedef struct LightsList{
+    const LightsStep* steps;
+    uint32_t count;
+} LightsList;
+
+#define LIGHTS_LIST(STEPS) {STEPS, sizeof(STEPS)/sizeof(STEPS[0])}
+
+// Pattern of each pattern number (LIGHTS_NONE never plays its steps)
+static const LightsList LightsTable[LIGHTS_PATTERNS] = {
+    LIGHTS_LIST(LightsOff),          // LIGHTS_NONE
+    LIGHTS_LIST(LightsOff),          // LIGHTS_OFF
+    LIGHTS_LIST(LightsOn),           // LIGHTS_ON
+    LIGHTS_LIST(LightsBlinkSlow),    // LIGHTS_BLINK_SLOW
+    LIGHTS_LIST(LightsBlinkFast),    // LIGHTS_BLINK_FAST
+    LIGHTS_LIST(LightsBraking),      // LIGHTS_BRAKING
+    LIGHTS_LIST(LightsObstacle),     // LIGHTS_OBSTACLE
+    LIGHTS_LIST(LightsWaiting),      // LIGHTS_WAITING
+    LIGHTS_LIST(LightsFault),        // LIGHTS_FAULT
+    LIGHTS_LIST(LightsChase),        // LIGHTS_CHASE
+    LIGHTS_LIST(LightsBleConnected)  // LIGHTS_BLE_CONNECTED
+};
+
+static volatile uint32_t LightsRequest;     // Pattern asked for by the main program
+static volatile uint8_t LightsBrightness;   // Scales every step, 0 to LIGHTS_FULL
+static uint32_t LightsCurrent;              // Pattern being played (interrupt only)
+static uint32_t LightsStepI;                // Step being played
+static uint32_t LightsTicks;                // Ticks since the step started
+static uint32_t LightsPhase;                // Tick within the PWM period, 0 to LIGHTS_LEVELS-1
+static uint8_t LightsFront, LightsBack, LightsColorLevel;  // Brightness of the step, scaled
+
+
+// ---------- Lights_Init ----------
+// Initializes the LEDs and starts the Timer32 2 interrupt, with no pattern
+// Inputs: none
+// Output: none
+void Lights_Init(void){
+    MvtLED_Init();
+    P2->SEL0 &= ~0x07;
+    P2->SEL1 &= ~0x07;                                       // P2.0-2 BGR LED as GPIO
+    P2->DIR |= 0x07;                                         // Make P2.0-2 outputs
+    P2->OUT &= ~0x07;                                        // BGR LED off
+    LightsRequest = LIGHTS_NONE;
+    LightsCurrent = LIGHTS_NONE;
+    LightsBrightness = LIGHTS_FULL;
+    LightsPhase = 0;
+
+    // Timer32 2 interrupt at LIGHTS_TICK_HZ: MCLK 48 MHz / 24000 = 2 kHz
+    TIMER32_2->CONTROL = 0;                                  // Disable during setup
+    TIMER32_2->LOAD = 48000000/LIGHTS_TICK_HZ - 1;
+    TIMER32_2->INTCLR = 0;
+    NVIC->IP[6] = (NVIC->IP[6]&0xFF00FFFF) | 0x00C00000;     // Priority 6, below the sensors and motors
+    NVIC->ISER[0] = 0x04000000;                              // T32_INT2 is interrupt 26
+    TIMER32_2->CONTROL = 0x000000E2;                         // Enable, periodic, interrupt, /1, 32-bit
+}
+
+
+// ---------- Lights_SetPattern ----------
+// Plays a pattern from its first step, from the next interrupt. Asking for the
+// pattern already playing keeps it going, so it can be called every loop
+// Inputs: uint32_t pattern - LIGHTS_NONE, LIGHTS_OFF, ... (others are ignored)
+// Output: none
+void Lights_SetPattern(uint32_t pattern){
+    if(pattern < LIGHTS_PATTERNS){
+        LightsRequest = pattern;
+    }
+}
+
+
+// ---------- Lights_SetBrightness ----------
+// Dims every pattern, from the next PWM period
+// Inputs: uint8_t level - 0 (off) to LIGHTS_FULL (as in the patterns)
+// Output: none
+void Lights_SetBrightness(uint8_t level){
+    LightsBrightness = (level > LIGHTS_FULL) ? LIGHTS_FULL : level;
+}
+
+
+// ---------- Lights_Load ----------
+// Scales the brightness of the current step
+static void Lights_Load(void){
+    const LightsStep* step = &LightsTable[LightsCurrent].steps[LightsStepI];
+    uint32_t brightness = LightsBrightness;
+
+    LightsFront = (step->front * brightness) / LIGHTS_FULL;
+    LightsBack = (step->back * brightness) / LIGHTS_FULL;
+    LightsColorLevel = (step->colorLevel * brightness) / LIGHTS_FULL;
+}
+
+
+// every 1/LIGHTS_TICK_HZ s
+void T32_INT2_IRQHandler(void){
+    const LightsList* list;
+    uint8_t p8 = 0, p2 = 0;
+
+    TIMER32_2->INTCLR = 0;    // ACK
+    if(LightsRequest != LightsCurrent){
+        LightsCurrent = LightsRequest;
+        LightsStepI = 0;
+        LightsTicks = 0;
+        Lights_Load();
+        if(LightsCurrent == LIGHTS_NONE){
+            P8->OUT &= ~0xE1;   // Leave them off for the RobotLights functions
+            P2->OUT &= ~0x07;
+        }
+    }
+    if(LightsCurrent == LIGHTS_NONE){
+        return;
+    }
+
+    // Next step once this one has lasted its time
+    list = &LightsTable[LightsCurrent];
+    LightsTicks++;
+    if(list->steps[LightsStepI].time && (LightsTicks >= list->steps[LightsStepI].time*LIGHTS_TICKS_PER_MS)){
+        LightsStepI = (LightsStepI + 1 < list->count) ? LightsStepI + 1 : 0;
+        LightsTicks = 0;
+        Lights_Load();
+    }
+
+    // Software PWM: on for the first (brightness) ticks of each period
+    LightsPhase = (LightsPhase + 1) & (LIGHTS_LEVELS - 1);
+    if(LightsPhase == 0){
+        Lights_Load();   // Brightness changes
+    }
+    if(LightsFront > LightsPhase){
+        p8 |= 0x21;
+    }
+    if(LightsBack > LightsPhase){
+        p8 |= 0xC0;
+    }
+    if(LightsColorLevel > LightsPhase){
+        p2 = list->steps[LightsStepI].color;
+    }
+    P8->OUT = (P8->OUT & ~0xE1) | p8;
+    P2->OUT = (P2->OUT & ~0x07) | p2;
+}
@@ -0,0 +1,461 @@
+#include "MCL.h"
+#if MCL_MAX_THREADS > 1
+#include <pthread.h>
+#endif
+
+
+// Particle store: two sets of arrays, the current set and the one resampling fills
+static float MclX[2][MCL_MAX_PARTICLES];
+static float MclY[2][MCL_MAX_PARTICLES];
+static float MclHeading[2][MCL_MAX_PARTICLES];   // Radians
+static float MclCos[2][MCL_MAX_PARTICLES];       // Cosine of the heading
+static float MclSin[2][MCL_MAX_PARTICLES];       // Sine of the heading
+static uint16_t MclWeight[MCL_MAX_PARTICLES];    // Q15
+static uint32_t MclSet;                          // Index of the current set
+static uint32_t MclNum;                          // Particles in use
+
+// Likelihood of an error of i/MCL_LUT_STEPS standard deviations (Q15)
+static uint16_t MclLikelihood[MCL_LUT_SIZE];
+// MCL_LUT_STEPS divided by the standard deviation of each sensor at each distance bin (Q16)
+static uint32_t MclInvSigma[3][MCL_RANGE_BINS];
+static uint8_t MclTablesReady;
+
+// Parameters of the stage being run by the particle loops
+static float MclLeftDist, MclRightDist, MclLeftSigma, MclRightSigma;
+static uint32_t MclReading[3];
+static float MclBeamCos, MclBeamSin;             // Direction of the left sensor relative to the heading
+
+static uint32_t MclSeed[MCL_MAX_THREADS];
+static uint32_t MclThreads = 1;
+
+// Beams in the order of MclReading and MclInvSigma
+#define MCL_CENTER 0
+#define MCL_LEFT   1
+#define MCL_RIGHT  2
+
+typedef void (*MclStage)(uint32_t begin, uint32_t end, uint32_t thread);
+
+
+// ---------- MCL_Random ----------
+// Xorshift random number generator
+// Inputs: uint32_t* seed - state of the generator
+// Output: uint32_t - random number
+static uint32_t MCL_Random(uint32_t* seed){
+    uint32_t x = *seed;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *seed = x;
+    return x;
+}
+
+
+// ---------- MCL_Gaussian ----------
+// Approximately normal random number from the sum of four random bytes
+// Inputs: uint32_t* seed - state of the generator
+// Output: float - random number with mean 0 and standard deviation 1
+static float MCL_Gaussian(uint32_t* seed){
+    uint32_t r = MCL_Random(seed);
+    int32_t sum = (int32_t)((r & 0xFF) + ((r >> 8) & 0xFF) + ((r >> 16) & 0xFF) + (r >> 24));
+
+    return (float)(sum - 510) * (1.0f / 147.8f);
+}
+
+
+// ---------- MCL_SensorSigma ----------
+// Standard deviation of a distance sensor at a distance, from the slope of its
+// formula in Distance_ComputeDistance times the ADC noise
+// Inputs: uint32_t distance - distance (mm)
+//         char side - sensor formula, as for Distance_ComputeDistance
+// Output: float - standard deviation (mm)
+static float MCL_SensorSigma(uint32_t distance, char side){
+    uint32_t low = 1, high = 16383, adc;
+    float slope;
+
+    // The formulas fall with the ADC value, so search for the reading of this distance
+    while(high - low > 1){
+        adc = (low + high) / 2;
+        if(Distance_ComputeDistance(adc, side) > distance){
+            low = adc;
+        } else {
+            high = adc;
+        }
+    }
+    adc = (high > 16) ? high : 16;
+    slope = ((float)Distance_ComputeDistance(adc - 16, side) - (float)Distance_ComputeDistance(adc + 16, side)) / 32.0f;
+    slope *= MCL_ADC_NOISE;
+
+    return sqrtf(slope*slope + MCL_RANGE_NOISE_MM*MCL_RANGE_NOISE_MM);
+}
+
+
+// ---------- MCL_BuildTables ----------
+// Fills the likelihood and sensor noise tables
+// Inputs: none
+// Output: none
+static void MCL_BuildTables(void){
+    static const char sides[3] = {CENTER_DISTANCE_SENSOR, RIGHT_DISTANCE_SENSOR, LEFT_DISTANCE_SENSOR};
+    float e;
+    uint32_t i, b;
+
+    for(i = 0; i < MCL_LUT_SIZE; i++){
+        e = (float)i / MCL_LUT_STEPS;
+        MclLikelihood[i] = (uint16_t)(MCL_FLOOR + (MCL_ONE - MCL_FLOOR) * expf(-0.5f * e * e));
+    }
+
+    // The left reading comes from the right formula and vice versa (see Distance_ComputeDistances)
+    for(b = 0; b < 3; b++){
+        for(i = 0; i < MCL_RANGE_BINS; i++){
+            MclInvSigma[b][i] = (uint32_t)(MCL_LUT_STEPS * 65536.0f / MCL_SensorSigma(i * MCL_BIN_MM + MCL_BIN_MM / 2, sides[b]));
+        }
+    }
+
+    MclBeamCos = cosf(SIDE_SENSOR_ANGLE * PI / 180.0f);
+    MclBeamSin = sinf(SIDE_SENSOR_ANGLE * PI / 180.0f);
+    MclTablesReady = 1;
+}
+
+
+#if MCL_MAX_THREADS > 1
+// Part of a particle loop run by one thread
+typedef struct MclJob{
+    MclStage stage;
+    uint32_t begin, end, thread;
+} MclJob;
+
+// ---------- MCL_Worker ----------
+static void* MCL_Worker(void* arg){
+    MclJob* job = (MclJob*)arg;
+
+    job->stage(job->begin, job->end, job->thread);
+    return 0;
+}
+#endif
+
+
+// ---------- MCL_RunStage ----------
+// Runs a particle loop over all particles, split between the threads
+// Inputs: MclStage stage - loop to run
+// Output: none
+static void MCL_RunStage(MclStage stage){
+#if MCL_MAX_THREADS > 1
+    pthread_t threads[MCL_MAX_THREADS];
+    MclJob jobs[MCL_MAX_THREADS];
+    uint32_t t;
+
+    if(MclThreads > 1){
+        for(t = 0; t < MclThreads; t++){
+            jobs[t].stage = stage;
+            jobs[t].begin = MclNum * t / MclThreads;
+            jobs[t].end = MclNum * (t + 1) / MclThreads;
+            jobs[t].thread = t;
+        }
+        for(t = 1; t < MclThreads; t++){
+            pthread_create(&threads[t], 0, MCL_Worker, &jobs[t]);
+        }
+        MCL_Worker(&jobs[0]);
+        for(t = 1; t < MclThreads; t++){
+            pthread_join(threads[t], 0);
+        }
+        return;
+    }
+#endif
+    stage(0, MclNum, 0);
+}
+
+
+// ---------- MCL_Init ----------
+// Spreads the particles around a starting pose
+// Inputs: float xPos, yPos - position (mm)
+//         float heading - heading (degrees)
+//         float posSpread - standard deviation of the position (mm)
+//         float headingSpread - standard deviation of the heading (degrees)
+//         uint32_t numParticles - particles to use, up to MCL_MAX_PARTICLES
+// Output: none
+void MCL_Init(float xPos, float yPos, float heading, float posSpread, float headingSpread, uint32_t numParticles){
+    float* x;
+    float* y;
+    float* h;
+    uint32_t i;
+
+    if(!MclTablesReady){
+        MCL_BuildTables();
+    }
+    for(i = 0; i < MCL_MAX_THREADS; i++){
+        MclSeed[i] = 0x2545F491u + 0x9E3779B9u * i;
+    }
+
+    MclNum = (numParticles < MCL_MAX_PARTICLES) ? numParticles : MCL_MAX_PARTICLES;
+    MclSet = 0;
+    x = MclX[0];
+    y = MclY[0];
+    h = MclHeading[0];
+    for(i = 0; i < MclNum; i++){
+        x[i] = xPos + posSpread * MCL_Gaussian(&MclSeed[0]);
+        y[i] = yPos + posSpread * MCL_Gaussian(&MclSeed[0]);
+        h[i] = (heading + headingSpread * MCL_Gaussian(&MclSeed[0])) * PI / 180.0f;
+        MclCos[0][i] = cosf(h[i]);
+        MclSin[0][i] = sinf(h[i]);
+        MclWeight[i] = MCL_ONE;
+    }
+}
+
+
+// ---------- MCL_SetThreads ----------
+// Sets the number of threads that run the particle loops (host builds only)
+// Inputs: uint32_t numThreads - threads, up to MCL_MAX_THREADS
+// Output: none
+void MCL_SetThreads(uint32_t numThreads){
+    MclThreads = (numThreads < 1) ? 1 : (numThreads > MCL_MAX_THREADS) ? MCL_MAX_THREADS : numThreads;
+}
+
+
+// ---------- MCL_PredictStage ----------
+// Moves particles [begin, end) with their own wheel noise
+static void MCL_PredictStage(uint32_t begin, uint32_t end, uint32_t thread){
+    float* restrict x = MclX[MclSet];
+    float* restrict y = MclY[MclSet];
+    float* restrict h = MclHeading[MclSet];
+    float* restrict c = MclCos[MclSet];
+    float* restrict s = MclSin[MclSet];
+    uint32_t* seed = &MclSeed[thread];
+    float left, right, distance, turn;
+    uint32_t i;
+
+    for(i = begin; i < end; i++){
+        left = MclLeftDist + MclLeftSigma * MCL_Gaussian(seed);
+        right = MclRightDist + MclRightSigma * MCL_Gaussian(seed);
+        distance = (left + right) / 2.0f;
+        turn = (right - left) / (float)WIDTH_MM + MCL_HEADING_NOISE * MCL_Gaussian(seed);
+
+        // Motion along the arc's average heading (turns per period are small)
+        x[i] += distance * (c[i] - s[i] * turn / 2.0f);
+        y[i] += distance * (s[i] + c[i] * turn / 2.0f);
+        h[i] += turn;
+        if(h[i] > PI){
+            h[i] -= 2.0f * PI;
+        } else if(h[i] < -PI){
+            h[i] += 2.0f * PI;
+        }
+        c[i] = cosf(h[i]);
+        s[i] = sinf(h[i]);
+    }
+}
+
+
+// ---------- MCL_Predict ----------
+// Moves every particle by the distance each wheel drove, plus noise
+// Inputs: float leftDist - distance the left wheel moved since the last prediction (mm)
+//         float rightDist - distance the right wheel moved since the last prediction (mm)
+// Output: none
+void MCL_Predict(float leftDist, float rightDist){
+    MclLeftDist = leftDist;
+    MclRightDist = rightDist;
+    MclLeftSigma = sqrtf(MCL_WHEEL_NOISE * fabsf(leftDist));
+    MclRightSigma = sqrtf(MCL_WHEEL_NOISE * fabsf(rightDist));
+    MCL_RunStage(MCL_PredictStage);
+}
+
+
+// ---------- MCL_BeamLikelihood ----------
+// Looks up the likelihood of a reading given the expected distance
+// Inputs: uint32_t reading - measured distance (mm)
+//         float expected - distance to the known walls (mm)
+//         const uint32_t* invSigma - sensor noise table of the sensor
+// Output: uint32_t - likelihood (Q15)
+static inline uint32_t MCL_BeamLikelihood(uint32_t reading, float expected, const uint32_t* invSigma){
+    uint32_t bin = (uint32_t)expected / MCL_BIN_MM;
+    float error = (float)reading - expected;
+    uint32_t index, likelihood;
+
+    if(bin >= MCL_RANGE_BINS){
+        bin = MCL_RANGE_BINS - 1;
+    }
+    index = ((uint32_t)fabsf(error) * invSigma[bin]) >> 16;
+    if(index >= MCL_LUT_SIZE){
+        index = MCL_LUT_SIZE - 1;
+    }
+    likelihood = MclLikelihood[index];
+    if(error < 0 && likelihood < MCL_SHORT_FLOOR){
+        likelihood = MCL_SHORT_FLOOR;
+    }
+
+    return likelihood;
+}
+
+
+// ---------- MCL_WeightStage ----------
+// Multiplies the weights of particles [begin, end) by the likelihood of the readings
+static void MCL_WeightStage(uint32_t begin, uint32_t end, uint32_t thread){
+    const float* restrict x = MclX[MclSet];
+    const float* restrict y = MclY[MclSet];
+    const float* restrict c = MclCos[MclSet];
+    const float* restrict s = MclSin[MclSet];
+    float sensorX, sensorY, bc, bs;
+    uint32_t i, wall, likelihood;
+    (void)thread;
+
+    for(i = begin; i < end; i++){
+        sensorX = x[i] + SENSOR_OFFSET_MM * c[i];
+        sensorY = y[i] + SENSOR_OFFSET_MM * s[i];
+        likelihood = MCL_ONE;
+
+        if(MclReading[MCL_CENTER]){
+            likelihood = (likelihood * MCL_BeamLikelihood(MclReading[MCL_CENTER],
+                          Arena_RaycastDir(sensorX, sensorY, c[i], s[i], 2.0f * MCL_MAX_RANGE_MM, &wall),
+                          MclInvSigma[MCL_CENTER])) >> 15;
+        }
+        if(MclReading[MCL_LEFT]){
+            bc = c[i]*MclBeamCos - s[i]*MclBeamSin;
+            bs = s[i]*MclBeamCos + c[i]*MclBeamSin;
+            likelihood = (likelihood * MCL_BeamLikelihood(MclReading[MCL_LEFT],
+                          Arena_RaycastDir(sensorX, sensorY, bc, bs, 2.0f * MCL_MAX_RANGE_MM, &wall),
+                          MclInvSigma[MCL_LEFT])) >> 15;
+        }
+        if(MclReading[MCL_RIGHT]){
+            bc = c[i]*MclBeamCos + s[i]*MclBeamSin;
+            bs = s[i]*MclBeamCos - c[i]*MclBeamSin;
+            likelihood = (likelihood * MCL_BeamLikelihood(MclReading[MCL_RIGHT],
+                          Arena_RaycastDir(sensorX, sensorY, bc, bs, 2.0f * MCL_MAX_RANGE_MM, &wall),
+                          MclInvSigma[MCL_RIGHT])) >> 15;
+        }
+
+        MclWeight[i] = (uint16_t)((MclWeight[i] * likelihood) >> 15);
+    }
+}
+
+
+// ---------- MCL_Resample ----------
+// Low variance resampling: one random offset picks MclNum evenly spaced points
+// along the cumulative weights
+// Inputs: uint32_t total - sum of the weights
+// Output: none
+static void MCL_Resample(uint32_t total){
+    uint32_t next = MclSet ^ 1;
+    uint64_t cumulative, target;
+    uint32_t i, m;
+
+    // Particle i covers cumulative weights [cumulative - weight, cumulative), scaled by MclNum
+    target = MCL_Random(&MclSeed[0]) % total;
+    i = 0;
+    cumulative = (uint64_t)MclWeight[0] * MclNum;
+    for(m = 0; m < MclNum; m++){
+        while(cumulative <= target && i < MclNum - 1){
+            i++;
+            cumulative += (uint64_t)MclWeight[i] * MclNum;
+        }
+        MclX[next][m] = MclX[MclSet][i];
+        MclY[next][m] = MclY[MclSet][i];
+        MclHeading[next][m] = MclHeading[MclSet][i];
+        MclCos[next][m] = MclCos[MclSet][i];
+        MclSin[next][m] = MclSin[MclSet][i];
+        target += total;
+    }
+
+    for(m = 0; m < MclNum; m++){
+        MclWeight[m] = MCL_ONE;
+    }
+    MclSet = next;
+}
+
+
+// ---------- MCL_Update ----------
+// Weighs the particles by the distance sensor readings and resamples them when
+// too few particles carry the weight
+// Inputs: uint32_t leftDist, centerDist, rightDist - readings from Distance_GetDistances (mm)
+// Output: uint32_t - number of readings that were used
+uint32_t MCL_Update(uint32_t leftDist, uint32_t centerDist, uint32_t rightDist){
+    uint32_t used = 0, total = 0, highest = 0, shift = 0, i;
+    uint64_t totalSq = 0;
+
+    MclReading[MCL_CENTER] = (centerDist <= MCL_MAX_RANGE_MM) ? centerDist : 0;
+    MclReading[MCL_LEFT] = (leftDist <= MCL_MAX_RANGE_MM) ? leftDist : 0;
+    MclReading[MCL_RIGHT] = (rightDist <= MCL_MAX_RANGE_MM) ? rightDist : 0;
+    for(i = 0; i < 3; i++){
+        used += (MclReading[i] != 0);
+    }
+    if(used == 0){
+        return 0;
+    }
+
+    MCL_RunStage(MCL_WeightStage);
+
+    // Scale the weights back up so they keep their precision
+    for(i = 0; i < MclNum; i++){
+        if(MclWeight[i] > highest){
+            highest = MclWeight[i];
+        }
+    }
+    if(highest == 0){
+        // No particle agrees with the readings; keep the particles and start over
+        for(i = 0; i < MclNum; i++){
+            MclWeight[i] = MCL_ONE;
+        }
+        return used;
+    }
+    while((highest << shift) < MCL_ONE / 2){
+        shift++;
+    }
+    for(i = 0; i < MclNum; i++){
+        MclWeight[i] <<= shift;
+        total += MclWeight[i];
+        totalSq += (uint32_t)MclWeight[i] * MclWeight[i];
+    }
+
+    // Effective number of particles is total^2 / totalSq
+    if(2 * (uint64_t)total * total < (uint64_t)MclNum * totalSq){
+        MCL_Resample(total);
+    }
+
+    return used;
+}
+
+
+// ---------- MCL_GetEstimate ----------
+// Weighted mean and covariance of the particles
+// Inputs: MCL_Estimate* estimate - pointer to store the estimate
+// Output: none
+void MCL_GetEstimate(MCL_Estimate* estimate){
+    const float* x = MclX[MclSet];
+    const float* y = MclY[MclSet];
+    const float* h = MclHeading[MclSet];
+    float total = 0, sumX = 0, sumY = 0, sumCos = 0, sumSin = 0, w, d[3], heading;
+    float cov[3][3] = {{0}};
+    uint32_t i, j, k;
+
+    for(i = 0; i < MclNum; i++){
+        w = MclWeight[i];
+        total += w;
+        sumX += w * x[i];
+        sumY += w * y[i];
+        sumCos += w * MclCos[MclSet][i];
+        sumSin += w * MclSin[MclSet][i];
+    }
+    estimate->xPos = sumX / total;
+    estimate->yPos = sumY / total;
+    heading = atan2f(sumSin, sumCos);
+    estimate->heading = heading * 180.0f / PI;
+
+    for(i = 0; i < MclNum; i++){
+        w = MclWeight[i] / total;
+        d[0] = x[i] - estimate->xPos;
+        d[1] = y[i] - estimate->yPos;
+        d[2] = h[i] - heading;
+        if(d[2] > PI){
+            d[2] -= 2.0f * PI;
+        } else if(d[2] < -PI){
+            d[2] += 2.0f * PI;
+        }
+        for(j = 0; j < 3; j++){
+            for(k = 0; k < 3; k++){
+                cov[j][k] += w * d[j] * d[k];
+            }
+        }
+    }
+    for(j = 0; j < 3; j++){
+        for(k = 0; k < 3; k++){
+            estimate->covariance[j][k] = cov[j][k];
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef MCL_H
+#define MCL_H
+
+#include "Odometry.h"
+#include "Arena.h"
+
+/*
+ * Monte Carlo localization (particle filter) of the robot's pose in the known
+ * course (Arena.h).
+ *
+ * Motion: every particle is moved by the distance each wheel drove plus its own
+ *         random wheel noise, whose variance grows with the distance driven.
+ * Beams:  each distance reading is compared with the distance from the particle to
+ *         the known walls. The error is divided by the sensor's standard deviation
+ *         at that distance, which is derived from Distance_ComputeDistance (the ADC
+ *         noise times the slope of the formula), and looked up in a fixed point
+ *         likelihood table. Readings shorter than expected keep a higher floor,
+ *         since an unmapped obstacle can block the beam.
+ * Resampling: low variance (one random number for the whole set), only when the
+ *         effective number of particles drops below half.
+ *
+ * Particles are stored as separate arrays of x, y, heading, cos and sin (structure
+ * of arrays), so the per-particle loops have no branches on the data layout and
+ * vectorize on the host. A few hundred particles fit on the MSP432; the host can be
+ * built with more particles and threads for tuning:
+ *     -DMCL_MAX_PARTICLES=4096 -DMCL_MAX_THREADS=4 -pthread
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#ifndef MCL_MAX_PARTICLES
+#define MCL_MAX_PARTICLES   300    /* Size of the particle store                                */
+#endif
+#ifndef MCL_MAX_THREADS
+#define MCL_MAX_THREADS     1      /* Threads that share the particle loops (host builds only)  */
+#endif
+
+#define MCL_WHEEL_NOISE     0.5f   /* Wheel distance variance per mm driven (mm^2/mm)           */
+#define MCL_HEADING_NOISE   0.002f /* Extra heading noise per prediction (rad)                  */
+#define MCL_ADC_NOISE       50.0f  /* Standard deviation of a distance sensor's ADC (counts)    */
+#define MCL_RANGE_NOISE_MM  10.0f  /* Model error added to the ADC noise (mm)                   */
+#define MCL_MAX_RANGE_MM    600    /* Readings further than this are not used (mm)              */
+
+#define MCL_BIN_MM          16     /* Width of a distance bin of the sensor noise table (mm)    */
+#define MCL_RANGE_BINS      80     /* Bins in the sensor noise table (covers 1280 mm)           */
+#define MCL_LUT_STEPS       8      /* Likelihood table entries per standard deviation           */
+#define MCL_LUT_SIZE        64     /* Likelihood table entries (errors up to 8 std deviations)  */
+#define MCL_ONE             32768  /* Likelihood and weight of 1.0 (Q15)                        */
+#define MCL_FLOOR           (MCL_ONE / 200)  /* Likelihood of a reading that disagrees with the map     */
+#define MCL_SHORT_FLOOR     (MCL_ONE / 20)   /* Likelihood of a reading shortened by an obstacle        */
+
+
+// Pose estimate and its covariance, in mm and radians (heading in degrees for display)
+typedef struct MCL_Estimate{
+    float xPos;
+    float yPos;
+    float heading;       // Degrees
+    float covariance[3][3];
+} MCL_Estimate;
+
+
+// --------------------- Function Prototypes ---------------------
+void MCL_Init(float xPos, float yPos, float heading, float posSpread, float headingSpread, uint32_t numParticles);
+void MCL_SetThreads(uint32_t numThreads);
+void MCL_Predict(float leftDist, float rightDist);
+uint32_t MCL_Update(uint32_t leftDist, uint32_t centerDist, uint32_t rightDist);
+void MCL_GetEstimate(MCL_Estimate* estimate);
+
+#endif
@@ -0,0 +1,235 @@
+#include <stdint.h>
+#include "AP.h"
+#include "Mission.h"
+
+
+#define MISSION_WAYPOINT_UUID  0xFFE1
+#define MISSION_COMMAND_UUID   0xFFE2
+#define MISSION_STATUS_UUID    0xFFE3
+
+#define MISSION_WAYPOINT_BYTES 5
+#define MISSION_STATUS_BYTES   12
+#define MISSION_STATUS_INDEX   0      /* Only notify characteristic of the service */
+
+// Waypoints to drive to, the head is the current target
+static Coordinates MissionQueue[MISSION_MAX_WAYPOINTS];
+static uint32_t MissionGetI, MissionPutI;   // Free running, wrap with the mask
+
+static uint32_t MissionState;
+static uint32_t MissionInterrupt;           // 1 when the move in progress should stop
+static uint32_t MissionReachedCount;        // Waypoints reached since the start command
+static Coordinates MissionPose;             // Last pose from the navigator
+
+// Buffers written and read by AP
+static uint8_t MissionWaypoint[MISSION_WAYPOINT_BYTES];
+static uint32_t MissionCommand;
+static uint8_t MissionStatus[MISSION_STATUS_BYTES];
+static uint8_t MissionSequence;
+static uint8_t MissionReportPending;        // Status changed but the notification was busy
+
+static void Mission_WaypointWritten(void);
+static void Mission_CommandWritten(void);
+
+
+// ---------- Mission_Count ----------
+// Output: uint32_t - waypoints in the queue
+static uint32_t Mission_Count(void){
+    return MissionPutI - MissionGetI;
+}
+
+
+// ---------- Mission_Put16 ----------
+static uint8_t* Mission_Put16(uint8_t* dest, uint32_t value){
+    dest[0] = value & 0xFF;
+    dest[1] = (value >> 8) & 0xFF;
+    return dest + 2;
+}
+
+
+// ---------- Mission_Init ----------
+// Adds the mission characteristics to the service being built (after
+// AP_AddService, before AP_RegisterService)
+// Inputs: const Coordinates* robot - robot's starting coordinates
+// Output: int - APOK if successful, APFAIL if the SNP fails
+int Mission_Init(const Coordinates* robot){
+    MissionGetI = MissionPutI = 0;
+    MissionState = MISSION_IDLE;
+    MissionInterrupt = 0;
+    MissionReachedCount = 0;
+    MissionPose = *robot;
+
+    if(AP_AddCharacteristic(MISSION_WAYPOINT_UUID, MISSION_WAYPOINT_BYTES, MissionWaypoint,
+                            0x02, 0x08, "waypoint", 0, &Mission_WaypointWritten) == APFAIL){
+        return APFAIL;
+    }
+    if(AP_AddCharacteristic(MISSION_COMMAND_UUID, 4, &MissionCommand,
+                            0x03, 0x0A, "command", 0, &Mission_CommandWritten) == APFAIL){
+        return APFAIL;
+    }
+    return AP_AddNotifyCharacteristic(MISSION_STATUS_UUID, MISSION_STATUS_BYTES, MissionStatus,
+                                      "status", 0);
+}
+
+
+// ---------- Mission_SetState ----------
+// Changes state, stops the move in progress and sends the new status
+static void Mission_SetState(uint32_t state){
+    MissionState = state;
+    MissionInterrupt = 1;
+    Mission_Report(&MissionPose);
+}
+
+
+// ---------- Mission_WaypointWritten ----------
+// AP callback: adds the waypoint the phone wrote to the queue
+static void Mission_WaypointWritten(void){
+    Coordinates* waypoint;
+
+    if(MissionWaypoint[4] & MISSION_WAYPOINT_CLEAR){
+        MissionGetI = MissionPutI;
+        MissionInterrupt = 1;
+    }
+    if(Mission_Count() < MISSION_MAX_WAYPOINTS){
+        waypoint = &MissionQueue[MissionPutI & (MISSION_MAX_WAYPOINTS - 1)];
+        waypoint->xPos = (int16_t)(MissionWaypoint[0] | (MissionWaypoint[1] << 8));
+        waypoint->yPos = (int16_t)(MissionWaypoint[2] | (MissionWaypoint[3] << 8));
+        waypoint->heading = 0;
+        MissionPutI++;
+    }
+
+    // A waypoint added after the last one was reached carries on the mission
+    if(MissionState == MISSION_DONE){
+        MissionState = MISSION_RUNNING;
+    }
+    Mission_Report(&MissionPose);
+}
+
+
+// ---------- Mission_CommandWritten ----------
+// AP callback: runs the command the phone wrote
+static void Mission_CommandWritten(void){
+    uint32_t argument = MISSION_COMMAND_ARGUMENT(MissionCommand);
+
+    switch(MISSION_COMMAND(MissionCommand)){
+    case MISSION_COMMAND_START:
+        if(MissionState != MISSION_PAUSED){
+            MissionReachedCount = 0;
+        }
+        Mission_SetState(Mission_Count() ? MISSION_RUNNING : MISSION_IDLE);
+        break;
+    case MISSION_COMMAND_PAUSE:
+        if(MissionState == MISSION_RUNNING){
+            Mission_SetState(MISSION_PAUSED);
+        }
+        break;
+    case MISSION_COMMAND_ABORT:
+        MissionGetI = MissionPutI;
+        Mission_SetState(MISSION_ABORTED);
+        break;
+    case MISSION_COMMAND_SPEED:
+        if(argument < MISSION_MIN_RPM){argument = MISSION_MIN_RPM;}
+        if(argument > MISSION_MAX_RPM){argument = MISSION_MAX_RPM;}
+        Odometry_SetRPM(argument, argument);
+        Mission_SetState(MissionState);     // Drive on at the new speed
+        break;
+    case MISSION_COMMAND_CLEAR:
+        if(MissionState != MISSION_RUNNING){
+            MissionGetI = MissionPutI;
+            Mission_Report(&MissionPose);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+
+// ---------- Mission_Poll ----------
+// Runs the BLE link. Use as Precision_Poll so it runs during moves
+// Inputs: none
+// Output: uint32_t - 1 if the move in progress should stop (not running, re-tasked
+//         or new speed), 0 to carry on
+uint32_t Mission_Poll(void){
+    AP_BackgroundProcess();
+    if(MissionReportPending){
+        Mission_Report(&MissionPose);
+    }
+    return (MissionState != MISSION_RUNNING) || MissionInterrupt;
+}
+
+
+// ---------- Mission_NextWaypoint ----------
+// Gives the waypoint to drive to once the mission is running. Call while idle,
+// as it does not run the BLE link
+// Inputs: Coordinates* waypoint - set to the head of the queue
+// Output: uint32_t - 1 if waypoint is set, 0 while waiting for waypoints or a start command
+uint32_t Mission_NextWaypoint(Coordinates* waypoint){
+    if((MissionState != MISSION_RUNNING) || (Mission_Count() == 0)){
+        return 0;
+    }
+    *waypoint = MissionQueue[MissionGetI & (MISSION_MAX_WAYPOINTS - 1)];
+    MissionInterrupt = 0;
+    return 1;
+}
+
+
+// ---------- Mission_Reached ----------
+// The navigator reached the waypoint at the head of the queue
+// Inputs: const Coordinates* robot - robot's coordinates
+// Output: none
+void Mission_Reached(const Coordinates* robot){
+    MissionPose = *robot;
+
+    // Re-tasked or aborted on the way: the head is no longer the waypoint driven to
+    if((MissionState != MISSION_RUNNING) || MissionInterrupt || (Mission_Count() == 0)){
+        Mission_Report(robot);
+        return;
+    }
+    MissionGetI++;
+    MissionReachedCount++;
+    if(Mission_Count() == 0){
+        MissionState = MISSION_DONE;
+    }
+    Mission_Report(robot);
+}
+
+
+// ---------- Mission_Report ----------
+// Sends the pose and progress to the phone. If the notification is busy it is
+// sent again by Mission_Poll
+// Inputs: const Coordinates* robot - robot's coordinates
+// Output: none
+void Mission_Report(const Coordinates* robot){
+    uint8_t* pt = MissionStatus;
+    int32_t heading;
+    uint16_t leftRPM, rightRPM;
+
+    MissionPose = *robot;
+    Odometry_GetRPM(&leftRPM, &rightRPM);
+    heading = robot->heading % DEGREES_PER_REVOLUTION;
+    if(heading < 0){
+        heading += DEGREES_PER_REVOLUTION;
+    }
+
+    pt = Mission_Put16(pt, (uint16_t)robot->xPos);
+    pt = Mission_Put16(pt, (uint16_t)robot->yPos);
+    pt = Mission_Put16(pt, heading);
+    pt = Mission_Put16(pt, leftRPM);
+    pt[0] = MissionState;
+    pt[1] = MissionReachedCount;
+    pt[2] = Mission_Count();
+    pt[3] = MissionSequence;
+
+    MissionReportPending = 1;
+    if(AP_SendNotification(MISSION_STATUS_INDEX) == APOK){
+        MissionReportPending = 0;
+        MissionSequence++;
+    }
+}
+
+
+// ---------- Mission_GetState ----------
+// Output: uint32_t - MISSION_IDLE, MISSION_RUNNING, ...
+uint32_t Mission_GetState(void){
+    return MissionState;
+}
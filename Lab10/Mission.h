@@ -0,0 +1,67 @@
+#ifndef MISSION_H
+#define MISSION_H
+
+#include <stdint.h>
+#include "Odometry.h"
+
+/*
+ * BLE mission service: the phone uploads waypoints and sends mission commands,
+ * and the navigator drives to the waypoints in order while the robot reports its
+ * pose and progress back. Runs on the AP layer of Lab08. Lab10/main.c starts the
+ * SNP and creates the service, and Mission_Init adds these characteristics to it.
+ *
+ * Service 0xFFE0, little endian:
+ *   0xFFE1 waypoint (write, 5 bytes)  x(2) y(2) flags(1)     mm, mm
+ *          MISSION_WAYPOINT_CLEAR in flags empties the queue first, re-tasking the
+ *          robot at once. Waypoints are dropped while the queue is full.
+ *   0xFFE2 command (write/read, 32-bit number)  command in bits 0-7,
+ *          argument in bits 16-31 (MISSION_COMMAND_*)
+ *   0xFFE3 status (notify, 12 bytes)
+ *          x(2) y(2) heading(2) rpm(2) state(1) reached(1) queued(1) sequence(1)
+ *          mm, mm, degrees, Motor_Forward_RPM units, MISSION_*, waypoints reached
+ *          since the start command, waypoints left, counts every status sent
+ *   0xFFE4 parameters (read/write, 16 bytes), added by main in every navigation
+ *          mode when built with PARAMS_LIVE (Params.h)
+ *
+ * The navigator takes waypoints with Mission_NextWaypoint and calls
+ * Mission_Reached when it gets there. With Precision_Poll = &Mission_Poll the
+ * moves in Precision_Moves.c keep the BLE link running and stop early when the
+ * mission is paused, aborted, re-tasked or changes speed.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#define MISSION_MAX_WAYPOINTS  16     /* Waypoints the queue holds (power of 2)   */
+#define MISSION_MIN_RPM        200    /* Slowest speed a set speed command takes  */
+#define MISSION_MAX_RPM        1200   /* Fastest speed a set speed command takes  */
+
+// Mission states
+#define MISSION_IDLE     0   /* Waiting for waypoints and a start command           */
+#define MISSION_RUNNING  1   /* Driving to the waypoint at the head of the queue    */
+#define MISSION_PAUSED   2   /* Stopped, the start command carries on               */
+#define MISSION_ABORTED  3   /* Stopped and the queue is empty                      */
+#define MISSION_DONE     4   /* Reached the last waypoint in the queue              */
+
+// Commands (bits 0-7 of the command characteristic)
+#define MISSION_COMMAND_START  1   /* Drive to the waypoints in the queue            */
+#define MISSION_COMMAND_PAUSE  2   /* Stop until the next start                      */
+#define MISSION_COMMAND_ABORT  3   /* Stop and empty the queue                       */
+#define MISSION_COMMAND_SPEED  4   /* Forward speed is the argument                  */
+#define MISSION_COMMAND_CLEAR  5   /* Empty the queue when not running               */
+
+#define MISSION_COMMAND(CMD)          ((CMD) & 0xFF)
+#define MISSION_COMMAND_ARGUMENT(CMD) ((CMD) >> 16)
+
+#define MISSION_WAYPOINT_CLEAR 0x01  /* Waypoint flag: empty the queue first        */
+
+
+// --------------------- Function Prototypes ---------------------
+int Mission_Init(const Coordinates* robot);
+uint32_t Mission_Poll(void);
+uint32_t Mission_NextWaypoint(Coordinates* waypoint);
+void Mission_Reached(const Coordinates* robot);
+void Mission_Report(const Coordinates* robot);
+uint32_t Mission_GetState(void);
+
+#endif
@@ -50,6 +50,7 @@ policies, either expressed or implied, of the FreeBSD Project.
 #include <stdint.h>
 #include "msp.h"
 #include "PWM.h"
+#include "Journal.h"
 
 // *******Lab 13 solution*******
 
@@ -87,6 +88,9 @@ void Motor_Init(void){
 // Input: none
 // Output: none
 void Motor_Stop(void){
+#ifdef JOURNAL_RECORD
+    Journal_Motor(JOURNAL_MOTOR_STOP, 0, 0);
+#endif
     P3->OUT  &= ~0xC0; // Power down the drivers
     PWM_Duty3(0);          // Set duty cycles to 0
     PWM_Duty4(0);          // Set duty cycles to 0
@@ -101,6 +105,9 @@ void Motor_Stop(void){
 // Output: none
 // Assumes: Motor_Init() has been called
 void Motor_Forward(uint16_t leftDuty, uint16_t rightDuty){ 
+#ifdef JOURNAL_RECORD
+    Journal_Motor(JOURNAL_MOTOR_FORWARD, leftDuty, rightDuty);
+#endif
     // Check for valid duty cycle values
     if(leftDuty > 14998) return;
     if(rightDuty > 14998) return;
@@ -125,6 +132,9 @@ void Motor_Forward(uint16_t leftDuty, uint16_t rightDuty){
 // Output: none
 // Assumes: Motor_Init() has been called
 void Motor_Right(uint16_t leftDuty, uint16_t rightDuty){ 
+#ifdef JOURNAL_RECORD
+    Journal_Motor(JOURNAL_MOTOR_RIGHT, leftDuty, rightDuty);
+#endif
     // Check for valid duty cycle values
     if(leftDuty > 14998) return;
     if(rightDuty > 14998) return;
@@ -150,6 +160,9 @@ void Motor_Right(uint16_t leftDuty, uint16_t rightDuty){
 // Output: none
 // Assumes: Motor_Init() has been called
 void Motor_Left(uint16_t leftDuty, uint16_t rightDuty){ 
+#ifdef JOURNAL_RECORD
+    Journal_Motor(JOURNAL_MOTOR_LEFT, leftDuty, rightDuty);
+#endif
     // Check for valid duty cycle values
     if(leftDuty > 14998) return;
     if(rightDuty > 14998) return;
@@ -175,6 +188,9 @@ void Motor_Left(uint16_t leftDuty, uint16_t rightDuty){
 // Output: none
 // Assumes: Motor_Init() has been called
 void Motor_Backward(uint16_t leftDuty, uint16_t rightDuty){ 
+#ifdef JOURNAL_RECORD
+    Journal_Motor(JOURNAL_MOTOR_BACKWARD, leftDuty, rightDuty);
+#endif
     // Check for valid duty cycle values
     if(leftDuty > 14998) return;
     if(rightDuty > 14998) return;
@@ -1,6 +1,15 @@
 #include "Odometry.h"
 
 
+// Forward speeds of Odometry_DriveForward and Odometry_Forward
+#ifdef PARAMS_LIVE
+#define OdometryLeftRPM  Params.leftRPM
+#define OdometryRightRPM Params.rightRPM
+#else
+static uint16_t OdometryLeftRPM = LEFT_RPM, OdometryRightRPM = RIGHT_RPM;
+#endif
+
+
 // ---------- Odometry_DriveForward ----------
 // Drives forward until reaching the destination or an object is detected in the path
 // Inputs: Coordinates* cur  - pointer to the robot's current coordinates
@@ -19,7 +28,7 @@ ret_t Odometry_DriveForward(Coordinates* cur, const Coordinates* dest){
     Tachometer_Get_Steps(&leftInitSteps, &rightInitSteps);
 
     // Drive forwards for until the destination has been reached or until blocked by an object
-    ret_t hasReached = Motor_Forward_RPM(LEFT_RPM, RIGHT_RPM, desiredSteps, desiredSteps);
+    ret_t hasReached = Motor_Forward_RPM(OdometryLeftRPM, OdometryRightRPM, desiredSteps, desiredSteps);
 
     // Get the robot's new number of steps
     int32_t leftSteps, rightSteps;
@@ -38,20 +47,6 @@ ret_t Odometry_DriveForward(Coordinates* cur, const Coordinates* dest){
 }
 
 
-// ---------- Odometry_CheckFinished ----------
-// If the robot has reached the destination, does not return
-// Inputs: ret_t - whether the robot reached the destination or detected an object
-// Output: none
-void Odometry_CheckFinished(ret_t reachedDest){
-    // If the robot reached the destination, enter an infinite loop
-    if(reachedDest == REACHED_DESTINATION){
-        while(TRUE){
-            Clock_Delay1ms(INFINITE_LOOP_DELAY);
-        }
-    }
-}
-
-
 // ---------- Odometry_PickSide ----------
 // Determines which was to spin the robot to avoid an obstacle
 // Inputs: const Coordinates* cur - robot's current coordinates
@@ -159,7 +154,7 @@ void Odometry_Forward(Coordinates* cur){
 
     // Calculate the desired number of steps and then move forwards that distance
     int32_t desiredSteps = DISTANCE_TO_STEPS(DRIVE_FORWARD_MM);
-    Motor_Forward_RPM(LEFT_RPM, RIGHT_RPM, desiredSteps, desiredSteps);
+    Motor_Forward_RPM(OdometryLeftRPM, OdometryRightRPM, desiredSteps, desiredSteps);
 
     // Get the new number of steps
     int32_t leftSteps, rightSteps;
@@ -253,6 +248,72 @@ int32_t Odometry_CalculateAlpha(const Coordinates* cur, const Coordinates* dest)
 }
 
 
+// ---------- Odometry_MapObstacles ----------
+// Marks the obstacles that the distance sensors can see as occupied in the planner's grid
+// Inputs: const Coordinates* cur - robot's current coordinates
+// Output: uint32_t - number of cells newly marked occupied
+uint32_t Odometry_MapObstacles(const Coordinates* cur){
+    uint32_t leftDist, centerDist, rightDist;
+    uint32_t marked = 0;
+    int32_t leftAngle = cur->heading + SIDE_SENSOR_ANGLE;
+    int32_t rightAngle = cur->heading - SIDE_SENSOR_ANGLE;
+
+    // Get the distances for the sensors
+    Distance_GetDistances(&leftDist, &centerDist, &rightDist);
+
+    // The sensors are mounted in front of the wheels
+    int32_t sensorX = cur->xPos + (int32_t)( (float)SENSOR_OFFSET_MM * cosd(cur->heading) );
+    int32_t sensorY = cur->yPos + (int32_t)( (float)SENSOR_OFFSET_MM * sind(cur->heading) );
+
+    // Anything closer than the threshold is an obstacle along that sensor's direction
+    if(centerDist < SENSOR_THRESHOLD_MM){
+        marked += Planner_MarkOccupied(sensorX + (int32_t)( (float)centerDist * cosd(cur->heading) ),
+                             sensorY + (int32_t)( (float)centerDist * sind(cur->heading) ));
+    }
+    if(leftDist < SENSOR_THRESHOLD_MM){
+        marked += Planner_MarkOccupied(sensorX + (int32_t)( (float)leftDist * cosd(leftAngle) ),
+                             sensorY + (int32_t)( (float)leftDist * sind(leftAngle) ));
+    }
+    if(rightDist < SENSOR_THRESHOLD_MM){
+        marked += Planner_MarkOccupied(sensorX + (int32_t)( (float)rightDist * cosd(rightAngle) ),
+                             sensorY + (int32_t)( (float)rightDist * sind(rightAngle) ));
+    }
+    return marked;
+}
+
+
+// ---------- Odometry_SetRPM ----------
+// Sets the forward speeds (LEFT_RPM and RIGHT_RPM until called). Built with
+// PARAMS_LIVE they are set through the parameter registry, within its bounds
+// Inputs: uint16_t leftRPM - RPM of the left motor when driving forward
+//         uint16_t rightRPM - RPM of the right motor when driving forward
+// Output: none
+void Odometry_SetRPM(uint16_t leftRPM, uint16_t rightRPM){
+#ifdef PARAMS_LIVE
+    ParamValue value;
+
+    value.i = leftRPM;
+    Params_Set(PARAM_LEFT_RPM, value);
+    value.i = rightRPM;
+    Params_Set(PARAM_RIGHT_RPM, value);
+#else
+    OdometryLeftRPM = leftRPM;
+    OdometryRightRPM = rightRPM;
+#endif
+}
+
+
+// ---------- Odometry_GetRPM ----------
+// Gets the forward speeds
+// Inputs: uint16_t* leftRPM - set to the RPM of the left motor when driving forward
+//         uint16_t* rightRPM - set to the RPM of the right motor when driving forward
+// Output: none
+void Odometry_GetRPM(uint16_t* leftRPM, uint16_t* rightRPM){
+    *leftRPM = OdometryLeftRPM;
+    *rightRPM = OdometryRightRPM;
+}
+
+
 // ---------- min ----------
 // returns the minimum of the two inputs
 // Inputs: int32_t - num1
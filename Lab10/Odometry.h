@@ -9,6 +9,7 @@
 #include "Precision_Moves.h"
 #include "RobotLights.h"
 #include "Distance.h"
+#include "Planner.h"
 
 
 #define TURN_TO_DESTINATION /* Comment to turn to the whatever side has the smallest distance when avoiding an obstacle */
@@ -21,14 +22,28 @@
 
 #define LEFT_RPM   650  /* The RPM of the left motor when driving forward */
 #define RIGHT_RPM  650  /* The RPM of the right motor when driving forward */
+#ifndef PARAMS_LIVE
 #define SPIN_DUTY  2500 /* The duty cycle of both motors when spinning */
+#endif
 
 #define cosd(angle) (cos((float)angle * PI / 180.0)) /* Returns the cosine of the angle (degrees)*/
 #define sind(angle) (sin((float)angle * PI / 180.0)) /* Returns the sine of the angle (degrees) */
 #define RAD_TO_DEG(rads) (rads * 180 / PI) /* Radians to degrees conversion */
 
 #define DRIVE_FORWARD_MM    400 /* Distance to drive forwards before correcting the spin */
+#ifndef PARAMS_LIVE
 #define SENSOR_THRESHOLD_MM 300 /* The threshold before a side is considered open */
+#endif
+#define SIDE_SENSOR_ANGLE   45  /* Angle between the center sensor and each side sensor (degrees) */
+#define SENSOR_OFFSET_MM    60  /* Distance of the distance sensors in front of the wheels (mm) */
+
+// Built with PARAMS_LIVE, the spin duty cycle and sensor threshold are read from the
+// parameter registry (Params.h), as are the forward speeds in Odometry.c. LEFT_RPM and
+// RIGHT_RPM stay the defaults
+#ifdef PARAMS_LIVE
+#define SPIN_DUTY           Params.spinDuty
+#define SENSOR_THRESHOLD_MM Params.sensorThresholdMm
+#endif
 
 
 // Left or right side
@@ -44,12 +59,14 @@ typedef struct Coordinates{
 
 // Function Prototypes
 ret_t Odometry_DriveForward(Coordinates* cur, const Coordinates* dest);
-void Odometry_CheckFinished(ret_t reachedDest);
 side_t Odometry_PickSide(const Coordinates* cur, const Coordinates* dest);
 void Odometry_Spin(Coordinates* cur, side_t direction, int32_t maxDegrees);
 void Odometry_Forward(Coordinates* cur);
 void Odometry_CorrectSpin(Coordinates* cur, const Coordinates* dest);
 int32_t Odometry_CalculateAlpha(const Coordinates* cur, const Coordinates* dest);
+uint32_t Odometry_MapObstacles(const Coordinates* cur);
+void Odometry_SetRPM(uint16_t leftRPM, uint16_t rightRPM);
+void Odometry_GetRPM(uint16_t* leftRPM, uint16_t* rightRPM);
 int32_t min(int32_t num1, int32_t num2);
 int32_t max(int32_t num1, int32_t num2);
 
@@ -0,0 +1,278 @@
+// The defaults are the constants of Precision_Moves.h and Odometry.h, which they
+// only are without PARAMS_LIVE
+#undef PARAMS_LIVE
+
+#include <stdint.h>
+#include "msp.h"
+#include "AP.h"
+#include "Precision_Moves.h"
+#include "Odometry.h"
+#include "Params.h"
+
+
+#define PARAMS_MAGIC          0x314D5250  /* "PRM1" at the start of the saved values  */
+#define PARAMS_RESPONSE_BYTES 16
+
+// Gain of a KP_SPIN style macro as a float, exact to 1/1000
+#define PARAMS_GAIN(MACRO) ((float)MACRO(1000) / 1000.0f)
+
+// One entry of the registry
+typedef struct ParamEntry{
+    void* pt;          // Field of Params
+    uint8_t type;      // PARAM_INT or PARAM_FLOAT
+    ParamValue min, max, def;
+} ParamEntry;
+
+ParamValues Params;
+static uint8_t ParamsSavePending;   // 1 when the phone asked for a save, Params_SaveIfPending does it
+
+// Indexed by the parameter ID
+static const ParamEntry ParamsTable[PARAMS_COUNT] = {
+    {&Params.kpSpin,            PARAM_FLOAT, {.f = 0},  {.f = 200},   {.f = PARAMS_GAIN(KP_SPIN)}},
+    {&Params.kpForward,         PARAM_FLOAT, {.f = 0},  {.f = 20},    {.f = PARAMS_GAIN(KP_FORWARD)}},
+    {&Params.kiForward,         PARAM_FLOAT, {.f = 0},  {.f = 10},    {.f = PARAMS_GAIN(KI_FORWARD)}},
+    {&Params.integralMax,       PARAM_INT,   {.i = 0},  {.i = MAX_DUTY_CYCLE}, {.i = INTEGRAL_MAX}},
+    {&Params.spinDelayMs,       PARAM_INT,   {.i = 1},  {.i = 500},   {.i = SPIN_DELAY_MS}},
+    {&Params.forwardDelayMs,    PARAM_INT,   {.i = 1},  {.i = 500},   {.i = FORWARD_DELAY_MS}},
+    {&Params.minDistanceMm,     PARAM_INT,   {.i = 0},  {.i = 800},   {.i = MIN_DISTANCE_MM}},
+    {&Params.maxDistanceMm,     PARAM_INT,   {.i = 0},  {.i = 800},   {.i = MAX_DISTANCE_MM}},
+    {&Params.sensorThresholdMm, PARAM_INT,   {.i = 0},  {.i = 800},   {.i = SENSOR_THRESHOLD_MM}},
+    {&Params.leftRPM,           PARAM_INT,   {.i = 0},  {.i = 2000},  {.i = LEFT_RPM}},
+    {&Params.rightRPM,          PARAM_INT,   {.i = 0},  {.i = 2000},  {.i = RIGHT_RPM}},
+    {&Params.spinDuty,          PARAM_INT,   {.i = 0},  {.i = MAX_DUTY_CYCLE}, {.i = SPIN_DUTY}},
+};
+
+// Values as saved in flash
+typedef struct ParamsRecord{
+    uint32_t magic;
+    uint32_t count;
+    ParamValue values[PARAMS_COUNT];
+    uint32_t checksum;
+} ParamsRecord;
+
+static uint8_t ParamsResponse[PARAMS_RESPONSE_BYTES];  // Characteristic written and read by AP
+
+
+// ---------- Params_InRange ----------
+// Output: uint32_t - 1 if value is within the bounds of the entry (never for NaN)
+static uint32_t Params_InRange(const ParamEntry* entry, ParamValue value){
+    if(entry->type == PARAM_FLOAT){
+        return (value.f >= entry->min.f) && (value.f <= entry->max.f);
+    }
+    return (value.i >= entry->min.i) && (value.i <= entry->max.i);
+}
+
+
+// ---------- Params_Checksum ----------
+// Output: uint32_t - checksum of the record, leaving out the checksum itself
+static uint32_t Params_Checksum(const ParamsRecord* record){
+    const uint32_t* pt = (const uint32_t*)record;
+    uint32_t i, sum = 0;
+
+    for(i = 0; i < (sizeof(ParamsRecord) / 4) - 1; i++){
+        sum = (sum << 1 | sum >> 31) ^ pt[i];
+    }
+    return sum;
+}
+
+
+// ---------- Params_Defaults ----------
+// Sets every parameter to its default
+// Inputs: none
+// Output: none
+void Params_Defaults(void){
+    uint32_t id;
+
+    for(id = 0; id < PARAMS_COUNT; id++){
+        *(ParamValue*)ParamsTable[id].pt = ParamsTable[id].def;
+    }
+}
+
+
+// ---------- Params_Init ----------
+// Sets the parameters to the values saved in flash, or to the defaults if none
+// were saved or they are not valid
+// Inputs: none
+// Output: none
+void Params_Init(void){
+    const ParamsRecord* record = (const ParamsRecord*)PARAMS_FLASH_ADDRESS;
+    uint32_t id;
+
+    Params_Defaults();
+    if((record->magic != PARAMS_MAGIC) || (record->count != PARAMS_COUNT)
+       || (record->checksum != Params_Checksum(record))){
+        return;
+    }
+    for(id = 0; id < PARAMS_COUNT; id++){
+        if(!Params_InRange(&ParamsTable[id], record->values[id])){
+            return;
+        }
+    }
+    for(id = 0; id < PARAMS_COUNT; id++){
+        *(ParamValue*)ParamsTable[id].pt = record->values[id];
+    }
+}
+
+
+// ---------- Params_Get ----------
+// Inputs: uint32_t id - PARAM_KP_SPIN, ...
+//         ParamValue* value - set to the parameter's value
+// Output: int - PARAMS_OK or PARAMS_BAD_ID
+int Params_Get(uint32_t id, ParamValue* value){
+    if(id >= PARAMS_COUNT){
+        return PARAMS_BAD_ID;
+    }
+    *value = *(ParamValue*)ParamsTable[id].pt;
+    return PARAMS_OK;
+}
+
+
+// ---------- Params_Set ----------
+// Inputs: uint32_t id - PARAM_KP_SPIN, ...
+//         ParamValue value - new value, of the parameter's type
+// Output: int - PARAMS_OK, PARAMS_BAD_ID, or PARAMS_OUT_OF_RANGE (value not changed)
+int Params_Set(uint32_t id, ParamValue value){
+    if(id >= PARAMS_COUNT){
+        return PARAMS_BAD_ID;
+    }
+    if(!Params_InRange(&ParamsTable[id], value)){
+        return PARAMS_OUT_OF_RANGE;
+    }
+    *(ParamValue*)ParamsTable[id].pt = value;
+    return PARAMS_OK;
+}
+
+
+// ---------- Params_Save ----------
+// Saves every parameter to the flash sector at PARAMS_FLASH_ADDRESS. The sector is
+// in bank 1 and the program runs from bank 0, but the erase still takes tens of ms,
+// so call it with the motors stopped
+// Inputs: none
+// Output: int - PARAMS_OK, or PARAMS_FLASH_ERROR if the sector did not read back
+int Params_Save(void){
+    ParamsRecord record;
+    const uint32_t* src = (const uint32_t*)&record;
+    volatile uint32_t* dest = (volatile uint32_t*)PARAMS_FLASH_ADDRESS;
+    uint32_t i, error = 0;
+
+    record.magic = PARAMS_MAGIC;
+    record.count = PARAMS_COUNT;
+    for(i = 0; i < PARAMS_COUNT; i++){
+        record.values[i] = *(ParamValue*)ParamsTable[i].pt;
+    }
+    record.checksum = Params_Checksum(&record);
+
+    // Unprotect the sector and erase it
+    FLCTL->BANK1_MAIN_WEPROT &= ~(1u << PARAMS_FLASH_SECTOR);
+    FLCTL->CLRIFG = FLCTL_CLRIFG_ERASE | FLCTL_CLRIFG_PRG;
+    FLCTL->ERASE_CTLSTAT = FLCTL_ERASE_CTLSTAT_CLR_STAT;
+    FLCTL->ERASE_SECTADDR = PARAMS_FLASH_ADDRESS;
+    FLCTL->ERASE_CTLSTAT = FLCTL_ERASE_CTLSTAT_START;      // Sector erase of main memory
+    while((FLCTL->IFG & FLCTL_IFG_ERASE) == 0){};
+    if(FLCTL->ERASE_CTLSTAT & FLCTL_ERASE_CTLSTAT_ADDR_ERR){
+        error = 1;
+    }
+
+    // Program one word at a time (immediate mode)
+    FLCTL->PRG_CTLSTAT = FLCTL_PRG_CTLSTAT_ENABLE;
+    for(i = 0; (i < sizeof(ParamsRecord) / 4) && !error; i++){
+        FLCTL->CLRIFG = FLCTL_CLRIFG_PRG;
+        dest[i] = src[i];
+        while((FLCTL->IFG & FLCTL_IFG_PRG) == 0){};
+    }
+    FLCTL->PRG_CTLSTAT = 0;
+    FLCTL->BANK1_MAIN_WEPROT |= (1u << PARAMS_FLASH_SECTOR);
+
+    for(i = 0; i < sizeof(ParamsRecord) / 4; i++){
+        if(dest[i] != src[i]){
+            error = 1;
+        }
+    }
+    return error ? PARAMS_FLASH_ERROR : PARAMS_OK;
+}
+
+
+// ---------- Params_Put32 ----------
+static uint8_t* Params_Put32(uint8_t* dest, uint32_t value){
+    dest[0] = value & 0xFF;
+    dest[1] = (value >> 8) & 0xFF;
+    dest[2] = (value >> 16) & 0xFF;
+    dest[3] = (value >> 24) & 0xFF;
+    return dest + 4;
+}
+
+
+// ---------- Params_Written ----------
+// AP callback: runs the op the phone wrote and leaves the answer to read back
+static void Params_Written(void){
+    uint32_t op = ParamsResponse[0], id = ParamsResponse[1];
+    uint32_t status;
+    ParamValue value;
+    uint8_t* pt;
+
+    value.i = (int32_t)(ParamsResponse[4] | (ParamsResponse[5] << 8)
+                        | (ParamsResponse[6] << 16) | ((uint32_t)ParamsResponse[7] << 24));
+    switch(op){
+    case PARAMS_OP_GET:
+        status = (id < PARAMS_COUNT) ? PARAMS_OK : PARAMS_BAD_ID;
+        break;
+    case PARAMS_OP_SET:
+        status = Params_Set(id, value);
+        break;
+    case PARAMS_OP_SAVE:
+        ParamsSavePending = 1;      // Not from inside the control loops
+        status = PARAMS_SAVE_PENDING;
+        break;
+    case PARAMS_OP_DEFAULTS:
+        Params_Defaults();
+        status = PARAMS_OK;
+        break;
+    default:
+        status = PARAMS_BAD_OP;
+        break;
+    }
+
+    // Answer with the value and bounds of id
+    ParamsResponse[0] = status;
+    ParamsResponse[1] = id;
+    ParamsResponse[3] = PARAMS_COUNT;
+    pt = &ParamsResponse[4];
+    if(id < PARAMS_COUNT){
+        ParamsResponse[2] = ParamsTable[id].type;
+        pt = Params_Put32(pt, ((ParamValue*)ParamsTable[id].pt)->i);
+        pt = Params_Put32(pt, ParamsTable[id].min.i);
+        pt = Params_Put32(pt, ParamsTable[id].max.i);
+    } else {
+        ParamsResponse[2] = 0;
+        pt = Params_Put32(pt, 0);
+        pt = Params_Put32(pt, 0);
+        pt = Params_Put32(pt, 0);
+    }
+}
+
+
+// ---------- Params_SaveIfPending ----------
+// Runs a save the phone asked for, and answers it in the characteristic. Call
+// between moves, with the motors stopped
+// Inputs: none
+// Output: none
+void Params_SaveIfPending(void){
+    if(ParamsSavePending){
+        ParamsSavePending = 0;
+        ParamsResponse[0] = Params_Save();
+    }
+}
+
+
+// ---------- Params_AddCharacteristic ----------
+// Adds the parameter characteristic to the service being built
+// Inputs: uint16_t uuid - UUID of the characteristic
+// Output: int - APOK if successful, APFAIL if the SNP fails
+int Params_AddCharacteristic(uint16_t uuid){
+    ParamsSavePending = 0;
+    ParamsResponse[0] = PARAMS_OP_GET;
+    ParamsResponse[1] = PARAM_KP_SPIN;
+    Params_Written();
+    return AP_AddCharacteristic(uuid, PARAMS_RESPONSE_BYTES, ParamsResponse,
+                                0x03, 0x0A, "params", 0, &Params_Written);
+}
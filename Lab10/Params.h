@@ -0,0 +1,100 @@
+#ifndef PARAMS_H
+#define PARAMS_H
+
+#include <stdint.h>
+
+/*
+ * Live parameters: the gains and thresholds of Precision_Moves.h and Odometry.h
+ * as a registry of typed, bounded values the controllers read at run time, so
+ * they can be tuned over BLE while the robot drives.
+ *
+ * Built with PARAMS_LIVE defined (Lab10 project settings), the macros of
+ * Precision_Moves.h and Odometry.h read Params instead of being constants, and
+ * those constants become the defaults. Without it (Bench, the host tools) nothing
+ * changes and Params.c is not needed.
+ *
+ * BLE characteristic (read/write, 16 bytes, little endian):
+ *   write  op(1) id(1) unused(2) value(4)
+ *   read   status(1) id(1) type(1) count(1) value(4) min(4) max(4)
+ * Every write is answered in the characteristic, with the current value and the
+ * bounds of id. Float values are IEEE-754 bits. A save is answered with
+ * PARAMS_SAVE_PENDING, and its result once Lab10/main.c is idle with the motors
+ * stopped and calls Params_SaveIfPending. Saved values are loaded from flash by Params_Init,
+ * and used if they are valid and within bounds.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+// Parameter IDs
+#define PARAM_KP_SPIN              0    /* KP_SPIN gain (float)                         */
+#define PARAM_KP_FORWARD           1    /* KP_FORWARD gain (float)                      */
+#define PARAM_KI_FORWARD           2    /* KI_FORWARD gain (float)                      */
+#define PARAM_INTEGRAL_MAX         3    /* INTEGRAL_MAX, INTEGRAL_MIN is its negative    */
+#define PARAM_SPIN_DELAY_MS        4    /* SPIN_DELAY_MS                                */
+#define PARAM_FORWARD_DELAY_MS     5    /* FORWARD_DELAY_MS                             */
+#define PARAM_MIN_DISTANCE_MM      6    /* MIN_DISTANCE_MM                              */
+#define PARAM_MAX_DISTANCE_MM      7    /* MAX_DISTANCE_MM                              */
+#define PARAM_SENSOR_THRESHOLD_MM  8    /* SENSOR_THRESHOLD_MM                          */
+#define PARAM_LEFT_RPM             9    /* LEFT_RPM (a mission speed command sets it)   */
+#define PARAM_RIGHT_RPM            10   /* RIGHT_RPM (a mission speed command sets it)  */
+#define PARAM_SPIN_DUTY            11   /* SPIN_DUTY                                    */
+#define PARAMS_COUNT               12
+
+// Parameter types
+#define PARAM_INT    0
+#define PARAM_FLOAT  1
+
+// Characteristic ops
+#define PARAMS_OP_GET       0   /* Read back value and bounds of id              */
+#define PARAMS_OP_SET       1   /* Set id to value                               */
+#define PARAMS_OP_SAVE      2   /* Save every value to flash                     */
+#define PARAMS_OP_DEFAULTS  3   /* Set every value to its default                */
+
+// Status of the ops
+#define PARAMS_OK           0
+#define PARAMS_BAD_ID       1
+#define PARAMS_OUT_OF_RANGE 2
+#define PARAMS_BAD_OP       3
+#define PARAMS_FLASH_ERROR  4
+#define PARAMS_SAVE_PENDING 5   /* Save waits for the robot to stop between moves */
+
+#define PARAMS_FLASH_ADDRESS 0x0003F000  /* Last 4 KB sector of flash bank 1, kept out of MAIN in msp432p401r.cmd */
+#define PARAMS_FLASH_SECTOR  31          /* Its sector number in bank 1                 */
+
+
+// One parameter value, as its type
+typedef union ParamValue{
+    int32_t i;
+    float f;
+} ParamValue;
+
+// Values read by the controllers
+typedef struct ParamValues{
+    float kpSpin;
+    float kpForward;
+    float kiForward;
+    int32_t integralMax;
+    int32_t spinDelayMs;
+    int32_t forwardDelayMs;
+    int32_t minDistanceMm;
+    int32_t maxDistanceMm;
+    int32_t sensorThresholdMm;
+    int32_t leftRPM;
+    int32_t rightRPM;
+    int32_t spinDuty;
+} ParamValues;
+
+extern ParamValues Params;
+
+
+// --------------------- Function Prototypes ---------------------
+void Params_Init(void);
+void Params_Defaults(void);
+int Params_Get(uint32_t id, ParamValue* value);
+int Params_Set(uint32_t id, ParamValue value);
+int Params_Save(void);
+void Params_SaveIfPending(void);
+int Params_AddCharacteristic(uint16_t uuid);
+
+#endif
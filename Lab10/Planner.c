@@ -0,0 +1,553 @@
+#include "Planner.h"
+
+
+// Key of a cell in the open list (compared lexicographically)
+typedef struct PlannerKey{
+    uint32_t k1; // min(g, rhs) + heuristic to the start + km
+    uint16_t k2; // min(g, rhs)
+    uint16_t cell;
+} PlannerKey;
+
+// Offsets to the 8 neighbours of a cell (first 4 are straight, last 4 are diagonal)
+static const int8_t NeighbourCol[8] = { 1, 0, -1, 0, 1, -1, -1, 1 };
+static const int8_t NeighbourRow[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+static const uint8_t NeighbourCost[8] = { PLANNER_STRAIGHT_COST, PLANNER_STRAIGHT_COST, PLANNER_STRAIGHT_COST, PLANNER_STRAIGHT_COST,
+                                          PLANNER_DIAGONAL_COST, PLANNER_DIAGONAL_COST, PLANNER_DIAGONAL_COST, PLANNER_DIAGONAL_COST };
+
+#define NOT_IN_HEAP 0xFFFF /* Open list position of a cell that is not in the open list */
+#define NO_CELL     0xFFFF /* Neighbour that is outside of the grid */
+
+// Cost-to-goal estimates
+static uint16_t PlannerG[PLANNER_NUM_CELLS];
+static uint16_t PlannerRhs[PLANNER_NUM_CELLS];
+
+// Binary heap open list and the position of each cell in the heap
+static PlannerKey PlannerHeap[PLANNER_NUM_CELLS];
+static uint16_t PlannerHeapPos[PLANNER_NUM_CELLS];
+static uint32_t PlannerHeapSize;
+
+// Bit-packed occupied set, and closed set of the cells already on an extracted path
+static uint8_t PlannerOccupied[(PLANNER_NUM_CELLS + 7) / 8];
+static uint8_t PlannerClosed[(PLANNER_NUM_CELLS + 7) / 8];
+
+// Search state
+static uint16_t PlannerStart, PlannerLastStart, PlannerGoal;
+static int32_t PlannerGoalX, PlannerGoalY;
+static uint32_t PlannerKm;
+static uint32_t PlannerExpansions;
+static uint8_t PlannerValid;
+
+#define BIT_GET(set, cell)   ((set)[(cell) >> 3] & (1 << ((cell) & 0x07)))
+#define BIT_SET(set, cell)   ((set)[(cell) >> 3] |= (1 << ((cell) & 0x07)))
+#define MIN(a, b)            (((a) < (b)) ? (a) : (b))
+
+
+// ---------- Planner_CellFromPos ----------
+// Finds the grid cell containing a position
+// Inputs: int32_t xPos, yPos - position (mm)
+//         uint16_t* cell - pointer to store the cell index
+// Output: uint8_t - 1 if the position is inside the grid, 0 otherwise
+static uint8_t Planner_CellFromPos(int32_t xPos, int32_t yPos, uint16_t* cell){
+    int32_t col, row;
+
+    // Positions left or below the origin are outside of the grid
+    if(xPos < PLANNER_ORIGIN_X_MM || yPos < PLANNER_ORIGIN_Y_MM){
+        return 0;
+    }
+
+    col = (xPos - PLANNER_ORIGIN_X_MM) / PLANNER_CELL_MM;
+    row = (yPos - PLANNER_ORIGIN_Y_MM) / PLANNER_CELL_MM;
+    if(col >= PLANNER_GRID_WIDTH || row >= PLANNER_GRID_HEIGHT){
+        return 0;
+    }
+
+    *cell = (uint16_t)(row * PLANNER_GRID_WIDTH + col);
+    return 1;
+}
+
+
+// ---------- Planner_Neighbour ----------
+// Returns the neighbour of a cell in one of the 8 directions
+// Inputs: uint16_t cell - cell index
+//         uint32_t dir - direction index into the neighbour tables
+// Output: uint16_t - neighbour cell index, or NO_CELL if outside of the grid
+static uint16_t Planner_Neighbour(uint16_t cell, uint32_t dir){
+    int32_t col = (cell % PLANNER_GRID_WIDTH) + NeighbourCol[dir];
+    int32_t row = (cell / PLANNER_GRID_WIDTH) + NeighbourRow[dir];
+
+    if(col < 0 || col >= PLANNER_GRID_WIDTH || row < 0 || row >= PLANNER_GRID_HEIGHT){
+        return NO_CELL;
+    }
+
+    return (uint16_t)(row * PLANNER_GRID_WIDTH + col);
+}
+
+
+// ---------- Planner_Heuristic ----------
+// Octile distance between two cells (admissible for 8-connected moves)
+// Inputs: uint16_t a, b - cell indices
+// Output: uint32_t - estimated cost between the cells
+static uint32_t Planner_Heuristic(uint16_t a, uint16_t b){
+    int32_t dc = (a % PLANNER_GRID_WIDTH) - (b % PLANNER_GRID_WIDTH);
+    int32_t dr = (a / PLANNER_GRID_WIDTH) - (b / PLANNER_GRID_WIDTH);
+    if(dc < 0){dc = -dc;}
+    if(dr < 0){dr = -dr;}
+
+    if(dc > dr){
+        return PLANNER_STRAIGHT_COST * (dc - dr) + PLANNER_DIAGONAL_COST * dr;
+    }
+    return PLANNER_STRAIGHT_COST * (dr - dc) + PLANNER_DIAGONAL_COST * dc;
+}
+
+
+// ---------- Planner_EdgeCost ----------
+// Cost of moving into a cell (infinite if it is occupied)
+// Inputs: uint16_t to - cell being entered
+//         uint32_t dir - direction of the move
+// Output: uint32_t - cost of the move
+static uint32_t Planner_EdgeCost(uint16_t to, uint32_t dir){
+    if(BIT_GET(PlannerOccupied, to)){
+        return PLANNER_INFINITY;
+    }
+    return NeighbourCost[dir];
+}
+
+
+// ---------- Planner_PathCost ----------
+// Cost of moving into a cell and then on to the goal, saturated at infinity
+// Inputs: uint16_t to - cell being entered
+//         uint32_t dir - direction of the move
+// Output: uint16_t - total cost
+static uint16_t Planner_PathCost(uint16_t to, uint32_t dir){
+    uint32_t cost = Planner_EdgeCost(to, dir);
+    if(cost == PLANNER_INFINITY || PlannerG[to] == PLANNER_INFINITY){
+        return PLANNER_INFINITY;
+    }
+
+    cost += PlannerG[to];
+    return (uint16_t)MIN(cost, PLANNER_INFINITY);
+}
+
+
+// ---------- Planner_MinSuccessor ----------
+// Recomputes the one-step lookahead cost (rhs) of a cell from its neighbours
+// Inputs: uint16_t cell - cell index
+// Output: uint16_t - minimum cost to the goal through any neighbour
+static uint16_t Planner_MinSuccessor(uint16_t cell){
+    uint16_t best = PLANNER_INFINITY;
+    uint16_t next, cost;
+    uint32_t dir;
+
+    for(dir = 0; dir < 8; dir++){
+        next = Planner_Neighbour(cell, dir);
+        if(next != NO_CELL){
+            cost = Planner_PathCost(next, dir);
+            best = MIN(best, cost);
+        }
+    }
+
+    return best;
+}
+
+
+// ---------- Planner_CalculateKey ----------
+// Computes the open list key of a cell
+// Inputs: uint16_t cell - cell index
+// Output: PlannerKey - key of the cell
+static PlannerKey Planner_CalculateKey(uint16_t cell){
+    PlannerKey key;
+    key.k2 = MIN(PlannerG[cell], PlannerRhs[cell]);
+    key.k1 = (uint32_t)key.k2 + Planner_Heuristic(PlannerStart, cell) + PlannerKm;
+    key.cell = cell;
+    return key;
+}
+
+
+// ---------- Planner_KeyLess ----------
+// Lexicographic comparison of two keys
+// Inputs: const PlannerKey* a, b - keys to compare
+// Output: uint8_t - 1 if a is less than b
+static uint8_t Planner_KeyLess(const PlannerKey* a, const PlannerKey* b){
+    return (a->k1 < b->k1) || (a->k1 == b->k1 && a->k2 < b->k2);
+}
+
+
+// ---------- Planner_HeapPlace ----------
+// Stores a key at a heap position and records the position for its cell
+// Inputs: uint32_t pos - heap position
+//         PlannerKey key - key to store
+// Output: none
+static void Planner_HeapPlace(uint32_t pos, PlannerKey key){
+    PlannerHeap[pos] = key;
+    PlannerHeapPos[key.cell] = (uint16_t)pos;
+}
+
+
+// ---------- Planner_HeapSiftUp ----------
+// Moves a key up the heap until its parent is smaller
+// Inputs: uint32_t pos - heap position of the key
+// Output: none
+static void Planner_HeapSiftUp(uint32_t pos){
+    PlannerKey key = PlannerHeap[pos];
+    uint32_t parent;
+
+    while(pos > 0){
+        parent = (pos - 1) >> 1;
+        if(!Planner_KeyLess(&key, &PlannerHeap[parent])){
+            break;
+        }
+        Planner_HeapPlace(pos, PlannerHeap[parent]);
+        pos = parent;
+    }
+    Planner_HeapPlace(pos, key);
+}
+
+
+// ---------- Planner_HeapSiftDown ----------
+// Moves a key down the heap until both children are larger
+// Inputs: uint32_t pos - heap position of the key
+// Output: none
+static void Planner_HeapSiftDown(uint32_t pos){
+    PlannerKey key = PlannerHeap[pos];
+    uint32_t child;
+
+    while((child = 2 * pos + 1) < PlannerHeapSize){
+        if(child + 1 < PlannerHeapSize && Planner_KeyLess(&PlannerHeap[child + 1], &PlannerHeap[child])){
+            child++;
+        }
+        if(!Planner_KeyLess(&PlannerHeap[child], &key)){
+            break;
+        }
+        Planner_HeapPlace(pos, PlannerHeap[child]);
+        pos = child;
+    }
+    Planner_HeapPlace(pos, key);
+}
+
+
+// ---------- Planner_HeapRemove ----------
+// Removes a cell from the open list
+// Inputs: uint16_t cell - cell index (must be in the open list)
+// Output: none
+static void Planner_HeapRemove(uint16_t cell){
+    uint32_t pos = PlannerHeapPos[cell];
+    PlannerHeapPos[cell] = NOT_IN_HEAP;
+    PlannerHeapSize--;
+
+    // Move the last key into the hole and restore the heap order
+    if(pos != PlannerHeapSize){
+        PlannerKey moved = PlannerHeap[PlannerHeapSize];
+        Planner_HeapPlace(pos, moved);
+        Planner_HeapSiftUp(pos);
+        Planner_HeapSiftDown(PlannerHeapPos[moved.cell]);
+    }
+}
+
+
+// ---------- Planner_HeapSet ----------
+// Inserts a cell into the open list or updates its key
+// Inputs: PlannerKey key - new key of the cell
+// Output: none
+static void Planner_HeapSet(PlannerKey key){
+    uint32_t pos = PlannerHeapPos[key.cell];
+
+    if(pos == NOT_IN_HEAP){
+        pos = PlannerHeapSize++;
+    }
+
+    Planner_HeapPlace(pos, key);
+    Planner_HeapSiftUp(pos);
+    Planner_HeapSiftDown(PlannerHeapPos[key.cell]);
+}
+
+
+// ---------- Planner_UpdateVertex ----------
+// Puts a cell in the open list if it is inconsistent (g != rhs), removes it otherwise
+// Inputs: uint16_t cell - cell index
+// Output: none
+static void Planner_UpdateVertex(uint16_t cell){
+    if(PlannerG[cell] != PlannerRhs[cell]){
+        Planner_HeapSet(Planner_CalculateKey(cell));
+    } else if(PlannerHeapPos[cell] != NOT_IN_HEAP){
+        Planner_HeapRemove(cell);
+    }
+}
+
+
+// ---------- Planner_ComputeShortestPath ----------
+// Expands inconsistent cells until the start cell's cost is correct
+// Inputs: none
+// Output: none
+static void Planner_ComputeShortestPath(void){
+    PlannerKey top, newKey, startKey;
+    uint16_t cell, pred, oldG;
+    uint32_t dir;
+
+    PlannerExpansions = 0;
+    startKey = Planner_CalculateKey(PlannerStart);
+
+    while(PlannerHeapSize > 0
+          && (Planner_KeyLess(&PlannerHeap[0], &startKey) || PlannerRhs[PlannerStart] > PlannerG[PlannerStart])){
+        top = PlannerHeap[0];
+        cell = top.cell;
+        newKey = Planner_CalculateKey(cell);
+        PlannerExpansions++;
+
+        if(Planner_KeyLess(&top, &newKey)){
+            // Key is out of date because the start moved, so reinsert it
+            Planner_HeapSet(newKey);
+
+        } else if(PlannerG[cell] > PlannerRhs[cell]){
+            // Over-consistent: the cost decreased, so lower g and relax the neighbours
+            PlannerG[cell] = PlannerRhs[cell];
+            Planner_HeapRemove(cell);
+
+            for(dir = 0; dir < 8; dir++){
+                pred = Planner_Neighbour(cell, dir);
+                if(pred != NO_CELL && pred != PlannerGoal){
+                    // Moving from pred into cell is the opposite direction, which has the same cost
+                    PlannerRhs[pred] = MIN(PlannerRhs[pred], Planner_PathCost(cell, dir));
+                    Planner_UpdateVertex(pred);
+                }
+            }
+
+        } else {
+            // Under-consistent: the cost increased, so raise g and recompute the neighbours
+            oldG = PlannerG[cell];
+            PlannerG[cell] = PLANNER_INFINITY;
+
+            for(dir = 0; dir < 8; dir++){
+                pred = Planner_Neighbour(cell, dir);
+                if(pred != NO_CELL && pred != PlannerGoal && oldG != PLANNER_INFINITY
+                   && Planner_EdgeCost(cell, dir) != PLANNER_INFINITY
+                   && PlannerRhs[pred] == Planner_EdgeCost(cell, dir) + oldG){
+                    PlannerRhs[pred] = Planner_MinSuccessor(pred);
+                }
+                if(pred != NO_CELL){
+                    Planner_UpdateVertex(pred);
+                }
+            }
+            if(cell != PlannerGoal){
+                PlannerRhs[cell] = Planner_MinSuccessor(cell);
+            }
+            Planner_UpdateVertex(cell);
+        }
+
+        startKey = Planner_CalculateKey(PlannerStart);
+    }
+}
+
+
+// ---------- Planner_Init ----------
+// Clears the occupancy grid and plans an initial path from the start to the goal
+// Inputs: int32_t startX, startY - robot's position (mm)
+//         int32_t goalX, goalY - destination's position (mm)
+// Output: planner_t - PLANNER_OK if a path exists, PLANNER_NO_PATH otherwise
+planner_t Planner_Init(int32_t startX, int32_t startY, int32_t goalX, int32_t goalY){
+    uint32_t i;
+
+    // Reset the search
+    for(i = 0; i < PLANNER_NUM_CELLS; i++){
+        PlannerG[i] = PLANNER_INFINITY;
+        PlannerRhs[i] = PLANNER_INFINITY;
+        PlannerHeapPos[i] = NOT_IN_HEAP;
+    }
+    for(i = 0; i < sizeof(PlannerOccupied); i++){
+        PlannerOccupied[i] = 0;
+        PlannerClosed[i] = 0;
+    }
+    PlannerHeapSize = 0;
+    PlannerKm = 0;
+    PlannerExpansions = 0;
+
+    // Both endpoints have to be on the grid
+    PlannerValid = Planner_CellFromPos(startX, startY, &PlannerStart) && Planner_CellFromPos(goalX, goalY, &PlannerGoal);
+    if(!PlannerValid){
+        return PLANNER_NO_PATH;
+    }
+    PlannerLastStart = PlannerStart;
+    PlannerGoalX = goalX;
+    PlannerGoalY = goalY;
+
+    // The search runs backwards from the goal
+    PlannerRhs[PlannerGoal] = 0;
+    Planner_HeapSet(Planner_CalculateKey(PlannerGoal));
+    Planner_ComputeShortestPath();
+
+    return (PlannerRhs[PlannerStart] != PLANNER_INFINITY) ? PLANNER_OK : PLANNER_NO_PATH;
+}
+
+
+// ---------- Planner_MarkOccupied ----------
+// Marks the cell containing an obstacle (and the cells around it) as occupied
+// and updates the neighbours whose cheapest path went through them.
+// The open list keys use the previous start, which are lower bounds that
+// Planner_Replan corrects lazily, so no search happens until then
+// Inputs: int32_t xPos, yPos - position of the obstacle (mm)
+// Output: uint32_t - number of cells that were newly marked occupied
+uint32_t Planner_MarkOccupied(int32_t xPos, int32_t yPos){
+    uint16_t center, cell, pred;
+    int32_t col, row, dc, dr;
+    uint32_t dir;
+    uint32_t marked = 0;
+
+    if(!PlannerValid || !Planner_CellFromPos(xPos, yPos, &center)){
+        return 0;
+    }
+
+    col = center % PLANNER_GRID_WIDTH;
+    row = center / PLANNER_GRID_WIDTH;
+    for(dr = -PLANNER_INFLATE_CELLS; dr <= PLANNER_INFLATE_CELLS; dr++){
+        for(dc = -PLANNER_INFLATE_CELLS; dc <= PLANNER_INFLATE_CELLS; dc++){
+            // Skip cells outside of the grid
+            if(col + dc < 0 || col + dc >= PLANNER_GRID_WIDTH || row + dr < 0 || row + dr >= PLANNER_GRID_HEIGHT){
+                continue;
+            }
+
+            // The goal is never marked so it stays reachable
+            cell = (uint16_t)((row + dr) * PLANNER_GRID_WIDTH + col + dc);
+            if(BIT_GET(PlannerOccupied, cell) || cell == PlannerGoal){
+                continue;
+            }
+            BIT_SET(PlannerOccupied, cell);
+            marked++;
+
+            // Entering the cell now costs infinity, so neighbours that used it need new costs
+            if(PlannerG[cell] == PLANNER_INFINITY){
+                continue;
+            }
+            for(dir = 0; dir < 8; dir++){
+                pred = Planner_Neighbour(cell, dir);
+                if(pred != NO_CELL && pred != PlannerGoal && PlannerRhs[pred] == NeighbourCost[dir] + PlannerG[cell]){
+                    PlannerRhs[pred] = Planner_MinSuccessor(pred);
+                    Planner_UpdateVertex(pred);
+                }
+            }
+        }
+    }
+
+    return marked;
+}
+
+
+// ---------- Planner_IsOccupied ----------
+// Checks whether a position is in an occupied cell
+// Inputs: int32_t xPos, yPos - position (mm)
+// Output: uint8_t - 1 if occupied or outside of the grid, 0 otherwise
+uint8_t Planner_IsOccupied(int32_t xPos, int32_t yPos){
+    uint16_t cell;
+
+    if(!Planner_CellFromPos(xPos, yPos, &cell)){
+        return 1;
+    }
+    return BIT_GET(PlannerOccupied, cell) != 0;
+}
+
+
+// ---------- Planner_Replan ----------
+// Moves the start to the robot's position and repairs the previous search
+// after cells were marked occupied
+// Inputs: int32_t startX, startY - robot's position (mm)
+// Output: planner_t - PLANNER_OK if a path exists, PLANNER_NO_PATH otherwise
+planner_t Planner_Replan(int32_t startX, int32_t startY){
+    uint16_t cell;
+
+    if(!PlannerValid || !Planner_CellFromPos(startX, startY, &cell)){
+        return PLANNER_NO_PATH;
+    }
+
+    // Keys already in the open list stay valid by offsetting new keys with km
+    PlannerStart = cell;
+    PlannerKm += Planner_Heuristic(PlannerLastStart, PlannerStart);
+    PlannerLastStart = PlannerStart;
+
+    Planner_ComputeShortestPath();
+
+    return (PlannerRhs[PlannerStart] != PLANNER_INFINITY) ? PLANNER_OK : PLANNER_NO_PATH;
+}
+
+
+// ---------- Planner_GetWaypoints ----------
+// Follows the cheapest neighbours from the start to the goal and returns the
+// points where the path changes direction. The last waypoint is the goal itself
+// Inputs: Waypoint* list - array to store the waypoints
+//         uint32_t maxWaypoints - size of the array
+// Output: uint32_t - number of waypoints (0 if there is no path)
+uint32_t Planner_GetWaypoints(Waypoint *list, uint32_t maxWaypoints){
+    uint16_t cell = PlannerStart;
+    uint16_t next, bestNext, cost, bestCost;
+    uint32_t dir, bestDir, prevDir = 8;
+    uint32_t count = 0;
+    uint32_t i;
+
+    if(!PlannerValid || maxWaypoints == 0 || PlannerRhs[PlannerStart] == PLANNER_INFINITY){
+        return 0;
+    }
+
+    // The closed set marks the cells already on the path so a loop can't occur
+    for(i = 0; i < sizeof(PlannerClosed); i++){
+        PlannerClosed[i] = 0;
+    }
+    BIT_SET(PlannerClosed, cell);
+
+    while(cell != PlannerGoal){
+        // Find the cheapest neighbour
+        bestCost = PLANNER_INFINITY;
+        bestNext = NO_CELL;
+        bestDir = 0;
+        for(dir = 0; dir < 8; dir++){
+            next = Planner_Neighbour(cell, dir);
+            if(next != NO_CELL && !BIT_GET(PlannerClosed, next)){
+                cost = Planner_PathCost(next, dir);
+                if(cost < bestCost){
+                    bestCost = cost;
+                    bestNext = next;
+                    bestDir = dir;
+                }
+            }
+        }
+        if(bestNext == NO_CELL){
+            return 0;
+        }
+
+        // The current cell is a corner of the path if the direction changes
+        if(prevDir != 8 && bestDir != prevDir){
+            list[count].xPos = PLANNER_ORIGIN_X_MM + (cell % PLANNER_GRID_WIDTH) * PLANNER_CELL_MM + PLANNER_CELL_MM / 2;
+            list[count].yPos = PLANNER_ORIGIN_Y_MM + (cell / PLANNER_GRID_WIDTH) * PLANNER_CELL_MM + PLANNER_CELL_MM / 2;
+            count++;
+            if(count == maxWaypoints){
+                return count;
+            }
+        }
+
+        prevDir = bestDir;
+        cell = bestNext;
+        BIT_SET(PlannerClosed, cell);
+    }
+
+    // The final waypoint is the exact goal position
+    list[count].xPos = PlannerGoalX;
+    list[count].yPos = PlannerGoalY;
+    return count + 1;
+}
+
+
+// ---------- Planner_GetPathCost ----------
+// Returns the cost of the current path from the start to the goal
+// Inputs: none
+// Output: uint32_t - path cost (PLANNER_STRAIGHT_COST per cell), PLANNER_INFINITY if there is no path
+uint32_t Planner_GetPathCost(void){
+    if(!PlannerValid){
+        return PLANNER_INFINITY;
+    }
+    return PlannerRhs[PlannerStart];
+}
+
+
+// ---------- Planner_GetExpansions ----------
+// Returns the number of cells expanded by the last search (for benchmarking)
+// Inputs: none
+// Output: uint32_t - number of expansions
+uint32_t Planner_GetExpansions(void){
+    return PlannerExpansions;
+}
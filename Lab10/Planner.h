@@ -0,0 +1,78 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <stdint.h>
+
+/*
+ * Grid path planner (D* Lite) over the robot's occupancy grid.
+ *
+ * The arena is divided into square cells of PLANNER_CELL_MM. Cells are marked occupied
+ * as the distance sensors see obstacles, and the planner incrementally repairs the
+ * previous search instead of starting over. The search runs backwards from the goal,
+ * so only the cells whose cost-to-goal changed are re-expanded after a new obstacle.
+ *
+ * Memory (all static, no heap), N = PLANNER_NUM_CELLS = 1280:
+ *   g and rhs costs        2 * N * 2 bytes = 5120 bytes
+ *   open list position         N * 2 bytes = 2560 bytes
+ *   binary heap open list      N * 8 bytes = 10240 bytes
+ *   occupied bitset            N / 8 bytes = 160 bytes
+ *   closed bitset              N / 8 bytes = 160 bytes
+ *   total                      about 18 KB of the 64 KB SRAM
+ *
+ * Worst-case replan time:
+ *   A cell is expanded at most twice per replan (once over-consistent, once
+ *   under-consistent), so a replan is bounded by 2N = 2560 expansions. Each expansion
+ *   touches 8 neighbours, and an under-consistent expansion re-scans the 8 successors
+ *   of each, plus up to log2(N) = 11 heap levels per open list operation.
+ *   Measured with Host/PlannerBench.c on an x86-64 host (-O2): the worst case (robot
+ *   sealed in, every reachable cell expanded once, 1198 expansions) takes 450-950 ns
+ *   per expansion, 0.5-1.1 ms in total, depending on the machine's load. Replans after
+ *   a newly seen obstacle in the benchmark mazes average 48-168 expansions (17-72 us).
+ *   The planner has not been timed on the MSP432. As an estimate only, assuming
+ *   roughly 2500 cycles per expansion on the Cortex-M4F at 48 MHz with 2 flash wait
+ *   states, a worst-case replan would take about 65 ms.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#define PLANNER_CELL_MM      64   /* Side length of a grid cell (mm) */
+#define PLANNER_GRID_WIDTH   32   /* Number of cells along the x axis */
+#define PLANNER_GRID_HEIGHT  40   /* Number of cells along the y axis */
+#define PLANNER_NUM_CELLS    (PLANNER_GRID_WIDTH * PLANNER_GRID_HEIGHT)
+
+#define PLANNER_ORIGIN_X_MM  (-(PLANNER_GRID_WIDTH * PLANNER_CELL_MM) / 2) /* x position of the grid's left edge (mm)   */
+#define PLANNER_ORIGIN_Y_MM  (-4 * PLANNER_CELL_MM)                        /* y position of the grid's bottom edge (mm) */
+
+#define PLANNER_ROBOT_RADIUS_MM 75 /* Distance from the robot's center to its bumpers (mm) */
+#define PLANNER_INFLATE_CELLS ((PLANNER_ROBOT_RADIUS_MM + PLANNER_CELL_MM - 1) / PLANNER_CELL_MM) /* Cells around an obstacle that are also marked occupied */
+#define PLANNER_MAX_WAYPOINTS 32  /* Maximum number of waypoints returned for one path */
+
+#define PLANNER_STRAIGHT_COST 10  /* Cost to move to an adjacent cell */
+#define PLANNER_DIAGONAL_COST 14  /* Cost to move to a diagonal cell */
+#define PLANNER_INFINITY      0xFFFF
+
+#define PLANNER_OK            1   /* A path to the goal exists */
+#define PLANNER_NO_PATH       0   /* The goal is unreachable or outside of the grid */
+
+
+// X and y position of a point on the planned path (mm)
+typedef struct Waypoint{
+    int32_t xPos;
+    int32_t yPos;
+} Waypoint;
+
+// Return type for the planner functions
+typedef int32_t planner_t;
+
+
+// --------------------- Function Prototypes ---------------------
+planner_t Planner_Init(int32_t startX, int32_t startY, int32_t goalX, int32_t goalY);
+uint32_t Planner_MarkOccupied(int32_t xPos, int32_t yPos);
+uint8_t Planner_IsOccupied(int32_t xPos, int32_t yPos);
+planner_t Planner_Replan(int32_t startX, int32_t startY);
+uint32_t Planner_GetWaypoints(Waypoint *list, uint32_t maxWaypoints);
+uint32_t Planner_GetPathCost(void);
+uint32_t Planner_GetExpansions(void);
+
+#endif
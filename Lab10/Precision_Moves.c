@@ -4,6 +4,15 @@
 #include "Precision_Moves.h"
 
 
+PrecisionPoll_t Precision_Poll = 0;
+
+
+#ifdef PRECISION_MOVES_TUNABLE
+// Gains of the macros in Precision_Moves.h
+_Thread_local PrecisionGains Precision_Gains = {20, 1, 0.2f, 20, 60};
+#endif
+
+
 // This function turns the robot right for a given number of steps (desiredSteps) to realize
 // a certain angular turn about the center of graviy. The left and right wheels needs to turn at the
 // same speed in opposite directions
@@ -33,10 +42,16 @@ ret_t Motor_Precision_Right(int16_t speed, int32_t desiredSteps, uint8_t distanc
     rightSteps = rightInitSteps;
 
     // Turn on the lights
-    Front_Lights_ON();
+    Lights_SetPattern(LIGHTS_ON);
 
     // Proportional controller
     while( ((leftSteps - leftInitSteps) < desiredSteps) && ((rightInitSteps - rightSteps) < desiredSteps) ){
+        // Stop if asked to from outside the move
+        if(Precision_Poll && Precision_Poll()){
+            hasReached = DRIVING_INTERRUPTED;
+            break;
+        }
+
         // If interrupt is turned on
         if(distanceInterrupt == DO_INTERRUPT){
             // Get distances from each sensor
@@ -72,7 +87,7 @@ ret_t Motor_Precision_Right(int16_t speed, int32_t desiredSteps, uint8_t distanc
     Motor_Left(updateLeft, updateRight);
     Clock_Delay1ms(ACTIVE_BRAKING_DELAY_MS);
     Motor_Stop();
-    Front_Lights_OFF();
+    Lights_SetPattern(LIGHTS_OFF);
 
     return hasReached;
 }
@@ -107,10 +122,16 @@ ret_t Motor_Precision_Left(int16_t speed, int32_t desiredSteps, uint8_t distance
     rightSteps = rightInitSteps;
 
     // Turn on the lights
-    Front_Lights_ON();
+    Lights_SetPattern(LIGHTS_ON);
 
     // Proportional controller
     while( ((rightSteps - rightInitSteps) < desiredSteps) && ((leftInitSteps - leftSteps) < desiredSteps) ){
+        // Stop if asked to from outside the move
+        if(Precision_Poll && Precision_Poll()){
+            hasReached = DRIVING_INTERRUPTED;
+            break;
+        }
+
         // If interrupt is turned on
         if(distanceInterrupt == DO_INTERRUPT){
             // Get distances from each sensor
@@ -146,7 +167,7 @@ ret_t Motor_Precision_Left(int16_t speed, int32_t desiredSteps, uint8_t distance
     Motor_Right(updateLeft, updateRight);
     Clock_Delay1ms(ACTIVE_BRAKING_DELAY_MS);
     Motor_Stop();
-    Front_Lights_OFF();
+    Lights_SetPattern(LIGHTS_OFF);
 
     return hasReached;
 }
@@ -186,10 +207,16 @@ ret_t Motor_Forward_RPM(uint16_t leftRPM, uint16_t rightRPM, int32_t desiredLSte
     prevRightTime = rightInitTime;
 
     // Turn on the front lights
-    Front_Lights_ON();
+    Lights_SetPattern(LIGHTS_ON);
 
     // Proportional Integral Controller
     while( ((leftSteps - leftInitSteps) < desiredLSteps) && ((rightSteps - rightInitSteps) < desiredRSteps) ){
+        // Stop if asked to from outside the move
+        if(Precision_Poll && Precision_Poll()){
+            hasReached = DRIVING_INTERRUPTED;
+            break;
+        }
+
         // Get distances from each sensor
         Distance_GetDistances(&leftDist, &centerDist, &rightDist);
 
@@ -259,11 +286,10 @@ ret_t Motor_Forward_RPM(uint16_t leftRPM, uint16_t rightRPM, int32_t desiredLSte
 
     // Active braking
     Motor_Backward(updateLeft, updateRight);
-    Front_Lights_OFF();
-    Back_Lights_ON();
+    Lights_SetPattern(LIGHTS_BRAKING);
     Clock_Delay1ms(ACTIVE_BRAKING_DELAY_MS);
     Motor_Stop();
-    Back_Lights_OFF();
+    Lights_SetPattern(LIGHTS_OFF);
 
     return hasReached;
 }
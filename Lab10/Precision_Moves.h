@@ -15,6 +15,7 @@
 #include "Motor.h"
 #include "Tachometer.h"
 #include "RobotLights.h"
+#include "Lights.h"
 #include "Distance.h"
 
 
@@ -42,18 +43,24 @@ typedef int32_t ret_t;
 #define STEPS_TO_DISTANCE_FL(steps) ((float)steps * PI * (float)DIAMETER_MM / ((float)PULSES_PER_REV)) /* Steps (float) to distance (mm)    */
 #define STEPS_TO_DISTANCE(steps)    (int32_t)(STEPS_TO_DISTANCE_FL(steps))                             /* Steps (int) to distance (mm)      */
 
+#if !defined(PRECISION_MOVES_TUNABLE) && !defined(PARAMS_LIVE)
 #define KP_SPIN(error)    (int32_t)(error*20)     /* Proportional term for spinning controller    */
 #define KP_FORWARD(error) (int32_t)(error)       /* Proportional term for forward controller     */
 #define KI_FORWARD(error) (int32_t)(error/5)     /* Integral term for the forward controller     */
+#endif
 
+#ifndef PARAMS_LIVE
 #define INTEGRAL_MIN           -200              /* Minimum integral term (to prevent windup)    */
 #define INTEGRAL_MAX            200              /* Maxumum integral term (to prevent windup)    */
+#endif
 
 #define MIN_DUTY_CYCLE          0                /* Minimum duty cycle for the wheel motors      */
 #define MAX_DUTY_CYCLE          14998            /* Maximum duty cycle for the wheel motors      */
 
+#if !defined(PRECISION_MOVES_TUNABLE) && !defined(PARAMS_LIVE)
 #define SPIN_DELAY_MS           20               /* Delay between spinning controller iterations */
 #define FORWARD_DELAY_MS        60               /* Delay between forward controller iterations  */
+#endif
 #define ACTIVE_BRAKING_DELAY_MS 60               /* Delay for the length of active braking       */
 
 #define RPM_TO_DUTY_EST(rpm)    (int32_t)(6*rpm) /* Estimate for the starting duty cycle of the forward controller */
@@ -63,8 +70,60 @@ typedef int32_t ret_t;
 #define NO_INTERRUPT 0 /* Spin function should not interrupt when the opposite side is open */
 #define DO_INTERRUPT    1 /* Spin function should interrupt when the opposite side is open     */
 
+#ifndef PARAMS_LIVE
 #define MIN_DISTANCE_MM     150 /* Minimum distance from a sensor to an object         */
 #define MAX_DISTANCE_MM     200 /* Maximum distance before the sensor is declared open */
+#endif
+
+
+// Host builds with PRECISION_MOVES_TUNABLE (Host/GainSweep.c) read the controller gains
+// and periods from Precision_Gains at run time instead. Each thread has its own copy,
+// so simulated runs with different gains can run side by side.
+#ifdef PRECISION_MOVES_TUNABLE
+typedef struct PrecisionGains{
+    float kpSpin;             // KP_SPIN
+    float kpForward;          // KP_FORWARD
+    float kiForward;          // KI_FORWARD
+    uint32_t spinDelayMs;     // SPIN_DELAY_MS
+    uint32_t forwardDelayMs;  // FORWARD_DELAY_MS
+} PrecisionGains;
+
+extern _Thread_local PrecisionGains Precision_Gains;
+
+#define KP_SPIN(error)    (int32_t)((error)*Precision_Gains.kpSpin)
+#define KP_FORWARD(error) (int32_t)((error)*Precision_Gains.kpForward)
+#define KI_FORWARD(error) (int32_t)((error)*Precision_Gains.kiForward)
+#define SPIN_DELAY_MS     Precision_Gains.spinDelayMs
+#define FORWARD_DELAY_MS  Precision_Gains.forwardDelayMs
+#endif
+
+
+// Built with PARAMS_LIVE (Lab10/Params.h) the gains, delays and thresholds above are
+// read from the parameter registry, so they can be tuned over BLE while the robot
+// runs. The constants are the registry's defaults
+#ifdef PARAMS_LIVE
+#ifdef PRECISION_MOVES_TUNABLE
+#error "PARAMS_LIVE and PRECISION_MOVES_TUNABLE both replace the gains"
+#endif
+#include "Params.h"
+
+#define KP_SPIN(error)    (int32_t)((error)*Params.kpSpin)
+#define KP_FORWARD(error) (int32_t)((error)*Params.kpForward)
+#define KI_FORWARD(error) (int32_t)((error)*Params.kiForward)
+#define SPIN_DELAY_MS     Params.spinDelayMs
+#define FORWARD_DELAY_MS  Params.forwardDelayMs
+#define INTEGRAL_MAX      Params.integralMax
+#define INTEGRAL_MIN      (-Params.integralMax)
+#define MIN_DISTANCE_MM   Params.minDistanceMm
+#define MAX_DISTANCE_MM   Params.maxDistanceMm
+#endif
+
+
+// Called every controller iteration of the moves below, 0 for none. A move stops
+// early (DRIVING_INTERRUPTED) when it returns nonzero, so the caller can stop the
+// robot from outside the move (Lab10/Mission.c)
+typedef uint32_t (*PrecisionPoll_t)(void);
+extern PrecisionPoll_t Precision_Poll;
 
 
 // --------------------- Function Prototypes ---------------------
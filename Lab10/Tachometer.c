@@ -54,7 +54,9 @@ policies, either expressed or implied, of the FreeBSD Project.
 #include "TA3InputCapture.h"
 #include "msp.h"
 #include "Tachometer.h"
+#include "RamFunc.h"
 #include "Precision_Moves.h"
+#include "Journal.h"
 
 
 uint16_t Tachometer_FirstRightTime, Tachometer_SecondRightTime;
@@ -66,7 +68,7 @@ int Tachometer_RightSteps = 0;     // incremented with every step forward; decre
 int Tachometer_LeftSteps = 0;      // incremented with every step forward; decremented with every step backward
 
 
-void tachometerRightInt(uint16_t currenttime){
+RAMFUNC void tachometerRightInt(uint16_t currenttime){
     Tachometer_FirstRightTime = Tachometer_SecondRightTime;
     Tachometer_SecondRightTime = currenttime;
     uint16_t tDiff;
@@ -79,9 +81,12 @@ void tachometerRightInt(uint16_t currenttime){
         // Encoder B is high, so this is a step forward
         Tachometer_RightSteps = Tachometer_RightSteps + 1;
     }
+#ifdef JOURNAL_RECORD
+    Journal_TachEdge(JOURNAL_RIGHT, tDiff, P5->IN&0x01);
+#endif
 }
 
-void tachometerLeftInt(uint16_t currenttime){
+RAMFUNC void tachometerLeftInt(uint16_t currenttime){
     Tachometer_FirstLeftTime = Tachometer_SecondLeftTime;
     Tachometer_SecondLeftTime = currenttime;
     uint16_t tDiff;
@@ -94,6 +99,9 @@ void tachometerLeftInt(uint16_t currenttime){
         // Encoder B is high, so this is a step forward
         Tachometer_LeftSteps = Tachometer_LeftSteps + 1;
     }
+#ifdef JOURNAL_RECORD
+    Journal_TachEdge(JOURNAL_LEFT, tDiff, (P5->IN&0x04) >> 2);
+#endif
 }
 
 
@@ -125,8 +133,14 @@ void Tachometer_Init(void){
 // Assumes: Clock_Init48MHz() has been called
 // By J. Tadrous on 2/16/2023
 void Tachometer_Get_Steps(int32_t *leftSteps, int32_t *rightSteps){
+#ifdef JOURNAL_RECORD
+    uint32_t primask = Journal_TachReadStart();
+#endif
     *leftSteps = Tachometer_LeftSteps;
     *rightSteps = Tachometer_RightSteps;
+#ifdef JOURNAL_RECORD
+    Journal_TachReadEnd(primask);
+#endif
 }
 
 // ------------Tachometer_Get_SpaceTime------------
@@ -141,7 +155,17 @@ void Tachometer_Get_Steps(int32_t *leftSteps, int32_t *rightSteps){
 // Assumes: Clock_Init48MHz() has been called
 // By J. Tadrous on 7/6/2023
 void Tachometer_Get_SpaceTime(int32_t *leftSteps, int32_t *rightSteps, uint32_t *leftTime, uint32_t *rightTime){
+#ifdef JOURNAL_RECORD
+    // Steps and times are read together, so the journal sees a single read
+    uint32_t primask = Journal_TachReadStart();
+    *leftSteps = Tachometer_LeftSteps;
+    *rightSteps = Tachometer_RightSteps;
+#else
     Tachometer_Get_Steps(leftSteps, rightSteps);
+#endif
     *rightTime = timeAccumulatorRight;
     *leftTime = timeAccumulatorLeft;
+#ifdef JOURNAL_RECORD
+    Journal_TachReadEnd(primask);
+#endif
 }
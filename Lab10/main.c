@@ -3,8 +3,12 @@
 #include "Motor.h"
 #include "Tachometer.h"
 #include "RobotLights.h"
+#include "Lights.h"
 #include "Odometry.h"
 #include "ADC14.h"
+#include "Bug.h"
+#include "Journal.h"
+#include "Mission.h"
 
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -23,6 +27,24 @@
 #define DELAY_MS          250    /* Delay between each step in the main loop (milliseconds) */
 #define MAX_SPIN_DEGREES  90     /* Maximum degrees to spin before attempting to move forwards (when going around an object) */
 
+#define NAV_SPIN_AND_FORWARD 0   /* Spin away from obstacles and drive forwards a set distance */
+#define NAV_PLANNER          1   /* Plan a path around the obstacles seen so far on the grid   */
+#define NAV_BUG              2   /* Follow obstacle boundaries continuously (Tangent-Bug/Bug2) */
+#define NAV_MISSION          3   /* Drive to the waypoints uploaded over BLE (Mission.h), spinning and driving forwards around obstacles */
+
+#ifndef NAVIGATION_MODE
+#define NAVIGATION_MODE NAV_BUG /* How to get around obstacles. The host simulation builds every mode */
+#endif
+
+// The mission service and the live parameters run over BLE (Lab08/AP.h)
+#if NAVIGATION_MODE == NAV_MISSION || defined(PARAMS_LIVE)
+#define USE_BLE
+#include "AP.h"
+#endif
+
+#define ROBOT_SERVICE_UUID 0xFFE0 /* BLE service with the mission (Mission.h) and parameter characteristics */
+#define PARAMS_UUID        0xFFE4 /* Parameter characteristic (Params.h), built with PARAMS_LIVE              */
+
 
 ///////////////////////////////////////////////////////////////////////////////////////
 // Main Program
@@ -30,6 +52,14 @@
 
 void Pause(void); /* Debug function */
 
+#ifdef USE_BLE
+static int BLE_Init(const Coordinates* robot);
+static uint32_t BLE_Poll(void);
+static void Idle(uint32_t ms);
+#else
+#define Idle(ms) Clock_Delay1ms(ms) /* Nothing else runs while the robot waits */
+#endif
+
 
 // ---------- main ----------
 // Program entry point
@@ -44,46 +74,172 @@ void main(void){
     ADC0_InitSWTriggerCh17_14_16();
     Motor_Init();
     Tachometer_Init();
-    MvtLED_Init();
-    Front_Lights_OFF();
-    Back_Lights_OFF();
+    Lights_Init();
+    Lights_SetPattern(LIGHTS_OFF);
+#ifdef JOURNAL_RECORD
+    Journal_Init(NAVIGATION_MODE);
+#endif
+#ifdef PARAMS_LIVE
+    Params_Init();
+#endif
 
     // Containers for use in main loop
     ret_t reachedDest;
+#if NAVIGATION_MODE == NAV_SPIN_AND_FORWARD || NAVIGATION_MODE == NAV_MISSION
     side_t spinDirection;
+#endif
 
     // Coordinates for the robot and the destination
     Coordinates robot = {STARTING_X_POS, STARTING_Y_POS, STARTING_HEADING};
+#if NAVIGATION_MODE != NAV_MISSION
     const Coordinates destination = {DESTINATION_X_POS, DESTINATION_Y_POS, DESTINATION_HEADING};
+#endif
+
+#ifdef USE_BLE
+    // Start the BLE service, moves and Idle keep the link running. Without it
+    // only the mission cannot run
+    if(BLE_Init(&robot) == APOK){
+        Precision_Poll = &BLE_Poll;
+    } else if(NAVIGATION_MODE == NAV_MISSION){
+        Pause();
+    }
+#endif
 
     // Slight delay before starting
-    Clock_Delay1ms(START_DELAY_MS);
+    Idle(START_DELAY_MS);
+
+#if NAVIGATION_MODE == NAV_BUG
+    // Drive to the destination without stopping, going around obstacles on the way
+    reachedDest = Bug_Navigate(&robot, &destination);
+
+    // If the robot reached the destination, stay there
+    while(reachedDest == REACHED_DESTINATION){
+        Idle(INFINITE_LOOP_DELAY);
+    }
+
+    // Robot circled an obstacle without finding a way to the destination
+    Pause();
+#elif NAVIGATION_MODE == NAV_PLANNER
+    // Waypoints from the planner and the one currently being driven to
+    Waypoint path[PLANNER_MAX_WAYPOINTS];
+    uint32_t numWaypoints;
+    Coordinates waypoint = {0, 0, 0};
+
+    // Plan the initial path with an empty map
+    Planner_Init(robot.xPos, robot.yPos, destination.xPos, destination.yPos);
+
+    // Main loop
+    while(TRUE){
+
+        // Add any obstacles the sensors can see to the map and repair the path
+        Odometry_MapObstacles(&robot);
+        numWaypoints = 0;
+        if(Planner_Replan(robot.xPos, robot.yPos) == PLANNER_OK){
+            numWaypoints = Planner_GetWaypoints(path, PLANNER_MAX_WAYPOINTS);
+        }
+
+        // If there is no path to the destination, stop here
+        if(numWaypoints == 0){
+            Motor_Stop();
+            Pause();
+        }
+
+        // Correct heading by spinning towards the next waypoint
+        waypoint.xPos = path[0].xPos;
+        waypoint.yPos = path[0].yPos;
+        Odometry_CorrectSpin(&robot, &waypoint);
+        Idle(DELAY_MS);
+
+        // The sensors now look along the path, plan again if they see something new
+        if(Odometry_MapObstacles(&robot)){
+            continue;
+        }
+
+        // Move forward until robot reaches the waypoint or is blocked
+        reachedDest = Odometry_DriveForward(&robot, &waypoint);
+        Idle(DELAY_MS);
+
+        // If the waypoint was the destination and the robot reached it, stay there
+        while(numWaypoints == 1 && reachedDest == REACHED_DESTINATION){
+            Idle(INFINITE_LOOP_DELAY);
+        }
+    }
+#elif NAVIGATION_MODE == NAV_MISSION
+    // Waypoint currently being driven to
+    Coordinates waypoint = {0, 0, 0};
+
+    // Let the mission stop moves from inside the controller loops
+    Precision_Poll = &Mission_Poll;
+
+    // Main loop
+    while(TRUE){
+
+        // Wait for the phone to start the mission, its speed command sets the speed.
+        // The BGR LED shows whether the phone is connected
+        while(!Mission_NextWaypoint(&waypoint)){
+            Lights_SetPattern(AP_Connected() ? LIGHTS_BLE_CONNECTED : LIGHTS_WAITING);
+            Idle(1);
+        }
+
+        // Correct heading by spinning towards the waypoint
+        Odometry_CorrectSpin(&robot, &waypoint);
+        Mission_Report(&robot);
+        if(Mission_Poll()){
+            continue;
+        }
+        Idle(DELAY_MS);
+
+        // Move forward until robot reaches the waypoint or is blocked
+        reachedDest = Odometry_DriveForward(&robot, &waypoint);
+        Mission_Report(&robot);
+        Idle(DELAY_MS);
+        if(reachedDest == REACHED_DESTINATION){
+            Mission_Reached(&robot);
+            continue;
+        }
 
+        // Paused, aborted or re-tasked rather than blocked
+        if(Mission_Poll()){
+            continue;
+        }
+
+        // Robot reached an obstacle, so spin away from it and move forwards
+        spinDirection = Odometry_PickSide(&robot, &waypoint);
+        Odometry_Spin(&robot, spinDirection, MAX_SPIN_DEGREES);
+        Idle(DELAY_MS);
+        Odometry_Forward(&robot);
+        Mission_Report(&robot);
+        Idle(DELAY_MS);
+    }
+#else
     // Main loop
     while(TRUE){
 
         // Correct heading by spinning towards the destination
         Odometry_CorrectSpin(&robot, &destination);
-        Clock_Delay1ms(DELAY_MS);
+        Idle(DELAY_MS);
 
         // Move forward until robot reaches destination or is blocked
         reachedDest = Odometry_DriveForward(&robot, &destination);
-        Clock_Delay1ms(DELAY_MS);
+        Idle(DELAY_MS);
 
-        // If the robot reached the destination, this function will not return
-        Odometry_CheckFinished(reachedDest);
+        // If the robot reached the destination, stay there
+        while(reachedDest == REACHED_DESTINATION){
+            Idle(INFINITE_LOOP_DELAY);
+        }
 
         // Robot reached an obstacle, so pick a direction to spin
         spinDirection = Odometry_PickSide(&robot, &destination);
 
         // Spin in the direction until the opposite sensor is not scanning the object
         Odometry_Spin(&robot, spinDirection, MAX_SPIN_DEGREES);
-        Clock_Delay1ms(DELAY_MS);
+        Idle(DELAY_MS);
 
         // Move forwards for a certain distance (return variable not used)
         Odometry_Forward(&robot);
-        Clock_Delay1ms(DELAY_MS);
+        Idle(DELAY_MS);
     }
+#endif
 }
 
 
@@ -92,7 +248,70 @@ void main(void){
 // Inputs: none
 // Output: none
 void Pause(void){
+    Lights_SetPattern(LIGHTS_FAULT);
     while(TRUE){
-        Clock_Delay1ms(INFINITE_LOOP_DELAY);
+        Idle(INFINITE_LOOP_DELAY);
+    }
+}
+
+
+#ifdef USE_BLE
+// ---------- BLE_Init ----------
+// Resets the Bluetooth module, creates the robot's service with the characteristics
+// of this build and starts advertising
+// Inputs: const Coordinates* robot - robot's starting coordinates
+// Output: int - APOK if successful, APFAIL if the SNP fails
+static int BLE_Init(const Coordinates* robot){
+    if(AP_Init() == APFAIL){
+        return APFAIL;
+    }
+    if(AP_AddService(ROBOT_SERVICE_UUID) == APFAIL){
+        return APFAIL;
+    }
+#if NAVIGATION_MODE == NAV_MISSION
+    if(Mission_Init(robot) == APFAIL){
+        return APFAIL;
+    }
+#else
+    (void)robot;
+#endif
+#ifdef PARAMS_LIVE
+    if(Params_AddCharacteristic(PARAMS_UUID) == APFAIL){
+        return APFAIL;
+    }
+#endif
+    if(AP_RegisterService() == APFAIL){
+        return APFAIL;
+    }
+    return AP_StartAdvertisement();
+}
+
+
+// ---------- BLE_Poll ----------
+// Runs the BLE link. Precision_Poll outside of a mission, never stops a move
+// Inputs: none
+// Output: uint32_t - always 0
+static uint32_t BLE_Poll(void){
+    AP_BackgroundProcess();
+    return 0;
+}
+
+
+// ---------- Idle ----------
+// Waits with the motors stopped, running the BLE link. A parameter save the phone
+// asked for is written here, as erasing flash stalls the CPU for milliseconds
+// Inputs: uint32_t ms - time to wait (milliseconds)
+// Output: none
+static void Idle(uint32_t ms){
+    while(ms > 0){
+        if(Precision_Poll){
+            Precision_Poll();
+        }
+#ifdef PARAMS_LIVE
+        Params_SaveIfPending();
+#endif
+        Clock_Delay1ms(1);
+        ms--;
     }
 }
+#endif
@@ -0,0 +1,119 @@
+#include <stdint.h>
+#include "Motor.h"
+#include "Tachometer.h"
+#include "Speed.h"
+
+
+// Controller state of one wheel
+typedef struct SpeedWheel{
+    int32_t target;      // Target speed (0.1 RPM, negative backward)
+    int32_t rpm;         // Measured speed (0.1 RPM)
+    int32_t integral;    // Integral term (duty cycle)
+    int32_t duty;        // Duty cycle sent to the motor (negative backward)
+    int32_t prevSteps;   // Tachometer steps at the last update
+    uint32_t prevTime;   // Tachometer time at the last update (12 MHz ticks)
+} SpeedWheel;
+
+static SpeedWheel SpeedLeft, SpeedRight;
+
+
+// ---------- Speed_Init ----------
+// Stops both wheels and starts measuring from the current tachometer counts
+// (Tachometer_Init and Motor_Init must have been called)
+// Inputs: none
+// Output: none
+void Speed_Init(void){
+    SpeedWheel stopped = {0, 0, 0, 0, 0, 0};
+
+    SpeedLeft = stopped;
+    SpeedRight = stopped;
+    Tachometer_Get_SpaceTime(&SpeedLeft.prevSteps, &SpeedRight.prevSteps, &SpeedLeft.prevTime, &SpeedRight.prevTime);
+    Motor_Stop();
+}
+
+
+// ---------- Speed_Set ----------
+// Sets the target speed of each wheel, used from the next Speed_Update
+// Inputs: int32_t leftRPM, rightRPM - target speeds (0.1 RPM, negative backward)
+// Output: none
+void Speed_Set(int32_t leftRPM, int32_t rightRPM){
+    SpeedLeft.target = leftRPM;
+    SpeedRight.target = rightRPM;
+}
+
+
+// ---------- Speed_Measure ----------
+// Measures one wheel since the last update
+static void Speed_Measure(SpeedWheel* wheel, int32_t steps, uint32_t time, uint32_t periodMs){
+    int32_t moved = steps - wheel->prevSteps;
+
+    if((moved >= SPEED_MIN_STEPS) || (moved <= -SPEED_MIN_STEPS)){
+        wheel->rpm = SPEED_RPM(moved, time - wheel->prevTime);
+    } else {
+        wheel->rpm = SPEED_RPM(moved, periodMs * SPEED_TICKS_PER_MS);
+    }
+    wheel->prevSteps = steps;
+    wheel->prevTime = time;
+}
+
+
+// ---------- Speed_Control ----------
+// PI with feedforward for one wheel; a wheel told to stop is stopped and forgets its integral
+static void Speed_Control(SpeedWheel* wheel){
+    int32_t error = wheel->target - wheel->rpm;
+
+    if(wheel->target == 0){
+        wheel->integral = 0;
+        wheel->duty = 0;
+        return;
+    }
+    wheel->integral += error / SPEED_KI_DIVISOR;
+    if(wheel->integral > SPEED_INTEGRAL_MAX){wheel->integral = SPEED_INTEGRAL_MAX;}
+    if(wheel->integral < -SPEED_INTEGRAL_MAX){wheel->integral = -SPEED_INTEGRAL_MAX;}
+
+    wheel->duty = SPEED_DUTY_PER_RPM * wheel->target + SPEED_KP * error + wheel->integral;
+    if(wheel->duty > SPEED_MAX_DUTY){wheel->duty = SPEED_MAX_DUTY;}
+    if(wheel->duty < -SPEED_MAX_DUTY){wheel->duty = -SPEED_MAX_DUTY;}
+}
+
+
+// ---------- Speed_Update ----------
+// Measures both wheels and sets the motors. Call once per period of the main loop
+// Inputs: uint32_t periodMs - time since the last update (ms)
+// Output: none
+void Speed_Update(uint32_t periodMs){
+    int32_t leftSteps, rightSteps;
+    uint32_t leftTime, rightTime;
+    int32_t left, right;
+
+    Tachometer_Get_SpaceTime(&leftSteps, &rightSteps, &leftTime, &rightTime);
+    Speed_Measure(&SpeedLeft, leftSteps, leftTime, periodMs);
+    Speed_Measure(&SpeedRight, rightSteps, rightTime, periodMs);
+    Speed_Control(&SpeedLeft);
+    Speed_Control(&SpeedRight);
+
+    // Motor function for the direction of each wheel
+    left = SpeedLeft.duty;
+    right = SpeedRight.duty;
+    if((left == 0) && (right == 0)){
+        Motor_Stop();
+    } else if((left >= 0) && (right >= 0)){
+        Motor_Forward(left, right);
+    } else if((left < 0) && (right < 0)){
+        Motor_Backward(-left, -right);
+    } else if(left < 0){
+        Motor_Left(-left, right);
+    } else {
+        Motor_Right(left, -right);
+    }
+}
+
+
+// ---------- Speed_Get ----------
+// Speeds measured by the last Speed_Update
+// Inputs: int32_t* leftRPM, rightRPM - set to the measured speeds (0.1 RPM, negative backward)
+// Output: none
+void Speed_Get(int32_t* leftRPM, int32_t* rightRPM){
+    *leftRPM = SpeedLeft.rpm;
+    *rightRPM = SpeedRight.rpm;
+}
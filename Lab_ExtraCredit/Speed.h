@@ -0,0 +1,43 @@
+#ifndef SPEED_H
+#define SPEED_H
+
+#include <stdint.h>
+
+/*
+ * Wheel speed controller on the tachometers, run from the main loop.
+ *
+ * The PI law of Motor_Forward_RPM (Lab10/Precision_Moves.c), per wheel and without
+ * waiting inside it: Speed_Set changes the target RPM of each wheel and returns,
+ * and Speed_Update measures the wheels and sets the motors once per period of the
+ * main loop. The duty cycle is the RPM_TO_DUTY_EST feedforward of the target plus
+ * the PI terms, so a new target is followed at once rather than wound up to.
+ * Targets may be negative (wheel turning backward) and the two wheels may turn
+ * different ways.
+ *
+ * The tachometer times only the last 16 bits of the interval between edges, so
+ * below SPEED_MIN_STEPS steps per update the speed is taken from the steps
+ * counted over the period instead.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#define SPEED_TICKS_PER_MS    12000    /* Tachometer clock (12 MHz)                                  */
+#define SPEED_MIN_STEPS       2        /* Fewer steps in an update than this: counted, not timed     */
+#define SPEED_DUTY_PER_RPM    6        /* Feedforward duty cycle per 0.1 RPM (RPM_TO_DUTY_EST)       */
+#define SPEED_KP              4        /* Duty cycle per 0.1 RPM of error                            */
+#define SPEED_KI_DIVISOR      2        /* Integral grows by the error / SPEED_KI_DIVISOR each update */
+#define SPEED_INTEGRAL_MAX    3000     /* Limit of the integral term (duty cycle)                    */
+#define SPEED_MAX_DUTY        14998    /* Largest duty cycle the Motor functions take                */
+
+// Computes RPM (0.1 RPM) from steps and times, as COMPUTE_RPM in Precision_Moves.h
+#define SPEED_RPM(steps, time) (int32_t)(20000000LL * (steps) / ((int64_t)(time) + 1))
+
+
+// --------------------- Function Prototypes ---------------------
+void Speed_Init(void);
+void Speed_Set(int32_t leftRPM, int32_t rightRPM);
+void Speed_Update(uint32_t periodMs);
+void Speed_Get(int32_t* leftRPM, int32_t* rightRPM);
+
+#endif
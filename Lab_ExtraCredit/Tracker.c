@@ -0,0 +1,145 @@
+#include <stdint.h>
+#include <math.h>
+#include "Speed.h"
+#include "Tracker.h"
+
+
+// Estimate of one quantity and its rate (per second)
+typedef struct TrackFilter{
+    float value;
+    float rate;
+} TrackFilter;
+
+static TrackFilter TrackRange, TrackBearing;
+static uint32_t TrackUnseenMs;   // Time since a sensor last saw the target (ms)
+static uint8_t TrackLost;        // 1 until the target is seen, the filters start over then
+
+
+// ---------- Tracker_Init ----------
+// Forgets the target, the robot stays stopped until a sensor sees it
+// Inputs: none
+// Output: none
+void Tracker_Init(void){
+    TrackRange.value = TRACK_FOLLOW_MM;
+    TrackRange.rate = 0;
+    TrackBearing.value = 0;
+    TrackBearing.rate = 0;
+    TrackUnseenMs = TRACK_COAST_MS;
+    TrackLost = 1;
+}
+
+
+// ---------- Tracker_Filter ----------
+// Alpha-beta update of one filter: predicts over dt with the rate of the target
+// less the robot's own (own), then corrects with the measurement
+static void Tracker_Filter(TrackFilter* filter, float measured, float own, float dt, float alpha, float beta){
+    float error;
+
+    filter->value += (filter->rate - own) * dt;
+    error = measured - filter->value;
+    filter->value += alpha * error;
+    filter->rate += (beta / dt) * error;
+}
+
+
+// ---------- Tracker_Estimate ----------
+// Fuses the sensors into the target's range and bearing and updates their filters
+// Inputs: uint32_t leftDist, centerDist, rightDist - sensor readings (mm, left is to the left of the heading)
+//         uint32_t periodMs - time since the last sample (ms)
+//         float robotSpeed - speed of the robot (mm/s)
+//         float robotTurn - turn rate of the robot (rad/s, positive to the left)
+//         float* range - set to the range of the target from the sensors (mm)
+//         float* speed - set to the speed of the target away from the robot (mm/s)
+//         float* bearing - set to the bearing of the target (radians, positive to the left)
+//         float* sightRate - set to the turn rate of the line to the target (rad/s)
+// Output: uint32_t - TRACK_LOCKED, TRACK_COASTING or TRACK_LOST
+uint32_t Tracker_Estimate(uint32_t leftDist, uint32_t centerDist, uint32_t rightDist, uint32_t periodMs,
+                          float robotSpeed, float robotTurn, float* range, float* speed, float* bearing, float* sightRate){
+    const float angles[3] = {TRACK_SIDE_ANGLE, 0.0f, -TRACK_SIDE_ANGLE};
+    uint32_t dists[3];
+    float x = 0, y = 0, weight, total = 0;
+    float dt = periodMs / 1000.0f;
+    uint32_t i, status = TRACK_LOCKED;
+
+    dists[0] = leftDist;
+    dists[1] = centerDist;
+    dists[2] = rightDist;
+    for(i = 0; i < 3; i++){
+        if(dists[i] < TRACK_DETECT_MM){
+            weight = (float)(TRACK_DETECT_MM - dists[i]);
+            x += weight * dists[i] * cosf(angles[i]);
+            y += weight * dists[i] * sinf(angles[i]);
+            total += weight;
+        }
+    }
+
+    if(total > 0){
+        x /= total;
+        y /= total;
+        if(TrackLost){
+            // Seen again: start over from this reading, moving with the robot
+            TrackRange.value = sqrtf(x * x + y * y);
+            TrackRange.rate = robotSpeed;
+            TrackBearing.value = atan2f(y, x);
+            TrackBearing.rate = robotTurn;
+            TrackLost = 0;
+        } else {
+            Tracker_Filter(&TrackRange, sqrtf(x * x + y * y), robotSpeed, dt, TRACK_RANGE_ALPHA, TRACK_RANGE_BETA);
+            Tracker_Filter(&TrackBearing, atan2f(y, x), robotTurn, dt, TRACK_BEARING_ALPHA, TRACK_BEARING_BETA);
+        }
+        TrackUnseenMs = 0;
+    } else {
+        TrackUnseenMs += periodMs;
+        if(TrackUnseenMs >= TRACK_COAST_MS){
+            TrackLost = 1;
+            status = TRACK_LOST;
+        } else {
+            TrackRange.value += (TrackRange.rate - robotSpeed) * dt;
+            TrackBearing.value += (TrackBearing.rate - robotTurn) * dt;
+            status = TRACK_COASTING;
+        }
+    }
+
+    *range = TrackRange.value;
+    *speed = TrackRange.rate;
+    *bearing = TrackBearing.value;
+    *sightRate = TrackBearing.rate;
+    return status;
+}
+
+
+// ---------- Tracker_Follow ----------
+// Follows the target for one sample: sets the wheel speeds with Speed_Set. Call
+// once per sample, before Speed_Update.
+// Inputs: uint32_t leftDist, centerDist, rightDist - sensor readings (mm, left is to the left of the heading)
+//         uint32_t periodMs - time since the last sample (ms)
+// Output: uint32_t - TRACK_LOCKED, TRACK_COASTING or TRACK_LOST
+uint32_t Tracker_Follow(uint32_t leftDist, uint32_t centerDist, uint32_t rightDist, uint32_t periodMs){
+    float range, bearing, targetSpeed, sightRate, speed, turn;
+    float rpmPerSpeed = 600.0f / (3.14159265f * TRACK_WHEEL_MM);   // 0.1 RPM per mm/s
+    int32_t leftRPM, rightRPM;
+    uint32_t status;
+
+    // The robot's own motion, from the wheel speeds
+    Speed_Get(&leftRPM, &rightRPM);
+    speed = (leftRPM + rightRPM) / (2.0f * rpmPerSpeed);
+    turn = (rightRPM - leftRPM) / (2.0f * TRACK_HALF_WIDTH_MM * rpmPerSpeed);
+
+    status = Tracker_Estimate(leftDist, centerDist, rightDist, periodMs, speed, turn, &range, &targetSpeed, &bearing, &sightRate);
+    if(status == TRACK_LOST){
+        Speed_Set(0, 0);
+        return status;
+    }
+
+    // Match the target's speed and line of sight, and close the gap and the bearing
+    speed = targetSpeed + TRACK_KR * (range - TRACK_FOLLOW_MM);
+    turn = sightRate + TRACK_KB * bearing;
+    if(speed > TRACK_MAX_SPEED){speed = TRACK_MAX_SPEED;}
+    if(speed < -TRACK_MAX_SPEED){speed = -TRACK_MAX_SPEED;}
+    if(turn > TRACK_MAX_TURN){turn = TRACK_MAX_TURN;}
+    if(turn < -TRACK_MAX_TURN){turn = -TRACK_MAX_TURN;}
+
+    Speed_Set((int32_t)((speed - turn * TRACK_HALF_WIDTH_MM) * rpmPerSpeed),
+              (int32_t)((speed + turn * TRACK_HALF_WIDTH_MM) * rpmPerSpeed));
+    return status;
+}
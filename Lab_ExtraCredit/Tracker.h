@@ -0,0 +1,65 @@
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include <stdint.h>
+
+/*
+ * Target tracker for the follower, on the three distance sensors and the wheel
+ * speed controller (Speed.h).
+ *
+ * Each sensor that sees something closer than TRACK_DETECT_MM places a point on
+ * its beam (the side sensors look TRACK_SIDE_ANGLE to either side), and the target
+ * is the average of these points, each weighted by how far inside TRACK_DETECT_MM
+ * it is. This gives the range and the bearing of the target from the sensors.
+ *
+ * An alpha-beta filter on each of them estimates the motion of the target: the
+ * speed of the target away from the robot, and the turn rate of the line from the
+ * robot to it. The robot's own speed and turn rate, from the wheel speeds, are
+ * taken out in the prediction, so the filters follow the target rather than the
+ * robot. Tracker_Follow drives at the target's speed plus TRACK_KR times the range
+ * error, and turns with the line of sight plus TRACK_KB times the bearing, as wheel
+ * speeds for Speed_Set. It matches the speed of the target instead of waiting for
+ * the range error to grow, so the gap stays near TRACK_FOLLOW_MM while the target
+ * moves.
+ *
+ * When no sensor sees the target the filters coast on their last rates for up to
+ * TRACK_COAST_MS, then the robot stops until the target is seen again.
+ */
+
+
+// --------------------- Definitions ---------------------
+
+#define TRACK_DETECT_MM       400      /* Farther than this a sensor sees nothing (mm)               */
+#define TRACK_SIDE_ANGLE      0.7854f  /* Angle of the side sensors from the heading (45 degrees)    */
+#define TRACK_FOLLOW_MM       100      /* Range to hold from the target (mm from the sensors)        */
+#define TRACK_COAST_MS        500      /* Time the filters coast without a reading (ms)              */
+
+// Alpha-beta filter gains
+#define TRACK_RANGE_ALPHA     0.3f     /* Share of the range error taken into the range              */
+#define TRACK_RANGE_BETA      0.05f    /* Share of the range error taken into the target's speed     */
+#define TRACK_BEARING_ALPHA   0.4f     /* Share of the bearing error taken into the bearing          */
+#define TRACK_BEARING_BETA    0.08f    /* Share of the bearing error taken into the sight line rate  */
+
+// Control gains and limits
+#define TRACK_KR              4.0f     /* Speed per mm of range error (mm/s per mm)                  */
+#define TRACK_KB              6.0f     /* Turn rate per radian of bearing (rad/s per rad)            */
+#define TRACK_MAX_SPEED       600.0f   /* Fastest the robot drives (mm/s)                            */
+#define TRACK_MAX_TURN        6.0f     /* Fastest the robot turns (rad/s)                            */
+
+// Robot geometry, for the wheel speeds
+#define TRACK_HALF_WIDTH_MM   70.0f    /* Half the distance between the wheels (mm)                  */
+#define TRACK_WHEEL_MM        70.0f    /* Wheel diameter (mm)                                        */
+
+// Status of a sample
+#define TRACK_LOCKED     0   /* A sensor sees the target                                         */
+#define TRACK_COASTING   1   /* Target not seen for less than TRACK_COAST_MS: following the filters */
+#define TRACK_LOST       2   /* Target not seen for TRACK_COAST_MS: stopped                      */
+
+
+// --------------------- Function Prototypes ---------------------
+void Tracker_Init(void);
+uint32_t Tracker_Estimate(uint32_t leftDist, uint32_t centerDist, uint32_t rightDist, uint32_t periodMs,
+                          float robotSpeed, float robotTurn, float* range, float* speed, float* bearing, float* sightRate);
+uint32_t Tracker_Follow(uint32_t leftDist, uint32_t centerDist, uint32_t rightDist, uint32_t periodMs);
+
+#endif
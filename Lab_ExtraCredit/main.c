@@ -4,6 +4,9 @@
 #include "RobotLights.h"
 #include "ADC14.h"
 #include "Distance.h"
+#include "Tachometer.h"
+#include "Speed.h"
+#include "Tracker.h"
 
 
 typedef uint8_t bool;
@@ -23,6 +26,14 @@ typedef uint8_t bool;
 #define DUTY_LOWER_LIMIT 0
 #define DUTY_UPPER_LIMIT 6000
 
+// Followers (FOLLOW_MODE)
+#define FOLLOW_P      0  /* Duty cycle proportional to the center distance, fixed spins toward a side object */
+#define FOLLOW_TRACK  1  /* Range and bearing filters, wheel speeds matched to the target (Tracker.h) */
+
+#ifndef FOLLOW_MODE
+#define FOLLOW_MODE FOLLOW_TRACK  /* Host/FollowSim.c builds both to compare them */
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////////////
 // Main Program
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -47,6 +58,26 @@ void main(void){
     Back_Lights_OFF();
 
     uint32_t leftDist, centerDist, rightDist;
+
+#if FOLLOW_MODE == FOLLOW_TRACK
+    Tachometer_Init();
+    Speed_Init();
+    Tracker_Init();
+
+    // Main loop
+    while(TRUE){
+        Distance_GetDistances(&leftDist, &centerDist, &rightDist);
+
+        if(Tracker_Follow(leftDist, centerDist, rightDist, LOOP_DELAY) == TRACK_LOST){
+            Front_Lights_OFF();
+        } else {
+            Front_Lights_ON();
+        }
+        Speed_Update(LOOP_DELAY);
+
+        Clock_Delay1ms(LOOP_DELAY);
+    }
+#else
     bool leftObject, centerObject, rightObject;
 
     // Main loop
@@ -103,6 +134,7 @@ void main(void){
 
         Clock_Delay1ms(LOOP_DELAY);
     }
+#endif
 }
 
 